@@ -0,0 +1,143 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+
+std::size_t s_allocations = 0;
+std::size_t s_current_bytes = 0;
+std::size_t s_peak_bytes = 0;
+
+constexpr std::size_t s_header_size = 16;
+
+}
+
+void* operator new(std::size_t n)
+{
+    char* p = static_cast<char*>(std::malloc(n + s_header_size));
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t*>(p) = n;
+    ++s_allocations;
+    s_current_bytes += n;
+    s_peak_bytes = std::max(s_peak_bytes, s_current_bytes);
+    return p + s_header_size;
+}
+
+void* operator new[](std::size_t n)
+{
+    return operator new(n);
+}
+
+void operator delete(void* p) noexcept
+{
+    if (p == nullptr) {
+        return;
+    }
+    char* b = static_cast<char*>(p) - s_header_size;
+    s_current_bytes -= *reinterpret_cast<std::size_t*>(b);
+    std::free(b);
+}
+
+void operator delete[](void* p) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    operator delete(p);
+}
+
+namespace bench {
+
+allocation_stats allocations()
+{
+    return allocation_stats{s_allocations, s_current_bytes, s_peak_bytes};
+}
+
+void reset_peak()
+{
+    s_peak_bytes = s_current_bytes;
+}
+
+void keep(const void* p)
+{
+#if defined(__GNUC__)
+    // The compiler assumes the value is read, no code is emitted.
+    asm volatile("" : : "g"(p) : "memory");
+#else
+    static const void* volatile s_sink;
+    s_sink = p;
+    (void)s_sink;
+#endif
+}
+
+runner::runner(int argc, char** argv)
+    : m_min_time{200}
+    , m_header_printed{false}
+{
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--filter=", 9) == 0) {
+            m_filter = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--min_time=", 11) == 0) {
+            m_min_time = std::chrono::milliseconds(std::atoi(argv[i] + 11));
+        } else {
+            std::fprintf(stderr, "Usage: %s [--filter=<substring>] [--min_time=<ms>]\n",
+                    argv[0]);
+            std::exit(1);
+        }
+    }
+}
+
+bool runner::enabled(const std::string& n) const
+{
+    return n.find(m_filter) != std::string::npos;
+}
+
+void runner::run(const std::string& n, const std::function<void()>& f)
+{
+    if (!enabled(n)) {
+        return;
+    }
+    if (!m_header_printed) {
+        std::printf("%-36s %10s %14s %14s %14s\n", "benchmark", "iterations",
+                "ns/op", "allocs/op", "peak B/op");
+        m_header_printed = true;
+    }
+    // Warm up caches and lazily initialized statics.
+    f();
+    std::size_t iterations = 1;
+    while (true) {
+        std::size_t a = s_allocations;
+        std::size_t total = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            std::size_t c = s_current_bytes;
+            reset_peak();
+            f();
+            total += s_peak_bytes - c;
+        }
+        auto t = std::chrono::steady_clock::now() - start;
+        if (t >= m_min_time || iterations >= (std::size_t(1) << 30)) {
+            double ns = std::chrono::duration<double, std::nano>(t).count();
+            std::printf("%-36s %10zu %14.0f %14.1f %14.0f\n", n.c_str(), iterations,
+                    ns / iterations, double(s_allocations - a) / iterations,
+                    double(total) / iterations);
+            return;
+        }
+        iterations *= 2;
+    }
+}
+
+}
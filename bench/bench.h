@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @namespace bench
+ * @brief Small harness for the benchmarks of liquidfiles.
+ *
+ *        Linking bench.cpp replaces global operator new and delete, so
+ *        every heap allocation made by the benchmarked code is counted.
+ */
+namespace bench {
+
+/// @brief Heap usage counters.
+struct allocation_stats
+{
+    std::size_t allocations;
+    std::size_t current_bytes;
+    std::size_t peak_bytes;
+};
+
+/// @brief Returns the current heap usage counters.
+allocation_stats allocations();
+
+/// @brief Resets the peak of heap usage to the current usage.
+void reset_peak();
+
+/// @brief Prevents the compiler from optimizing away the given value.
+void keep(const void* p);
+
+/// @brief Prevents the compiler from optimizing away the given value.
+template <typename T>
+void keep(const T& v)
+{
+    keep(static_cast<const void*>(&v));
+}
+
+/**
+ * @class runner
+ * @brief Runs benchmarks and prints time, count of allocations and peak
+ *        of heap usage per operation for each.
+ *
+ *        The count of iterations is doubled until the benchmark runs for
+ *        the minimal time, so fast and slow operations are measured
+ *        equally well.
+ */
+class runner final
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param argc, argv Command line: --filter=<substring> runs only
+     *        matching benchmarks, --min_time=<ms> sets the minimal time.
+     */
+    runner(int argc, char** argv);
+
+public:
+    /**
+     * @brief Runs the benchmark if it matches the filter.
+     * @param n Name of benchmark.
+     * @param f Operation to measure.
+     */
+    void run(const std::string& n, const std::function<void()>& f);
+
+    /// @brief Checks whether benchmark with given name will run.
+    bool enabled(const std::string& n) const;
+
+private:
+    std::string m_filter;
+    std::chrono::milliseconds m_min_time;
+    bool m_header_printed;
+};
+
+}
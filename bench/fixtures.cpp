@@ -0,0 +1,80 @@
+#include "fixtures.h"
+
+#include <sstream>
+
+namespace bench {
+
+std::string messages_fixture(unsigned n)
+{
+    std::ostringstream s;
+    s << "{\"messages\":[";
+    for (unsigned i = 0; i < n; ++i) {
+        if (i != 0) {
+            s << ',';
+        }
+        s << "{\"id\":\"msg" << i << "abcdefghijklmnopq\","
+            "\"sender\":\"sender" << i % 50 << "@example.com\","
+            "\"recipients\":[\"user" << i % 200 << "@example.com\","
+            "\"team" << i % 7 << "@example.com\"],"
+            "\"ccs\":[],\"bccs\":[],"
+            "\"created_at\":\"2017-10-13T10:21:53.000Z\","
+            "\"expires_at\":\"2017-11-13\","
+            "\"expires_after\":30,"
+            "\"authorization\":3,"
+            "\"authorization_description\":\"Only Specified Recipients\","
+            "\"subject\":\"Weekly report \\\"" << i << "\\\" \\u00e9t\\u00e9\","
+            "\"message\":\"Hello,\\nplease find the attached files.\","
+            "\"attachments\":[{\"filename\":\"report" << i << ".pdf\","
+            "\"size\":" << 1000 + i << ",\"url\":\"https://example.com/a/" << i << "\"}]}";
+    }
+    s << "]}";
+    return s.str();
+}
+
+std::string filelinks_fixture(unsigned n)
+{
+    std::ostringstream s;
+    s << "{\"links\":[";
+    for (unsigned i = 0; i < n; ++i) {
+        if (i != 0) {
+            s << ',';
+        }
+        s << "{\"id\":\"lnk" << i << "abcdefghijklmnopq\","
+            "\"filename\":\"file" << i << ".tar.gz\","
+            "\"size\":" << 100000 + i << ","
+            "\"url\":\"https://example.com/link/lnk" << i << "abcdefghijklmnopq\","
+            "\"expires_at\":\"2017-11-13T00:00:00.000Z\","
+            "\"download_count\":" << i % 10 << "}";
+    }
+    s << "]}";
+    return s.str();
+}
+
+std::string message_fixture(unsigned n)
+{
+    std::ostringstream s;
+    s << "{\"message\":{\"id\":\"msgabcdefghijklmnopq\","
+        "\"sender\":\"sender@example.com\",\"recipients\":[";
+    for (unsigned i = 0; i < n; ++i) {
+        s << (i != 0 ? "," : "") << "\"user" << i << "@example.com\"";
+    }
+    s << "],\"ccs\":[\"cc@example.com\"],\"bccs\":[],"
+        "\"created_at\":\"2017-10-13T10:21:53.000Z\","
+        "\"expires_at\":\"2017-11-13\","
+        "\"authorization\":3,"
+        "\"authorization_description\":\"Only Specified Recipients\","
+        "\"subject\":\"Weekly report\","
+        "\"message\":\"Hello,\\nplease find the attached files.\","
+        "\"attachments\":[";
+    for (unsigned i = 0; i < n; ++i) {
+        s << (i != 0 ? "," : "") << "{\"filename\":\"report" << i << ".pdf\","
+            "\"checksum\":\"d41d8cd98f00b204e9800998ecf8427e\","
+            "\"crc32\":\"" << 100000 + i << "\","
+            "\"size\":" << 1000 + i << ","
+            "\"url\":\"https://example.com/a/" << i << "\"}";
+    }
+    s << "]}}";
+    return s.str();
+}
+
+}
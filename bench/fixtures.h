@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+/**
+ * @namespace bench
+ * @brief Synthetic server responces used by benchmarks.
+ *
+ *        Fixtures are generated deterministically, so results of
+ *        different runs are comparable.
+ */
+namespace bench {
+
+/// @brief Returns messages listing responce with n messages.
+std::string messages_fixture(unsigned n);
+
+/// @brief Returns filelinks listing responce with n links.
+std::string filelinks_fixture(unsigned n);
+
+/// @brief Returns single message responce with n recipients and attachments.
+std::string message_fixture(unsigned n);
+
+}
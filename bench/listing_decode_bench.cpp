@@ -0,0 +1,86 @@
+// Compares DOM based and streaming decoding of large listing responces.
+//
+// Usage: listing_decode_bench [count]
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <io/json.h>
+#include <io/json_reader.h>
+#include <lf/filelinks_responce.h>
+#include <lf/messages_responce.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+constexpr std::size_t s_chunk_size = 16384;
+
+struct result
+{
+    double ms;
+    std::size_t allocations;
+    std::size_t peak_bytes;
+    std::string output;
+};
+
+template <typename T, typename F>
+result measure(F f)
+{
+    bench::allocation_stats a = bench::allocations();
+    bench::reset_peak();
+    auto start = std::chrono::steady_clock::now();
+    result r;
+    {
+        T m;
+        f(m);
+        r.ms = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+        bench::allocation_stats b = bench::allocations();
+        r.allocations = b.allocations - a.allocations;
+        r.peak_bytes = b.peak_bytes - a.current_bytes;
+        r.output = m.to_string(lf::output_format::csv);
+    }
+    return r;
+}
+
+template <typename T>
+void compare(const char* name, const std::string& body)
+{
+    result d = measure<T>([&body](T& m) {
+        auto j = nlohmann::json::parse(body);
+        m.read(j);
+    });
+    result s = measure<T>([&body](T& m) {
+        typename T::decoder h(m);
+        io::json_reader r(h);
+        for (std::size_t i = 0; i < body.size(); i += s_chunk_size) {
+            r.feed(body.data() + i, std::min(s_chunk_size, body.size() - i));
+        }
+        r.finish();
+    });
+    std::printf("%s (%.1f MB body)\n", name, body.size() / 1048576.0);
+    std::printf("  %-10s %10s %14s %14s\n", "path", "ms", "allocations", "peak MB");
+    std::printf("  %-10s %10.1f %14zu %14.1f\n", "dom", d.ms, d.allocations,
+            d.peak_bytes / 1048576.0);
+    std::printf("  %-10s %10.1f %14zu %14.1f\n", "streaming", s.ms, s.allocations,
+            s.peak_bytes / 1048576.0);
+    if (d.output != s.output) {
+        std::printf("  ERROR: outputs differ\n");
+        std::exit(1);
+    }
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    unsigned n = argc > 1 ? std::atoi(argv[1]) : 50000;
+    compare<lf::messages_responce>("messages", bench::messages_fixture(n));
+    compare<lf::filelinks_responce>("filelinks", bench::filelinks_fixture(n));
+    return 0;
+}
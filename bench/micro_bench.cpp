@@ -0,0 +1,399 @@
+// Microbenchmarks of parsing, formatting and argument handling.
+//
+// Usage: micro_bench [--filter=<substring>] [--min_time=<ms>]
+
+#include "bench.h"
+#include "fixtures.h"
+
+#include <base/filesystem.h>
+#include <cmd/argument_definition.h>
+#include <cmd/arguments.h>
+#include <io/csv_stream.h>
+#include <io/json.h>
+#include <io/json_reader.h>
+#include <io/table_printer.h>
+#include <lf/engine.h>
+#include <lf/filelinks_responce.h>
+#include <lf/listing_passthrough.h>
+#include <lf/message_columns.h>
+#include <lf/message_query.h>
+#include <lf/message_responce.h>
+#include <lf/messages_responce.h>
+#include <lf/transport.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr unsigned s_items = 1000;
+constexpr unsigned s_rows = 1000;
+constexpr unsigned s_large_rows = 100000;
+constexpr unsigned s_directories = 10;
+constexpr unsigned s_files_per_directory = 100;
+constexpr std::size_t s_chunk_size = 16 * 1024;
+
+template <typename T>
+void parse_dom(const std::string& b)
+{
+    T m;
+    m.read(nlohmann::json::parse(b));
+    bench::keep(m);
+}
+
+template <typename T>
+void parse_stream(const std::string& b)
+{
+    T m;
+    typename T::decoder d(m);
+    io::json_reader r(d);
+    r.feed(b.data(), b.size());
+    r.finish();
+    bench::keep(m);
+}
+
+template <typename T>
+void print_stream(const std::string& b, lf::output_format f)
+{
+    std::stringstream s;
+    typename T::printer p(s, f);
+    io::json_reader r(p);
+    r.feed(b.data(), b.size());
+    r.finish();
+    bench::keep(s);
+}
+
+template <typename T>
+void format(bench::runner& r, const std::string& n, const std::string& b)
+{
+    T m;
+    m.read(nlohmann::json::parse(b));
+    r.run(n + "/to_string_table", [&m] {
+        bench::keep(m.to_string(lf::output_format::table));
+    });
+    r.run(n + "/to_string_csv", [&m] {
+        bench::keep(m.to_string(lf::output_format::csv));
+    });
+    r.run(n + "/to_string_json", [&m] {
+        bench::keep(m.to_string(lf::output_format::json));
+    });
+}
+
+/// @brief Compares decoding and printing in one pass with stored
+///        decoding followed by to_string, and with passing the items
+///        of list l through.
+template <typename T>
+void print(bench::runner& r, const std::string& n, const std::string& l,
+        const std::string& b)
+{
+    r.run(n + "/parse_stream_to_string", [&b] {
+        T m;
+        typename T::decoder d(m);
+        io::json_reader j(d);
+        j.feed(b.data(), b.size());
+        j.finish();
+        bench::keep(m.to_string(lf::output_format::table));
+    });
+    r.run(n + "/print_stream", [&b] {
+        print_stream<T>(b, lf::output_format::table);
+    });
+    r.run(n + "/passthrough_ndjson", [&l, &b] {
+        std::stringstream s;
+        lf::listing_passthrough p(l, s, lf::output_format::ndjson);
+        p.data(b.data(), b.size());
+        p.finish();
+        bench::keep(s);
+    });
+}
+
+void table_printer(unsigned n)
+{
+    std::stringstream s;
+    io::table_printer tp(&s);
+    tp.add_column("ID", 24);
+    tp.add_column("Name", 30);
+    tp.add_column("Size", 10);
+    tp.print_header();
+    for (unsigned i = 0; i < n; ++i) {
+        tp << "abcdefghijklmnopqrstuv" << "report.pdf" << i;
+    }
+    tp.print_footer();
+    bench::keep(s);
+}
+
+void csv_ostream(unsigned n, const char* subject)
+{
+    std::stringstream s;
+    io::csv_ostream cp(&s);
+    for (unsigned i = 0; i < n; ++i) {
+        cp << "abcdefghijklmnopqrstuv" << "report.pdf" << i << subject;
+        cp.end_row();
+    }
+    bench::keep(s);
+}
+
+/// @brief Returns csv manifest with n records.
+std::string manifest(unsigned n)
+{
+    std::stringstream s;
+    io::csv_ostream cp(&s);
+    for (unsigned i = 0; i < n; ++i) {
+        cp << "user@example.com" << "Weekly \"report\", part 2" << "Hello,\nthe files are attached."
+            << "/home/user/reports/report.pdf" << "/home/user/reports/data.csv";
+        cp.end_row();
+    }
+    cp.flush();
+    return s.str();
+}
+
+void csv_istream(const std::string& b)
+{
+    std::istringstream s(b);
+    io::csv_istream c(&s);
+    std::vector<std::string> r;
+    std::size_t n = 0;
+    while (c.read_row(r)) {
+        n += r.size();
+    }
+    bench::keep(n);
+}
+
+/**
+ * @class canned_transport
+ * @brief Transport answering every request with the same responce, in
+ *        chunks as curl delivers them, to measure engine without network.
+ */
+class canned_transport final : public lf::transport
+{
+public:
+    canned_transport(const std::string& r)
+        : m_responce{r}
+    {
+    }
+
+    void perform(const lf::http_request&, lf::responce_handler& h) override
+    {
+        for (std::size_t i = 0; i < m_responce.size(); i += s_chunk_size) {
+            h.data(m_responce.data() + i, std::min(s_chunk_size, m_responce.size() - i));
+        }
+    }
+
+private:
+    const std::string& m_responce;
+};
+
+void engine_messages(lf::engine& e)
+{
+    lf::messages_responce m;
+    e.messages("https://example.liquidfiles.com", "abcdefghijklmnopqrstuv", "", "", m,
+            lf::report_level::silent, lf::validate_cert::validate);
+    bench::keep(m);
+}
+
+lf::metadata_cache::listing listing(const std::string& b)
+{
+    lf::metadata_cache::listing l;
+    const nlohmann::json d = nlohmann::json::parse(b);
+    for (const auto& m : d["messages"]) {
+        l.items.push_back({m["id"], m["created_at"], m.dump()});
+    }
+    return l;
+}
+
+void query(bench::runner& r, const std::string& b)
+{
+    const std::string d = lf::message_columns::build(listing(b));
+    std::vector<std::uint64_t> a((d.size() + 7) / 8);
+    std::memcpy(a.data(), d.data(), d.size());
+    lf::message_columns c;
+    if (!c.open(reinterpret_cast<const char*>(a.data()), d.size())) {
+        std::fprintf(stderr, "Can't open columns\n");
+        std::exit(1);
+    }
+    lf::message_query q(c);
+    r.run("query/100k_from", [&q] {
+        lf::message_filter f;
+        f.sender = "sender7@example.com";
+        bench::keep(q.select(f));
+    });
+    r.run("query/100k_larger_than", [&q] {
+        lf::message_filter f;
+        f.larger_than = 51000;
+        bench::keep(q.select(f));
+    });
+    r.run("query/100k_subject", [&q] {
+        lf::message_filter f;
+        f.subject = "REPORT \"7";
+        bench::keep(q.select(f));
+    });
+    r.run("query/100k_group_by_sender", [&q] {
+        bench::keep(q.group(q.select(lf::message_filter()), lf::query_group::sender));
+    });
+}
+
+/**
+ * @class file_tree
+ * @brief Temporary directory tree for filesystem benchmarks.
+ *
+ *        Files are created both in the root and in its subdirectories.
+ */
+class file_tree final
+{
+public:
+    file_tree()
+    {
+        char p[] = "/tmp/liquidfiles_bench_XXXXXX";
+        if (mkdtemp(p) == nullptr) {
+            std::perror("mkdtemp");
+            std::exit(1);
+        }
+        m_root = p;
+        for (unsigned d = 0; d <= s_directories; ++d) {
+            std::string x = m_root;
+            if (d != 0) {
+                x += "/dir" + std::to_string(d);
+                mkdir(x.c_str(), 0700);
+                m_directories.push_back(x);
+            }
+            for (unsigned f = 0; f < s_files_per_directory; ++f) {
+                m_files.push_back(x + "/file" + std::to_string(f) + ".txt");
+                std::FILE* fp = std::fopen(m_files.back().c_str(), "w");
+                if (fp != nullptr) {
+                    std::fclose(fp);
+                }
+            }
+        }
+    }
+
+    ~file_tree()
+    {
+        for (const auto& f : m_files) {
+            unlink(f.c_str());
+        }
+        for (const auto& d : m_directories) {
+            rmdir(d.c_str());
+        }
+        rmdir(m_root.c_str());
+    }
+
+    file_tree(const file_tree&) = delete;
+    file_tree& operator=(const file_tree&) = delete;
+
+public:
+    const std::string& root() const
+    {
+        return m_root;
+    }
+
+private:
+    std::string m_root;
+    std::vector<std::string> m_directories;
+    std::vector<std::string> m_files;
+};
+
+}
+
+int main(int argc, char** argv)
+{
+    bench::runner r(argc, argv);
+
+    const std::string messages = bench::messages_fixture(s_items);
+    const std::string filelinks = bench::filelinks_fixture(s_items);
+    const std::string message = bench::message_fixture(s_items / 10);
+
+    r.run("messages/parse_dom", [&messages] {
+        parse_dom<lf::messages_responce>(messages);
+    });
+    r.run("messages/parse_stream", [&messages] {
+        parse_stream<lf::messages_responce>(messages);
+    });
+    format<lf::messages_responce>(r, "messages", messages);
+    print<lf::messages_responce>(r, "messages", "messages", messages);
+    {
+        lf::null_event_sink es;
+        canned_transport t(messages);
+        lf::engine e(es, t);
+        r.run("engine/messages", [&e] {
+            engine_messages(e);
+        });
+    }
+    r.run("message/parse_dom", [&message] {
+        parse_dom<lf::message_responce>(message);
+    });
+    format<lf::message_responce>(r, "message", message);
+    r.run("filelinks/parse_dom", [&filelinks] {
+        parse_dom<lf::filelinks_responce>(filelinks);
+    });
+    r.run("filelinks/parse_stream", [&filelinks] {
+        parse_stream<lf::filelinks_responce>(filelinks);
+    });
+    format<lf::filelinks_responce>(r, "filelinks", filelinks);
+    print<lf::filelinks_responce>(r, "filelinks", "links", filelinks);
+
+    r.run("table_printer/rows", [] {
+        table_printer(s_rows);
+    });
+    r.run("table_printer/100k_rows", [] {
+        table_printer(s_large_rows);
+    });
+    r.run("csv_ostream/rows", [] {
+        csv_ostream(s_rows, "Weekly report");
+    });
+    r.run("csv_ostream/100k_rows", [] {
+        csv_ostream(s_large_rows, "Weekly report");
+    });
+    r.run("csv_ostream/100k_rows_quoted", [] {
+        csv_ostream(s_large_rows, "Weekly \"report\", part 2");
+    });
+    const std::string m = manifest(s_large_rows);
+    r.run("csv_istream/100k_rows", [&m] {
+        csv_istream(m);
+    });
+
+    const std::vector<std::string> a{"--server=https://example.liquidfiles.com",
+        "--api_key=abcdefghijklmnopqrstuv", "--to=user@example.com",
+        "--subject=Weekly report", "--message=Hello", "-k", "-s",
+        "report.pdf", "data.csv", "archive.tar.gz"};
+    r.run("arguments/construct", [&a] {
+        bench::keep(cmd::arguments::construct(a));
+    });
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> server{
+        "server", "<url>", "Server."};
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, true> to{
+        "to", "<email>", "Recipient."};
+    cmd::argument_definition<int, cmd::argument_name_type::named, false> workers{
+        "workers", "<count>", "Workers.", 4};
+    cmd::argument_definition<bool, cmd::argument_name_type::boolean, false> k{"k", "Validate."};
+    cmd::argument_definition<std::string, cmd::argument_name_type::unnamed, true> files{
+        "<file>", "Files."};
+    r.run("arguments/values", [&] {
+        cmd::arguments x = cmd::arguments::construct(a);
+        bench::keep(server.value(x));
+        bench::keep(to.value(x));
+        bench::keep(workers.value(x));
+        bench::keep(k.value(x));
+        bench::keep(files.value(x));
+    });
+
+    if (r.enabled("query/100k_from") || r.enabled("query/100k_larger_than") ||
+            r.enabled("query/100k_subject") || r.enabled("query/100k_group_by_sender")) {
+        query(r, bench::messages_fixture(s_large_rows));
+    }
+
+    if (r.enabled("filesystem/get_all_files")) {
+        file_tree t;
+        const std::set<std::string> d{t.root()};
+        r.run("filesystem/get_all_files", [&d] {
+            bench::keep(base::filesystem::get_all_files(d));
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,303 @@
+#! /usr/bin/env python3
+"""End-to-end performance regression suite of liquidfiles utility.
+
+Runs the real binary against mock_server.py (in --discard mode, so the
+server keeps only sizes of uploaded files) over a matrix of file sizes and
+counts. Every scenario sends the files of one directory as a message and
+downloads the message back. For both phases it measures MB/s, requests/s,
+CPU time and peak RSS of the utility, and compares them with the baseline
+file. The startup scenario runs no-op invocations (--version, and help of
+one command) many times and measures wall and CPU time per invocation, which
+is what scripts calling the utility for every file pay. The suite fails when
+a metric is worse than its baseline by more than both the relative and the
+absolute threshold of the metric.
+
+Profiles:
+    full   1x10GB, 1000x1MB, 100000x1KB
+    quick  1x256MB, 200x1MB, 5000x1KB
+
+Baselines depend on the machine, run with --update on the reference machine
+to record new ones after an intended change of performance.
+
+Usage: perf.py [options], see --help.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+DIR = os.path.dirname(os.path.abspath(__file__))
+
+KB = 1024
+MB = 1024 * KB
+GB = 1024 * MB
+
+PROFILES = {
+    'full': [(1, 10 * GB), (1000, MB), (100000, KB)],
+    'quick': [(1, 256 * MB), (200, MB), (5000, KB)],
+}
+
+# Invocations of every startup command per run.
+STARTUP_RUNS = {
+    'full': 1000,
+    'quick': 200,
+}
+
+STARTUP_COMMANDS = [
+    ('version', ['--version']),
+    ('help', ['help', 'send']),
+]
+
+# Direction in which a metric is better.
+HIGHER = 'higher'
+LOWER = 'lower'
+METRICS = {
+    'mb_per_s': HIGHER,
+    'requests_per_s': HIGHER,
+    'cpu_s': LOWER,
+    'peak_rss_mb': LOWER,
+    'startup_ms': LOWER,
+    'startup_cpu_ms': LOWER,
+}
+
+API_KEY = 'MockApiKey000000000000'
+RECIPIENT = 'perf@example.com'
+
+
+def human(n):
+    for unit, size in (('GB', GB), ('MB', MB), ('KB', KB)):
+        if n >= size and n % size == 0:
+            return '%d%s' % (n // size, unit)
+    return '%dB' % n
+
+
+def scenario_name(count, size):
+    return '%dx%s' % (count, human(size))
+
+
+def make_files(path, count, size):
+    """Creates count files of given size, large ones are sparse."""
+    os.makedirs(path)
+    block = os.urandom(min(size, MB))
+    for i in range(count):
+        with open(os.path.join(path, 'file%06d.bin' % i), 'wb') as f:
+            if size > MB:
+                f.truncate(size)
+            else:
+                f.write(block[:size])
+
+
+class MockServer:
+    """mock_server.py running in background."""
+
+    def __init__(self, work):
+        port_file = os.path.join(work, 'port')
+        self.process = subprocess.Popen(
+            [sys.executable, os.path.join(DIR, '..', '..', 'test', 'mock_server.py'),
+             '--discard', '--port_file=' + port_file],
+            stdout=subprocess.DEVNULL)
+        for _ in range(100):
+            if os.path.exists(port_file):
+                break
+            time.sleep(0.1)
+        else:
+            self.stop()
+            raise RuntimeError("Couldn't start mock server")
+        with open(port_file) as f:
+            self.url = 'http://127.0.0.1:%d' % int(f.read())
+
+    def stop(self):
+        self.process.kill()
+        self.process.wait()
+
+
+def options(server):
+    return ['--server=' + server.url, '--api_key=' + API_KEY,
+            '--report_level=silent']
+
+
+def run(args, env):
+    """Runs the utility and returns its output, wall time and rusage."""
+    start = time.monotonic()
+    p = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                         env=env)
+    out = p.stdout.read()
+    _, status, usage = os.wait4(p.pid, 0)
+    p.returncode = os.waitstatus_to_exitcode(status)
+    wall = time.monotonic() - start
+    if p.returncode != 0:
+        raise RuntimeError('%s failed with %d:\n%s' % (
+            ' '.join(args[:2]), p.returncode, out.decode(errors='replace')))
+    return out.decode(errors='replace'), wall, usage
+
+
+def metrics(wall, usage, count, size):
+    # One request per file, and one for the message.
+    return {
+        'mb_per_s': count * size / MB / wall,
+        'requests_per_s': (count + 1) / wall,
+        'cpu_s': usage.ru_utime + usage.ru_stime,
+        'peak_rss_mb': usage.ru_maxrss / 1024.0,
+    }
+
+
+def median(results):
+    return {m: round(statistics.median(x[m] for x in results), 3)
+            for m in results[0]}
+
+
+def measure(exe, count, size, repeat, work):
+    """Returns the median of repeated metrics of send and download phases."""
+    files = os.path.join(work, 'files')
+    make_files(files, count, size)
+    env = dict(os.environ, HOME=work)
+    sends = []
+    downloads = []
+    try:
+        for _ in range(repeat):
+            # Fresh server for every run, so the listings do not grow.
+            server = MockServer(work)
+            try:
+                _, wall, usage = run(
+                    [exe, 'send'] + options(server) +
+                    ['--to=' + RECIPIENT, '--file_type=directory', files], env)
+                sends.append(metrics(wall, usage, count, size))
+                # Silent send does not print the id, the server has only
+                # this message.
+                out, _, _ = run([exe, 'messages'] + options(server) +
+                                ['--output_format=csv'], env)
+                message = out.split(',')[0]
+                target = os.path.join(work, 'download')
+                os.makedirs(target)
+                _, wall, usage = run(
+                    [exe, 'download'] + options(server) +
+                    ['--message_id=' + message, '--download_to=' + target], env)
+                downloads.append(metrics(wall, usage, count, size))
+                shutil.rmtree(target)
+            finally:
+                server.stop()
+                os.unlink(os.path.join(work, 'port'))
+    finally:
+        shutil.rmtree(files)
+    return {'send': median(sends), 'download': median(downloads)}
+
+
+def measure_startup(exe, runs, repeat, work):
+    """Returns the median of repeated time per invocation of no-op commands."""
+    env = dict(os.environ, HOME=work)
+    current = {}
+    for phase, args in STARTUP_COMMANDS:
+        samples = []
+        for _ in range(repeat):
+            wall = 0.0
+            cpu = 0.0
+            for _ in range(runs):
+                _, w, usage = run([exe] + args, env)
+                wall += w
+                cpu += usage.ru_utime + usage.ru_stime
+            samples.append({'startup_ms': wall * 1000 / runs,
+                            'startup_cpu_ms': cpu * 1000 / runs})
+        current[phase] = median(samples)
+    return current
+
+
+def compare(name, current, baseline, thresholds):
+    """Prints the comparison and returns the list of regressions."""
+    regressions = []
+    for phase in current:
+        for m in current[phase]:
+            d = METRICS[m]
+            c = current[phase][m]
+            b = baseline.get(phase, {}).get(m)
+            if b is None or b == 0:
+                status = 'new'
+                change = 0.0
+            else:
+                change = (c - b) / b
+                worse = -1 if d == HIGHER else 1
+                t = thresholds[m]
+                # Both limits must be exceeded, so the noise of short
+                # measurements is not reported.
+                regressed = (worse * change > t['relative'] and
+                             worse * (c - b) > t.get('absolute', 0))
+                status = 'REGRESSED' if regressed else 'ok'
+            print('%-14s %-9s %-15s %12.3f %12s %+8.1f%%  %s' % (
+                name, phase, m, c, '-' if b is None else '%.3f' % b,
+                change * 100, status))
+            if status == 'REGRESSED':
+                regressions.append('%s %s %s' % (name, phase, m))
+    return regressions
+
+
+def main():
+    p = argparse.ArgumentParser(
+        description='End-to-end performance regression suite.')
+    p.add_argument('--exec', dest='exe',
+                   default=os.environ.get(
+                       'LF_TEST_EXEC', os.path.join(DIR, '..', '..', 'build',
+                                                    'liquidfiles')),
+                   help='liquidfiles binary to test')
+    p.add_argument('--profile', choices=sorted(PROFILES), default='quick',
+                   help='matrix of scenarios')
+    p.add_argument('--scenario',
+                   help='run only scenarios containing this substring')
+    p.add_argument('--baseline', default=os.path.join(DIR, 'baseline.json'),
+                   help='baseline file')
+    p.add_argument('--repeat', type=int, default=3,
+                   help='runs of every scenario, the median is compared')
+    p.add_argument('--update', action='store_true',
+                   help='store the measured metrics as the new baseline')
+    p.add_argument('--work_dir', default=None,
+                   help='directory for generated files, temporary by default')
+    config = p.parse_args()
+
+    with open(config.baseline) as f:
+        data = json.load(f)
+    thresholds = data['thresholds']
+    baselines = data.setdefault('profiles', {}).setdefault(config.profile, {})
+
+    print('%-14s %-9s %-15s %12s %12s %9s  %s' % (
+        'scenario', 'phase', 'metric', 'current', 'baseline', 'change',
+        'status'))
+    regressions = []
+    scenarios = [('startup', None, None)]
+    scenarios += [(scenario_name(c, s), c, s) for c, s in PROFILES[config.profile]]
+    for name, count, size in scenarios:
+        if config.scenario and config.scenario not in name:
+            continue
+        work = tempfile.mkdtemp(prefix='liquidfiles_perf_', dir=config.work_dir)
+        try:
+            exe = os.path.abspath(config.exe)
+            if count is None:
+                current = measure_startup(exe, STARTUP_RUNS[config.profile],
+                                          config.repeat, work)
+            else:
+                current = measure(exe, count, size, config.repeat, work)
+        finally:
+            shutil.rmtree(work, ignore_errors=True)
+        regressions += compare(name, current, baselines.get(name, {}),
+                               thresholds)
+        if config.update:
+            baselines[name] = current
+
+    if config.update:
+        with open(config.baseline, 'w') as f:
+            json.dump(data, f, indent=4, sort_keys=True)
+            f.write('\n')
+        print('Baseline updated.')
+        return 0
+    if regressions:
+        print('FINAL RESULT: FAILED, regressed: ' + ', '.join(regressions))
+        return 1
+    print('FINAL RESULT: PASSED')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
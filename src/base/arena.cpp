@@ -0,0 +1,88 @@
+#include "arena.h"
+
+#include <cstdint>
+
+namespace base {
+
+std::ostream& operator<<(std::ostream& o, const string_ref& s)
+{
+    std::streamsize n = static_cast<std::streamsize>(s.size());
+    std::streamsize p = o.width() > n ? o.width() - n : 0;
+    bool left = (o.flags() & std::ios::adjustfield) == std::ios::left;
+    if (!left) {
+        for (; p > 0; --p) {
+            o.put(o.fill());
+        }
+    }
+    o.write(s.data(), n);
+    for (; p > 0; --p) {
+        o.put(o.fill());
+    }
+    o.width(0);
+    return o;
+}
+
+arena::arena(std::size_t b)
+    : m_block_size{b}
+    , m_current{nullptr}
+    , m_left{0}
+    , m_interned{0, hash(), std::equal_to<string_ref>(), arena_allocator<string_ref>(*this)}
+{
+}
+
+void* arena::allocate(std::size_t n, std::size_t a)
+{
+    std::size_t o = (a - reinterpret_cast<std::uintptr_t>(m_current) % a) % a;
+    if (m_current == nullptr || o + n > m_left) {
+        // Large allocations get their own block, so the current one is
+        // not wasted.
+        std::size_t s = n + a > m_block_size / 4 ? n + a : m_block_size;
+        m_blocks.emplace_back(new char[s]);
+        char* b = m_blocks.back().get();
+        if (s != m_block_size) {
+            o = (a - reinterpret_cast<std::uintptr_t>(b) % a) % a;
+            return b + o;
+        }
+        m_current = b;
+        m_left = s;
+        o = (a - reinterpret_cast<std::uintptr_t>(m_current) % a) % a;
+    }
+    char* p = m_current + o;
+    m_current = p + n;
+    m_left -= o + n;
+    return p;
+}
+
+string_ref arena::copy(const char* d, std::size_t n)
+{
+    if (n == 0) {
+        return string_ref();
+    }
+    char* p = static_cast<char*>(allocate(n, 1));
+    std::memcpy(p, d, n);
+    return string_ref(p, n);
+}
+
+string_ref arena::intern(const char* d, std::size_t n)
+{
+    auto i = m_interned.find(string_ref(d, n));
+    if (i != m_interned.end()) {
+        return *i;
+    }
+    string_ref s = copy(d, n);
+    m_interned.insert(s);
+    return s;
+}
+
+std::size_t arena::hash::operator()(const string_ref& s) const
+{
+    // FNV-1a.
+    std::size_t h = 14695981039346656037ULL;
+    for (char c : s) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+}
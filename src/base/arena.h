@@ -0,0 +1,222 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace base {
+
+/**
+ * @class string_ref
+ * @brief Non-owning reference to the characters of string, usually
+ *        allocated in arena.
+ */
+class string_ref final
+{
+public:
+    /// @brief Constructs empty string reference.
+    string_ref()
+        : m_data{""}
+        , m_size{0}
+    {
+    }
+
+    /// @brief Constructs reference to n characters starting at d.
+    string_ref(const char* d, std::size_t n)
+        : m_data{d}
+        , m_size{n}
+    {
+    }
+
+public:
+    const char* data() const
+    {
+        return m_data;
+    }
+
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    const char* begin() const
+    {
+        return m_data;
+    }
+
+    const char* end() const
+    {
+        return m_data + m_size;
+    }
+
+    /// @brief Returns the reference to at most n characters starting at p.
+    string_ref substr(std::size_t p, std::size_t n = std::string::npos) const
+    {
+        if (p > m_size) {
+            p = m_size;
+        }
+        return string_ref(m_data + p, n < m_size - p ? n : m_size - p);
+    }
+
+    /// @brief Returns the copy of referenced characters.
+    std::string str() const
+    {
+        return std::string(m_data, m_size);
+    }
+
+    bool operator==(const string_ref& o) const
+    {
+        return m_size == o.m_size && std::memcmp(m_data, o.m_data, m_size) == 0;
+    }
+
+    bool operator!=(const string_ref& o) const
+    {
+        return !(*this == o);
+    }
+
+private:
+    const char* m_data;
+    std::size_t m_size;
+};
+
+/// @brief Writes the string to stream, respecting the width and adjustment.
+std::ostream& operator<<(std::ostream& o, const string_ref& s);
+
+class arena;
+
+/**
+ * @class arena_allocator
+ * @brief Standard allocator allocating from arena.
+ *
+ *        Deallocation does nothing, memory is freed with arena.
+ */
+template <typename T>
+class arena_allocator
+{
+public:
+    using value_type = T;
+
+    arena_allocator(arena& a) noexcept
+        : m_arena{&a}
+    {
+    }
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& o) noexcept
+        : m_arena{o.m_arena}
+    {
+    }
+
+public:
+    T* allocate(std::size_t n);
+
+    void deallocate(T*, std::size_t) noexcept
+    {
+    }
+
+    template <typename U>
+    bool operator==(const arena_allocator<U>& o) const noexcept
+    {
+        return m_arena == o.m_arena;
+    }
+
+    template <typename U>
+    bool operator!=(const arena_allocator<U>& o) const noexcept
+    {
+        return m_arena != o.m_arena;
+    }
+
+private:
+    template <typename U>
+    friend class arena_allocator;
+
+    arena* m_arena;
+};
+
+/**
+ * @class arena
+ * @brief Allocates memory from large blocks and frees all of it at once,
+ *        on destruction.
+ *
+ *        Responces with many small strings keep them in arena instead of
+ *        allocating every one on heap. Repeated strings (like addresses)
+ *        can be interned, so they are stored only once.
+ */
+class arena final
+{
+public:
+    /// @brief Constructor.
+    /// @param b Size of blocks.
+    explicit arena(std::size_t b = 16384);
+
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+
+public:
+    /**
+     * @brief Allocates memory.
+     * @param n Size of memory.
+     * @param a Alignment of memory.
+     */
+    void* allocate(std::size_t n, std::size_t a = alignof(std::max_align_t));
+
+    /// @brief Copies n characters starting at d to arena.
+    string_ref copy(const char* d, std::size_t n);
+
+    /// @brief Copies the given string to arena.
+    string_ref copy(const std::string& s)
+    {
+        return copy(s.data(), s.size());
+    }
+
+    /// @brief Copies n characters starting at d to arena, unless the same
+    ///        string was interned before.
+    string_ref intern(const char* d, std::size_t n);
+
+    /// @brief Copies the given string to arena, unless the same string
+    ///        was interned before.
+    string_ref intern(const std::string& s)
+    {
+        return intern(s.data(), s.size());
+    }
+
+    /// @brief Returns the count of blocks allocated on heap.
+    std::size_t blocks() const
+    {
+        return m_blocks.size();
+    }
+
+private:
+    struct hash
+    {
+        std::size_t operator()(const string_ref& s) const;
+    };
+
+private:
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    std::size_t m_block_size;
+    char* m_current;
+    std::size_t m_left;
+    std::unordered_set<string_ref, hash, std::equal_to<string_ref>,
+        arena_allocator<string_ref>> m_interned;
+};
+
+template <typename T>
+T* arena_allocator<T>::allocate(std::size_t n)
+{
+    return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+}
+
+/// @brief List of strings allocated in arena.
+using arena_strings = std::vector<string_ref, arena_allocator<string_ref>>;
+
+}
@@ -24,6 +24,15 @@ public:
     }
 };
 
+class write_error : public base::exception
+{
+public:
+    write_error(const std::string& arg)
+        : base::exception(std::string{"Unable to write file '" + arg + "'."}, 5)
+    {
+    }
+};
+
 class closedir_error : public base::exception
 {
 public:
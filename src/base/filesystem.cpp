@@ -1,5 +1,8 @@
 #include "filesystem.h"
+#include "trace.h"
 
+#include <cerrno>
+#include <cstdlib>
 #include <fstream>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -47,6 +50,8 @@ namespace base
 
 std::string filesystem::read_file(const std::string& file)
 {
+    trace_span t("filesystem", "read_file");
+    t.arg("file", file);
     std::ifstream file_to_read;
     std::string buffer;
     std::string result;
@@ -64,9 +69,33 @@ std::string filesystem::read_file(const std::string& file)
 
 std::set<std::string> filesystem::get_all_files(const std::set<std::string>& directory_name)
 {
+    trace_span t("filesystem", "get_all_files");
     std::set<std::string> result;
     ::set_all_files(directory_name, result);
+    t.arg("files", std::to_string(result.size()));
     return result;
 }
 
+std::string filesystem::user_directory()
+{
+    const char* h = std::getenv("HOME");
+    if (h == nullptr) {
+        return std::string();
+    }
+    return std::string(h) + "/.liquidfiles/";
+}
+
+bool filesystem::create_user_directory()
+{
+    std::string d = user_directory();
+    if (d.empty()) {
+        return false;
+    }
+    struct stat sb;
+    if (stat(d.c_str(), &sb) == 0) {
+        return S_ISDIR(sb.st_mode);
+    }
+    return errno == ENOENT && mkdir(d.c_str(), S_IRWXU) == 0;
+}
+
 }
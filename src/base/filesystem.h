@@ -21,6 +21,14 @@ namespace filesystem
     /// @param directory_name Directory name from which must be retrieved files.
     std::set<std::string> get_all_files(const std::set<std::string>& directory_name);
 
+    /// @brief Returns the path of directory where liquidfiles keeps its
+    ///        data (credentials, caches), empty if HOME is not set.
+    std::string user_directory();
+
+    /// @brief Creates the user directory if it does not exist.
+    /// @return false if directory can't be created.
+    bool create_user_directory();
+
 }
 
 
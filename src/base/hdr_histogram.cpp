@@ -0,0 +1,111 @@
+#include "hdr_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace base {
+
+namespace {
+
+unsigned bit_length(std::uint64_t v)
+{
+    return v == 0 ? 0 : 64 - __builtin_clzll(v);
+}
+
+}
+
+hdr_histogram::hdr_histogram(std::uint64_t h, unsigned d)
+    : m_highest{std::max<std::uint64_t>(h, 2)}
+    , m_total{0}
+    , m_min{0}
+    , m_max{0}
+    , m_sum{0}
+{
+    d = std::min(std::max(d, 1u), 5u);
+    // Sub buckets must resolve one unit of the last significant digit at
+    // the top of each bucket.
+    std::uint64_t r = 2 * static_cast<std::uint64_t>(std::pow(10.0, d));
+    unsigned m = bit_length(r - 1);
+    m_sub_bucket_half_count_magnitude = m - 1;
+    m_sub_bucket_half_count = std::uint64_t(1) << (m - 1);
+    m_sub_bucket_mask = (std::uint64_t(1) << m) - 1;
+    std::size_t buckets = 1;
+    for (std::uint64_t u = std::uint64_t(1) << m; u <= m_highest && u != 0; u <<= 1) {
+        ++buckets;
+    }
+    m_counts.resize((buckets + 1) * m_sub_bucket_half_count);
+}
+
+void hdr_histogram::record(std::uint64_t v)
+{
+    v = std::min(v, m_highest);
+    ++m_counts[index_of(v)];
+    m_min = m_total == 0 ? v : std::min(m_min, v);
+    m_max = std::max(m_max, v);
+    m_sum += v;
+    ++m_total;
+}
+
+void hdr_histogram::merge(const hdr_histogram& o)
+{
+    if (o.m_total == 0) {
+        return;
+    }
+    std::size_t n = std::min(m_counts.size(), o.m_counts.size());
+    for (std::size_t i = 0; i < n; ++i) {
+        m_counts[i] += o.m_counts[i];
+    }
+    m_min = m_total == 0 ? o.m_min : std::min(m_min, o.m_min);
+    m_max = std::max(m_max, o.m_max);
+    m_sum += o.m_sum;
+    m_total += o.m_total;
+}
+
+double hdr_histogram::mean() const
+{
+    return m_total == 0 ? 0.0 : m_sum / m_total;
+}
+
+std::uint64_t hdr_histogram::value_at_percentile(double p) const
+{
+    if (m_total == 0) {
+        return 0;
+    }
+    p = std::min(std::max(p, 0.0), 100.0);
+    std::uint64_t c = static_cast<std::uint64_t>(std::ceil(p / 100.0 * m_total));
+    c = std::max<std::uint64_t>(c, 1);
+    std::uint64_t s = 0;
+    for (std::size_t i = 0; i < m_counts.size(); ++i) {
+        s += m_counts[i];
+        if (s >= c) {
+            return std::min(highest_equivalent_value(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+std::size_t hdr_histogram::index_of(std::uint64_t v) const
+{
+    unsigned b = bit_length(v | m_sub_bucket_mask) - (m_sub_bucket_half_count_magnitude + 1);
+    std::uint64_t s = v >> b;
+    return ((b + 1) << m_sub_bucket_half_count_magnitude) + (s - m_sub_bucket_half_count);
+}
+
+std::uint64_t hdr_histogram::value_of(std::size_t i) const
+{
+    int b = static_cast<int>(i >> m_sub_bucket_half_count_magnitude) - 1;
+    std::uint64_t s = (i & (m_sub_bucket_half_count - 1)) + m_sub_bucket_half_count;
+    if (b < 0) {
+        s -= m_sub_bucket_half_count;
+        b = 0;
+    }
+    return s << b;
+}
+
+std::uint64_t hdr_histogram::highest_equivalent_value(std::size_t i) const
+{
+    int b = static_cast<int>(i >> m_sub_bucket_half_count_magnitude) - 1;
+    return value_of(i) + (std::uint64_t(1) << std::max(b, 0)) - 1;
+}
+
+}
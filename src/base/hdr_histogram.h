@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace base {
+
+/**
+ * @class hdr_histogram
+ * @brief High dynamic range histogram of integer values.
+ *
+ *        Values are counted in buckets, which cover the whole range up to
+ *        the highest trackable value with the fixed relative precision
+ *        (given as count of significant decimal digits), so percentiles are
+ *        accurate both for small and large values, with constant memory
+ *        and constant time of recording.
+ */
+class hdr_histogram final
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param h Highest trackable value, larger values are recorded as h.
+     * @param d Count of significant decimal digits, from 1 to 5.
+     */
+    hdr_histogram(std::uint64_t h, unsigned d = 3);
+
+public:
+    /// @brief Records the value.
+    void record(std::uint64_t v);
+
+    /// @brief Adds the values recorded in other histogram with the same
+    ///        highest trackable value and precision.
+    void merge(const hdr_histogram& o);
+
+public:
+    /// @brief Returns the count of recorded values.
+    std::uint64_t count() const
+    {
+        return m_total;
+    }
+
+    /// @brief Returns the smallest recorded value, 0 if there is no.
+    std::uint64_t min() const
+    {
+        return m_total == 0 ? 0 : m_min;
+    }
+
+    /// @brief Returns the largest recorded value.
+    std::uint64_t max() const
+    {
+        return m_max;
+    }
+
+    /// @brief Returns the mean of recorded values.
+    double mean() const;
+
+    /**
+     * @brief Returns the value below or equal to which the given percent
+     *        of recorded values are.
+     * @param p Percentile, from 0 to 100.
+     */
+    std::uint64_t value_at_percentile(double p) const;
+
+private:
+    std::size_t index_of(std::uint64_t v) const;
+    std::uint64_t value_of(std::size_t i) const;
+    std::uint64_t highest_equivalent_value(std::size_t i) const;
+
+private:
+    std::uint64_t m_highest;
+    unsigned m_sub_bucket_half_count_magnitude;
+    std::uint64_t m_sub_bucket_half_count;
+    std::uint64_t m_sub_bucket_mask;
+    std::vector<std::uint64_t> m_counts;
+    std::uint64_t m_total;
+    std::uint64_t m_min;
+    std::uint64_t m_max;
+    double m_sum;
+};
+
+}
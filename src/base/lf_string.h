@@ -1,6 +1,8 @@
 #pragma once
 
+#include <limits>
 #include <sstream>
+#include <type_traits>
 
 namespace base {
 
@@ -29,4 +31,48 @@ T from_string(std::string s)
     return t;
 }
 
+/**
+ * @brief Parses decimal integer from [b, e), like std::from_chars but
+ *        accepting leading spaces and '+' as streams do.
+ *
+ *        Unlike from_string it neither allocates nor depends on locale.
+ *        Out of range values are clamped.
+ * @param[out] v Parsed value, 0 if there is no number.
+ * @return Pointer past the parsed characters, b if there is no number.
+ */
+template <typename T>
+const char* parse_integer(const char* b, const char* e, T& v)
+{
+    static_assert(std::is_integral<T>::value, "Integral type is required.");
+    const char* p = b;
+    while (p != e && (*p == ' ' || *p == '\t')) {
+        ++p;
+    }
+    bool negative = false;
+    if (p != e && (*p == '-' || *p == '+')) {
+        negative = *p == '-' && std::is_signed<T>::value;
+        ++p;
+    }
+    const char* digits = p;
+    T r = 0;
+    const T max = negative ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+    bool overflow = false;
+    for (; p != e && *p >= '0' && *p <= '9'; ++p) {
+        T d = *p - '0';
+        if (negative) {
+            overflow = overflow || r < (max + d) / 10;
+            r = overflow ? max : r * 10 - d;
+        } else {
+            overflow = overflow || r > (max - d) / 10;
+            r = overflow ? max : r * 10 + d;
+        }
+    }
+    if (p == digits) {
+        v = 0;
+        return b;
+    }
+    v = r;
+    return p;
+}
+
 }
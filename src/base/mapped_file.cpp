@@ -0,0 +1,38 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace base {
+
+mapped_file::mapped_file(const std::string& f)
+    : m_data{nullptr}
+    , m_size{0}
+{
+    int d = open(f.c_str(), O_RDONLY);
+    if (d < 0) {
+        return;
+    }
+    struct stat s;
+    if (fstat(d, &s) == 0 && s.st_size > 0) {
+        void* p = mmap(nullptr, static_cast<std::size_t>(s.st_size), PROT_READ,
+                MAP_PRIVATE, d, 0);
+        if (p != MAP_FAILED) {
+            m_data = static_cast<const char*>(p);
+            m_size = static_cast<std::size_t>(s.st_size);
+        }
+    }
+    // The mapping stays valid after the descriptor is closed.
+    close(d);
+}
+
+mapped_file::~mapped_file()
+{
+    if (m_data != nullptr) {
+        munmap(const_cast<char*>(m_data), m_size);
+    }
+}
+
+}
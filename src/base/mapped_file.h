@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace base {
+
+/**
+ * @class mapped_file
+ * @brief Read only memory mapping of the whole file.
+ *
+ *        Pages are read by the system when they are accessed, so large
+ *        files are used with no copying and no parsing.
+ */
+class mapped_file final
+{
+public:
+    /// @brief Maps the file, the mapping is empty if the file can't be
+    ///        mapped.
+    /// @param f Path of file.
+    explicit mapped_file(const std::string& f);
+
+    /// @brief Unmaps the file.
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+public:
+    /// @brief Returns the contents of file, page aligned.
+    const char* data() const
+    {
+        return m_data;
+    }
+
+    /// @brief Returns the size of file, 0 if it is not mapped.
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+private:
+    const char* m_data;
+    std::size_t m_size;
+};
+
+}
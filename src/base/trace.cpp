@@ -0,0 +1,136 @@
+#include "trace.h"
+#include "exceptions.h"
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+#include <unistd.h>
+
+namespace base {
+
+std::atomic<bool> trace::g_enabled{false};
+
+namespace {
+
+struct event
+{
+    const char* category;
+    const char* name;
+    std::int64_t ts;
+    std::int64_t duration;
+    unsigned tid;
+    trace::arguments args;
+};
+
+std::mutex s_mutex;
+std::vector<event> s_events;
+std::chrono::steady_clock::time_point s_start;
+std::atomic<unsigned> s_next_tid{1};
+
+// Small sequential ids are easier to follow in the viewer than the ids
+// of system.
+unsigned thread_id()
+{
+    thread_local unsigned id = s_next_tid++;
+    return id;
+}
+
+void write_escaped(std::string& o, const char* s)
+{
+    for (; *s != '\0'; ++s) {
+        unsigned char c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\') {
+            o += '\\';
+            o += *s;
+        } else if (c < 0x20) {
+            char b[8];
+            std::snprintf(b, sizeof(b), "\\u%04x", c);
+            o += b;
+        } else {
+            o += *s;
+        }
+    }
+}
+
+void write_event(std::string& o, const event& e, int pid)
+{
+    o += "{\"name\":\"";
+    write_escaped(o, e.name);
+    o += "\",\"cat\":\"";
+    write_escaped(o, e.category);
+    o += "\",\"ph\":\"X\",\"ts\":";
+    o += std::to_string(e.ts);
+    o += ",\"dur\":";
+    o += std::to_string(e.duration);
+    o += ",\"pid\":";
+    o += std::to_string(pid);
+    o += ",\"tid\":";
+    o += std::to_string(e.tid);
+    if (!e.args.empty()) {
+        o += ",\"args\":{";
+        for (std::size_t i = 0; i < e.args.size(); ++i) {
+            if (i != 0) {
+                o += ',';
+            }
+            o += '"';
+            write_escaped(o, e.args[i].first);
+            o += "\":\"";
+            write_escaped(o, e.args[i].second.c_str());
+            o += '"';
+        }
+        o += '}';
+    }
+    o += '}';
+}
+
+}
+
+void trace::start()
+{
+    std::lock_guard<std::mutex> l(s_mutex);
+    s_events.clear();
+    s_start = std::chrono::steady_clock::now();
+    g_enabled = true;
+}
+
+std::int64_t trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - s_start).count();
+}
+
+void trace::record(const char* c, const char* n, std::int64_t ts, std::int64_t d,
+        arguments a)
+{
+    event e{c, n, ts, d, thread_id(), std::move(a)};
+    std::lock_guard<std::mutex> l(s_mutex);
+    s_events.push_back(std::move(e));
+}
+
+void trace::write(const std::string& file)
+{
+    g_enabled = false;
+    std::lock_guard<std::mutex> l(s_mutex);
+    int pid = getpid();
+    std::string o = "{\"traceEvents\":[\n";
+    o += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid)
+        + ",\"args\":{\"name\":\"liquidfiles\"}}";
+    for (const auto& e : s_events) {
+        o += ",\n";
+        write_event(o, e, pid);
+    }
+    o += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    s_events.clear();
+    std::FILE* f = std::fopen(file.c_str(), "w");
+    if (f == nullptr) {
+        throw write_error(file);
+    }
+    bool ok = std::fwrite(o.data(), 1, o.size(), f) == o.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) {
+        throw write_error(file);
+    }
+}
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace base {
+
+/**
+ * @namespace trace
+ * @brief Recording of spans in Chrome trace-event format.
+ *
+ *        Recording is off by default, then spans cost one atomic load.
+ *        The written file can be opened in Perfetto or chrome://tracing.
+ */
+namespace trace
+{
+    /// @brief Arguments attached to span.
+    using arguments = std::vector<std::pair<const char*, std::string>>;
+
+    /// @brief Recording flag, use enabled() instead.
+    extern std::atomic<bool> g_enabled;
+
+    /// @brief Checks whether spans are recorded.
+    inline bool enabled()
+    {
+        return g_enabled.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Starts recording, the time stamps are relative to this call.
+    void start();
+
+    /// @brief Returns microseconds elapsed since start.
+    std::int64_t now();
+
+    /**
+     * @brief Records complete span.
+     * @param c Category, e.g. "http".
+     * @param n Name of span.
+     * @param ts Start time, in microseconds since start.
+     * @param d Duration in microseconds.
+     * @param a Arguments.
+     */
+    void record(const char* c, const char* n, std::int64_t ts, std::int64_t d,
+            arguments a = arguments());
+
+    /**
+     * @brief Stops recording and writes recorded spans to the file.
+     * @throw write_error.
+     */
+    void write(const std::string& file);
+}
+
+/**
+ * @class trace_span
+ * @brief Records span from construction till destruction on the current
+ *        thread, if tracing is enabled.
+ */
+class trace_span final
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param c Category, must be literal.
+     * @param n Name, must be literal.
+     */
+    trace_span(const char* c, const char* n)
+        : m_category{c}
+        , m_name{n}
+        , m_start{trace::enabled() ? trace::now() : -1}
+    {
+    }
+
+    ~trace_span()
+    {
+        if (m_start >= 0) {
+            trace::record(m_category, m_name, m_start, trace::now() - m_start,
+                    std::move(m_arguments));
+        }
+    }
+
+    trace_span(const trace_span&) = delete;
+    trace_span& operator=(const trace_span&) = delete;
+
+public:
+    /// @brief Attaches argument to the span, key must be literal.
+    void arg(const char* k, const std::string& v)
+    {
+        if (m_start >= 0) {
+            m_arguments.emplace_back(k, v);
+        }
+    }
+
+private:
+    const char* m_category;
+    const char* m_name;
+    std::int64_t m_start;
+    trace::arguments m_arguments;
+};
+
+}
@@ -89,6 +89,32 @@ public:
     }
 };
 
+/**
+ * @brief Converts the value of argument to given type.
+ *
+ *        Strings and numbers are converted directly from the arguments,
+ *        other types through string_to_val.
+ */
+template <typename T>
+inline T value_to_val(const argument_value& v)
+{
+    return string_to_val<T>(v.str());
+}
+
+template <>
+inline std::string value_to_val<std::string>(const argument_value& v)
+{
+    return v.str();
+}
+
+template <>
+inline int value_to_val<int>(const argument_value& v)
+{
+    int r;
+    base::parse_integer(v.data, v.data + v.size, r);
+    return r;
+}
+
 enum class argument_name_type {
     unnamed,
     boolean,
@@ -155,14 +181,19 @@ class argument_definition_base<argument_name_type::boolean, r>
 public:
     argument_definition_base(const std::string& name,
             const std::string& description)
-        : m_name{name}
+        : m_key{"-" + name}
         , m_description{description}
     {
     }
 
-    std::string name() const
+    const std::string& name() const
     {
-        return std::string("-") + m_name;
+        return m_key.name;
+    }
+
+    const argument_key& key() const
+    {
+        return m_key;
     }
 
     std::string usage() const
@@ -188,7 +219,7 @@ public:
     }
 
 private:
-    std::string m_name;
+    argument_key m_key;
     std::string m_description;
 };
 
@@ -199,15 +230,20 @@ public:
     argument_definition_base(const std::string& name,
             const std::string& type_string,
             const std::string& description)
-        : m_name{name}
+        : m_key{"--" + name}
         , m_type_string{type_string}
         , m_description{description}
     {
     }
 
-    std::string name() const
+    const std::string& name() const
+    {
+        return m_key.name;
+    }
+
+    const argument_key& key() const
     {
-        return std::string("--") + m_name;
+        return m_key;
     }
 
     std::string usage() const
@@ -235,7 +271,7 @@ public:
     }
 
 private:
-    std::string m_name;
+    argument_key m_key;
     std::string m_type_string;
     std::string m_description;
 };
@@ -322,11 +358,7 @@ public:
 private:
     bool get_value(const arguments& a)
     {
-        auto& b = a.boolean_arguments;
-        if (b.find(parent::name()) != b.end()) {
-            return true;
-        }
-        return false;
+        return a.exists(parent::key());
     }
 };
 
@@ -358,16 +390,11 @@ public:
 
     T value(const arguments& a)
     {
-        return string_to_val<T>(get_value(a));
-    }
-
-private:
-    std::string get_value(const arguments& a)
-    {
-        if (!a.exists(parent::name())) {
+        argument_value v = a.find(parent::key());
+        if (!v.found()) {
             throw missing_argument(parent::name());
         }
-        return a[parent::name()];
+        return value_to_val<T>(v);
     }
 };
 
@@ -417,10 +444,11 @@ public:
 
     T value(const arguments& a)
     {
-        if (!a.exists(name())) {
+        argument_value v = a.find(key());
+        if (!v.found()) {
             return m_default_value;
         }
-        return string_to_val<T>(a[name()]);
+        return value_to_val<T>(v);
     }
 
 private:
@@ -25,7 +25,15 @@ inline std::string possible_values()
 template <>
 inline int string_to_val<int>(const std::string& v)
 {
-    return base::from_string<int>(v);
+    int r;
+    base::parse_integer(v.data(), v.data() + v.size(), r);
+    return r;
+}
+
+template <>
+inline std::string val_to_string<int>(const int& t)
+{
+    return base::to_string(t);
 }
 
 }
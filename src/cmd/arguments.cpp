@@ -1,48 +1,68 @@
 #include "arguments.h"
 #include "utility.h"
 
+#include <cstring>
+
 namespace cmd {
 
 bool arguments::exists(const std::string& n) const
 {
-    return named_arguments.find(n) != named_arguments.end();
+    return exists(argument_key(n));
 }
 
-const std::string& arguments::operator[](const std::string& n) const
+bool arguments::exists(const argument_key& k) const
 {
-    static std::string empty_string;
-    auto i = named_arguments.find(n);
-    if (i != named_arguments.end()) {
-        return i->second;
+    return lookup(k) != nullptr;
+}
+
+argument_value arguments::find(const argument_key& k) const
+{
+    const entry* e = lookup(k);
+    if (e == nullptr || e->name_size == m_tokens[e->token].size()) {
+        return argument_value{nullptr, 0};
+    }
+    const std::string& t = m_tokens[e->token];
+    // Value follows the '=' after name.
+    return argument_value{t.data() + e->name_size + 1, t.size() - e->name_size - 1};
+}
+
+const arguments::entry* arguments::lookup(const argument_key& k) const
+{
+    // Commands have few arguments, linear scan of hashes is faster than
+    // any search structure.
+    for (const auto& e : m_entries) {
+        if (e.hash == k.hash && e.name_size == k.name.size() &&
+                std::memcmp(m_tokens[e.token].data(), k.name.data(), e.name_size) == 0) {
+            return &e;
+        }
     }
-    return empty_string;
+    return nullptr;
 }
 
 arguments arguments::construct(const std::string& str)
 {
     std::vector<std::string> v;
     utility::split(v, str, " ");
-    return construct(v);
+    return construct(std::move(v));
 }
 
-arguments arguments::construct(const std::vector<std::string>& str)
+arguments arguments::construct(std::vector<std::string> str)
 {
-    std::map<std::string, std::string> n;
+    std::vector<entry> n;
+    n.reserve(str.size());
     std::set<std::string> u;
-    std::set<std::string> b;
-    std::vector<std::string>::const_iterator i = str.begin();
-    while (i != str.end()) {
-        if (utility::is_named_argument(*i)) {
-            std::pair<std::string, std::string> p = utility::split(*i, "=");
-            n.insert(std::make_pair(p.first, p.second));
-        } else if (utility::is_boolean_argument(*i)) {
-            b.insert(*i);
+    for (std::size_t i = 0; i < str.size(); ++i) {
+        const std::string& a = str[i];
+        std::size_t p = a.find('=');
+        if (p != std::string::npos) {
+            n.push_back(entry{hash_name(a.data(), p), i, p});
+        } else if (utility::is_boolean_argument(a)) {
+            n.push_back(entry{hash_name(a.data(), a.size()), i, a.size()});
         } else {
-            u.insert(*i);
+            u.insert(a);
         }
-        ++i;
     }
-    return arguments{n, u, b};
+    return arguments{std::move(str), std::move(n), std::move(u)};
 }
 
 }
@@ -1,14 +1,72 @@
 #pragma once
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace cmd {
 
+/// @brief Returns FNV-1a hash of the first n characters of name.
+inline std::uint64_t hash_name(const char* s, std::size_t n)
+{
+    std::uint64_t h = 14695981039346656037ULL;
+    for (std::size_t i = 0; i < n; ++i) {
+        h = (h ^ static_cast<unsigned char>(s[i])) * 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * @class argument_key
+ * @brief Name of argument with its hash, computed once when the argument
+ *        is defined, so the lookups neither hash nor allocate.
+ */
+class argument_key final
+{
+public:
+    /// @param n Full name of argument, e.g. "--server" or "-k".
+    argument_key(const std::string& n)
+        : name{n}
+        , hash{hash_name(n.data(), n.size())}
+    {
+    }
+
+public:
+    const std::string name;
+    const std::uint64_t hash;
+};
+
+/**
+ * @struct argument_value
+ * @brief Value of named argument, points into the arguments.
+ */
+struct argument_value
+{
+    const char* data;
+    std::size_t size;
+
+    /// @brief Checks whether the argument is specified.
+    bool found() const
+    {
+        return data != nullptr;
+    }
+
+    /// @brief Returns the copy of value.
+    std::string str() const
+    {
+        return std::string(data, size);
+    }
+};
+
 /// @class arguments
 /// @brief Represents the arguments of command.
+///
+///        Named and boolean arguments are indexed by the hashes of their
+///        names in one flat array and point into the given strings, only
+///        the unnamed arguments (e.g. lists of files) are copied to set.
 class arguments final
 {
 public:
@@ -16,33 +74,50 @@ public:
     /// @param n Name of argument.
     bool exists(const std::string& n) const;
 
-public:
-    /// @brief Access to argument value by argument name.
-    /// @param n Name of argument.
-    /// @note If argument with given name does not exist, empty value returned.
-    const std::string& operator[](const std::string& n) const;
+    /// @brief Checks whether named or boolean argument exists.
+    bool exists(const argument_key& k) const;
+
+    /// @brief Returns the value of named argument, not found if it is not
+    ///        specified.
+    argument_value find(const argument_key& k) const;
 
 public:
     /// @brief Constructs and returns arguments from given string.
     static arguments construct(const std::string& str);
 
     /// @brief Constructs and returns arguments from given strings.
-    static arguments construct(const std::vector<std::string>& str);
+    static arguments construct(std::vector<std::string> str);
+
+public:
+    arguments(arguments&&) = default;
+    arguments(const arguments&) = delete;
+    arguments& operator=(const arguments&) = delete;
 
 public:
-    const std::map<std::string, std::string> named_arguments;
     const std::set<std::string> unnamed_arguments;
-    const std::set<std::string> boolean_arguments;
 
 private:
-    arguments(std::map<std::string, std::string> n,
-              std::set<std::string> u,
-              std::set<std::string> b)
-        : named_arguments{n}
-        , unnamed_arguments{u}
-        , boolean_arguments{b}
+    struct entry
+    {
+        std::uint64_t hash;
+        std::size_t token;
+        std::size_t name_size;
+    };
+
+    arguments(std::vector<std::string> t,
+              std::vector<entry> e,
+              std::set<std::string> u)
+        : unnamed_arguments{std::move(u)}
+        , m_tokens{std::move(t)}
+        , m_entries{std::move(e)}
     {
     }
+
+    const entry* lookup(const argument_key& k) const;
+
+private:
+    std::vector<std::string> m_tokens;
+    std::vector<entry> m_entries;
 };
 
 }
@@ -4,36 +4,54 @@
 #include "utility.h"
 
 #include <base/exception.h>
-#include <io/messenger.h>
+#include <io/output.h>
+
+#include <cstring>
 
 namespace cmd {
 
-command_processor::command_processor(io::messenger& m)
-    : m_messenger{m}
+command_processor::command_processor(io::output& m)
+    : m_table{nullptr}
+    , m_table_size{0}
+    , m_output{m}
 {
 }
 
 command_processor::~command_processor()
 {
     for (const auto& i : m_commands) {
-        delete i.second;
+        delete i;
     }
     m_commands.clear();
 }
 
-void command_processor::register_command(command* c)
+void command_processor::register_commands(const command_entry* b, const command_entry* e)
 {
-    if (m_commands.find(c->name) != m_commands.end()) {
-        throw duplicate_name(c->name);
+    std::size_t n = e - b;
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < i; ++j) {
+            if (std::strcmp(b[i].name, b[j].name) == 0) {
+                throw duplicate_name(b[i].name);
+            }
+        }
     }
-    m_commands[c->name] = c;
+    for (const auto& i : m_commands) {
+        delete i;
+    }
+    m_table = b;
+    m_table_size = n;
+    m_commands.assign(n, nullptr);
 }
 
 command* command_processor::get_command(std::string name)
 {
-    registry::iterator i = m_commands.find(name);
-    if (i != m_commands.end()) {
-        return i->second;
+    for (std::size_t i = 0; i < m_table_size; ++i) {
+        if (name == m_table[i].name) {
+            if (m_commands[i] == nullptr) {
+                m_commands[i] = m_table[i].create(*this);
+            }
+            return m_commands[i];
+        }
     }
     return 0;
 }
@@ -49,30 +67,30 @@ int command_processor::execute(const std::string& str)
         arguments args = arguments::construct(p.second);
         c->execute(args);
     } catch(base::exception& e) {
-        m_messenger << "Error: " << e.message << io::endl;
+        m_output << "Error: " << e.message << io::endl;
         return e.code;
     } catch(std::exception& e) {
-        m_messenger << "Error: " << e.what() << io::endl;
+        m_output << "Error: " << e.what() << io::endl;
         return 1;
     }
     return 0;
 }
 
 int command_processor::execute(const std::string& cn,
-        const std::vector<std::string>& args)
+        std::vector<std::string> args)
 {
     try {
         command* c = get_command(cn);
         if (c == 0) {
             throw invalid_command_name(cn);
         }
-        arguments a = arguments::construct(args);
+        arguments a = arguments::construct(std::move(args));
         c->execute(a);
     } catch(base::exception& e) {
-        m_messenger << "Error: " << e.message << io::endl;
+        m_output << "Error: " << e.message << io::endl;
         return e.code;
     } catch(std::exception& e) {
-        m_messenger << "Error: " << e.what() << io::endl;
+        m_output << "Error: " << e.what() << io::endl;
         return 1;
     }
     return 0;
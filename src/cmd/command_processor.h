@@ -1,24 +1,39 @@
 #pragma once
 
-#include <algorithm>
-#include <map>
+#include <cstddef>
 #include <string>
 #include <vector>
 
 namespace io {
-class messenger;
+class output;
 }
 
 namespace cmd {
 
 class command;
+class command_processor;
+
+/**
+ * @struct command_entry
+ * @brief Entry of static command table, names the command and creates it
+ *        when it is needed.
+ */
+struct command_entry
+{
+    /// @brief Name of command.
+    const char* name;
+
+    /// @brief Creates the command.
+    command* (*create)(command_processor& p);
+};
 
 /**
  * @class command_processor
  * @brief Central place to store and handle commands.
  *
  *        command_processor is the class which is used to create new commands
- *        and execute them.
+ *        and execute them. Commands are created from the table on first
+ *        access, so the run pays only for the commands it uses.
  */
 class command_processor final
 {
@@ -26,8 +41,8 @@ class command_processor final
     /// @{
 public:
     /// @brief Constructor.
-    /// @param m Messenger.
-    command_processor(io::messenger& m);
+    /// @param m Output of messages and errors.
+    command_processor(io::output& m);
 
     /// @brief Destructor.
     ~command_processor();
@@ -40,23 +55,25 @@ public:
     /// @{
 public:
     /**
-     * @brief Registers the given command.
-     * @param c Command to register.
+     * @brief Registers the commands of given table.
+     * @param b, e Range of table, must outlive the processor.
      * @throw duplicate_name
      */
-    void register_command(command* c);
+    void register_commands(const command_entry* b, const command_entry* e);
 
 public:
     /**
      * @brief Access to command by given name.
      * @param name Name of command to get.
      * @note If command with given name does not exist, NULL is returned.
+     * @note Command is created on first access.
      */
     command* get_command(std::string name);
 
 public:
     /**
-     * @brief Access to the names of commands by functor.
+     * @brief Access to the names of commands by functor, in the order of
+     *        table.
      */
     template <typename F>
     void for_each_command_name(F f) const;
@@ -80,21 +97,22 @@ public:
      * @param args Arguments strings.
      */
     int execute(const std::string& cn,
-            const std::vector<std::string>& args);
+            std::vector<std::string> args);
     /// @}
 
 private:
-    using registry = std::map<std::string, command*>;
-    registry m_commands;
-    io::messenger& m_messenger;
+    const command_entry* m_table;
+    std::size_t m_table_size;
+    std::vector<command*> m_commands;
+    io::output& m_output;
 };
 
 template <typename F>
 void command_processor::for_each_command_name(F f) const
 {
-    std::for_each(m_commands.begin(), m_commands.end(), [&f](const std::pair<std::string, command*>&p) {
-            f(p.first);
-        });
+    for (std::size_t i = 0; i < m_table_size; ++i) {
+        f(std::string(m_table[i].name));
+    }
 }
 
 }
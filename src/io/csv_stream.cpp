@@ -0,0 +1,217 @@
+#include "csv_stream.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace io {
+
+#if defined(__SSE2__)
+namespace {
+
+/// @brief Returns the mask of bytes of x which are special in csv.
+int special_mask(__m128i x, char delimiter)
+{
+    __m128i m = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')),
+                _mm_cmpeq_epi8(x, _mm_set1_epi8(delimiter))),
+            _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\r')),
+                _mm_cmpeq_epi8(x, _mm_set1_epi8('\n'))));
+    return _mm_movemask_epi8(m);
+}
+
+template <typename T>
+T load(const char* d)
+{
+    T v;
+    std::memcpy(&v, d, sizeof(v));
+    return v;
+}
+
+}
+#endif
+
+std::size_t find_csv_special(const char* d, std::size_t n, char delimiter)
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    // Every 16 bytes are compared with the special characters at once.
+    // Shorter fields and tails are read by two overlapping loads of fixed
+    // size, so most of the fields are checked by one comparison.
+    if (n >= 16) {
+        for (; i + 16 <= n; i += 16) {
+            int b = special_mask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i)), delimiter);
+            if (b != 0) {
+                return i + __builtin_ctz(b);
+            }
+        }
+        if (i == n) {
+            return n;
+        }
+        i = n - 16;
+        int b = special_mask(_mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i)), delimiter);
+        return b != 0 ? i + __builtin_ctz(b) : n;
+    }
+    if (n >= 8) {
+        // Loads of 8 bytes, _mm_cvtsi64_si128 exists on x86-64 only.
+        __m128i x = _mm_unpacklo_epi64(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(d)),
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(d + n - 8)));
+        int b = special_mask(x, delimiter);
+        if (b == 0) {
+            return n;
+        }
+        int k = __builtin_ctz(b);
+        return k < 8 ? k : n - 16 + k;
+    }
+    if (n >= 4) {
+        __m128i x = _mm_unpacklo_epi32(
+                _mm_cvtsi32_si128(load<int>(d)),
+                _mm_cvtsi32_si128(load<int>(d + n - 4)));
+        int b = special_mask(x, delimiter) & 0xff;
+        if (b == 0) {
+            return n;
+        }
+        int k = __builtin_ctz(b);
+        return k < 4 ? k : n - 8 + k;
+    }
+#endif
+    for (; i < n; ++i) {
+        char c = d[i];
+        if (c == '"' || c == delimiter || c == '\r' || c == '\n') {
+            return i;
+        }
+    }
+    return n;
+}
+
+csv_istream::csv_istream(std::istream* s, char d)
+    : m_stream{s}
+    , m_buffer(s_buffer_size)
+    , m_begin{0}
+    , m_end{0}
+    , m_in_row{false}
+    , m_delimiter{d}
+{
+}
+
+bool csv_istream::read_row(std::vector<std::string>& r)
+{
+    std::size_t n = 0;
+    field_end e = field_end::delimiter;
+    while (e == field_end::delimiter) {
+        if (n == r.size()) {
+            r.emplace_back();
+        }
+        e = read_field(r[n]);
+        if (e == field_end::stream) {
+            break;
+        }
+        ++n;
+    }
+    r.resize(n);
+    return n != 0;
+}
+
+csv_istream::field_end csv_istream::read_field(std::string& f)
+{
+    f.clear();
+    if (!fill()) {
+        // The record ended by the delimiter has the last empty field.
+        if (m_in_row) {
+            m_in_row = false;
+            return field_end::row;
+        }
+        return field_end::stream;
+    }
+    if (m_buffer[m_begin] == '"') {
+        ++m_begin;
+        read_quoted(f);
+    }
+    while (fill()) {
+        const char* d = m_buffer.data() + m_begin;
+        std::size_t n = m_end - m_begin;
+        std::size_t i = find_csv_special(d, n, m_delimiter);
+        f.append(d, i);
+        if (i == n) {
+            m_begin = m_end;
+            continue;
+        }
+        char c = d[i];
+        m_begin += i + 1;
+        if (c == m_delimiter) {
+            m_in_row = true;
+            return field_end::delimiter;
+        }
+        if (c == '"') {
+            // Quotes inside of unquoted field are kept as they are.
+            f += c;
+            continue;
+        }
+        if (c == '\r' && fill() && m_buffer[m_begin] == '\n') {
+            ++m_begin;
+        }
+        break;
+    }
+    m_in_row = false;
+    return field_end::row;
+}
+
+void csv_istream::read_quoted(std::string& f)
+{
+    while (fill()) {
+        const char* d = m_buffer.data() + m_begin;
+        std::size_t n = m_end - m_begin;
+        const char* q = static_cast<const char*>(std::memchr(d, '"', n));
+        if (q == nullptr) {
+            f.append(d, n);
+            m_begin = m_end;
+            continue;
+        }
+        f.append(d, q - d);
+        m_begin += q - d + 1;
+        // Doubled quote is the quote inside of field.
+        if (!fill() || m_buffer[m_begin] != '"') {
+            return;
+        }
+        f += '"';
+        ++m_begin;
+    }
+}
+
+bool csv_istream::fill()
+{
+    if (m_begin != m_end) {
+        return true;
+    }
+    m_stream->read(m_buffer.data(), m_buffer.size());
+    m_begin = 0;
+    m_end = static_cast<std::size_t>(m_stream->gcount());
+    return m_end != 0;
+}
+
+void csv_ostream::quote(std::size_t b)
+{
+    const char* d = m_buffer.data() + b;
+    std::size_t n = m_buffer.size() - b;
+    std::size_t i = find_csv_special(d, n, m_delimiter);
+    if (i == n) {
+        return;
+    }
+    // The field is rewritten from the first special character, with the
+    // quotes doubled.
+    m_field.assign(d + i, n - i);
+    m_buffer.resize(b + i);
+    m_buffer.insert(b, 1, '"');
+    for (char c : m_field) {
+        if (c == '"') {
+            m_buffer += '"';
+        }
+        m_buffer += c;
+    }
+    m_buffer += '"';
+}
+
+}
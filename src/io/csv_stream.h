@@ -1,80 +1,94 @@
 #pragma once
 
+#include "format.h"
+
+#include <cstddef>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <type_traits>
+#include <vector>
 
 namespace io {
 
 /**
  * @class csv_istream.
- * @brief Functionality to read csv format from stream.
+ * @brief Functionality to read csv format from stream, as RFC 4180
+ *        describes.
+ *
+ *        Quoted fields may contain delimiters, line breaks and doubled
+ *        quotes. Records are ended by CRLF or LF. The stream is read by
+ *        large blocks and the fields are scanned for special characters
+ *        by find_csv_special, runs of ordinary characters are appended
+ *        at once.
  */
 class csv_istream
 {
 public:
     /// @brief Constructor.
-    csv_istream(std::istream* s, char d = ',')
-        : m_stream{s}
-        , m_string{}
-        , m_position{0}
-        , m_delimiter{d}
-    {
-    }
+    csv_istream(std::istream* s, char d = ',');
 
-    /// @brief Read object from stream.
+    csv_istream(const csv_istream&) = delete;
+    csv_istream& operator=(const csv_istream&) = delete;
+
+    /// @brief Read object from stream, ends of records are taken as
+    ///        delimiters.
     template<typename T>
     inline csv_istream& operator >> (T& val)
     {
-        std::string str = get_delimited_str();
-        std::istringstream is(str);
+        read_field(m_field);
+        std::istringstream is(m_field);
         is >> val;
         return *this;
     }
 
+    /**
+     * @brief Reads the fields of the next record.
+     * @param[out] r Fields, the strings are reused.
+     * @return false if there are no more records.
+     */
+    bool read_row(std::vector<std::string>& r);
+
 private:
-    char get_delimiter() const
-    {
-        return m_delimiter;
-    }
+    /// @brief What follows the field.
+    enum class field_end {
+        delimiter,
+        row,
+        stream
+    };
 
-    std::string get_delimited_str()
-    {
-        std::string str = "";
-        char ch = '\0';
-        do {
-            if (m_position >= m_string.size()) {
-                if (!m_stream->eof()) {
-                    std::getline(*m_stream, m_string);
-                    m_position = 0;
-                } else {
-                    m_string = "";
-                    break;
-                }
-                if (!str.empty()) {
-                    return str;
-                }
-            }
-            ch = m_string[m_position];
-            ++m_position;
-            if (ch == m_delimiter || ch == '\r' || ch == '\n') {
-                break;
-            }
-            str += ch;
-        } while(true);
-        return str;
-    }
+    field_end read_field(std::string& f);
+    void read_quoted(std::string& f);
+    bool fill();
 
 private:
+    static constexpr std::size_t s_buffer_size = 64 * 1024;
+
     std::istream* m_stream;
-    std::string m_string;
-    size_t m_position;
+    std::vector<char> m_buffer;
+    std::size_t m_begin;
+    std::size_t m_end;
+    std::string m_field;
+    bool m_in_row;
     char m_delimiter;
 };
 
+/**
+ * @brief Finds the first character which requires the csv field to be
+ *        quoted: quote, delimiter, carriage return or line feed.
+ * @return Position of the character, n if there is no.
+ */
+std::size_t find_csv_special(const char* d, std::size_t n, char delimiter);
+
 /**
  * @class csv_ostream.
- * @brief Functionality to write csv strings.
+ * @brief Functionality to write csv strings, as RFC 4180 describes.
+ *
+ *        Fields with quotes, delimiters or line breaks are enclosed in
+ *        quotes, the quotes inside are doubled. Records are ended by
+ *        end_row() or by '\n', with CRLF.
+ *        Fields are formatted into the buffer, which is written to the
+ *        stream at the end of record, by flush() and on destruction.
  */
 class csv_ostream
 {
@@ -87,19 +101,54 @@ public:
     {
     }
 
+    /// @brief Destructor, writes the buffered fields.
+    ~csv_ostream()
+    {
+        flush();
+    }
+
+    csv_ostream(const csv_ostream&) = delete;
+    csv_ostream& operator=(const csv_ostream&) = delete;
+
     /// @brief Write object to stream.
     template <typename T>
     inline csv_ostream& operator << (const T& val)
     {
         if (!get_after_newline()) {
-            get_stream() << get_delimiter();
+            m_buffer += get_delimiter();
+        }
+        std::size_t b = m_buffer.size();
+        append_text(m_buffer, val);
+        if (!std::is_arithmetic<T>::value) {
+            quote(b);
         }
-        get_stream() << val;
         set_after_newline(false);
+        if (m_buffer.size() >= s_flush_size) {
+            flush();
+        }
         return *this;
     }
 
+    /// @brief Ends the record, writes it to stream.
+    void end_row()
+    {
+        m_buffer += "\r\n";
+        set_after_newline(true);
+        flush();
+    }
+
+    /// @brief Writes the buffered fields to stream.
+    void flush()
+    {
+        if (!m_buffer.empty()) {
+            get_stream().write(m_buffer.data(), m_buffer.size());
+            m_buffer.clear();
+        }
+    }
+
 private:
+    void quote(std::size_t b);
+
     char get_delimiter() const
     {
         return m_delimiter;
@@ -121,7 +170,11 @@ private:
     }
 
 private:
+    static constexpr std::size_t s_flush_size = 64 * 1024;
+
     std::ostream* m_stream;
+    std::string m_buffer;
+    std::string m_field;
     bool m_after_newline;
     char m_delimiter;
 };
@@ -129,16 +182,17 @@ private:
 template <>
 inline csv_istream& csv_istream::operator >> (std::string& val)
 {
-    val = get_delimited_str();
+    read_field(val);
     return *this;
 }
 
 template <>
 inline csv_ostream& csv_ostream::operator << (const char& val)
 {
-    get_stream() << val;
     if (val == '\n') {
-        set_after_newline(true);
+        end_row();
+    } else {
+        m_buffer += val;
     }
     return *this;
 }
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <base/exception.h>
+
+#include <string>
+
+namespace io {
+
+class invalid_json final : public base::exception
+{
+public:
+    invalid_json(const std::string& m)
+        : base::exception{std::string("Invalid JSON in responce: ") + m, 3}
+    {
+    }
+};
+
+}
@@ -0,0 +1,146 @@
+#include "format.h"
+
+#include <cstdio>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace io {
+
+namespace {
+
+constexpr char s_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+constexpr char s_hex_digits[] = "0123456789abcdef";
+
+bool is_json_special(unsigned char c)
+{
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+/// @brief Returns the position of the first character of [d, e) which is
+///        escaped in json string, e if there is no such character.
+const char* find_json_special(const char* d, const char* e)
+{
+#if defined(__SSE2__)
+    // Every 16 bytes are checked at once, control characters are those
+    // which are not changed by the unsigned minimum with 0x1f.
+    const __m128i q = _mm_set1_epi8('"');
+    const __m128i b = _mm_set1_epi8('\\');
+    const __m128i c = _mm_set1_epi8(0x1f);
+    for (; e - d >= 16; d += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d));
+        __m128i m = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(x, q), _mm_cmpeq_epi8(x, b)),
+                _mm_cmpeq_epi8(_mm_min_epu8(x, c), x));
+        int k = _mm_movemask_epi8(m);
+        if (k != 0) {
+            return d + __builtin_ctz(k);
+        }
+    }
+#endif
+    for (; d != e; ++d) {
+        if (is_json_special(static_cast<unsigned char>(*d))) {
+            return d;
+        }
+    }
+    return e;
+}
+
+template <typename... A>
+void append_printf(std::string& s, const char* f, A... a)
+{
+    char b[64];
+    int n = std::snprintf(b, sizeof(b), f, a...);
+    if (n < 0) {
+        return;
+    }
+    std::size_t c = static_cast<std::size_t>(n);
+    if (c < sizeof(b)) {
+        s.append(b, c);
+        return;
+    }
+    std::size_t o = s.size();
+    s.resize(o + c + 1);
+    std::snprintf(&s[o], c + 1, f, a...);
+    s.resize(o + c);
+}
+
+}
+
+char* format_decimal(char* e, unsigned long long v)
+{
+    // Two digits per division.
+    while (v >= 100) {
+        unsigned i = static_cast<unsigned>(v % 100) * 2;
+        v /= 100;
+        *--e = s_digit_pairs[i + 1];
+        *--e = s_digit_pairs[i];
+    }
+    if (v >= 10) {
+        unsigned i = static_cast<unsigned>(v) * 2;
+        *--e = s_digit_pairs[i + 1];
+        *--e = s_digit_pairs[i];
+    } else {
+        *--e = static_cast<char>('0' + v);
+    }
+    return e;
+}
+
+void append_fixed(std::string& s, double v, int w, int p)
+{
+    append_printf(s, "%*.*f", w, p, v);
+}
+
+void append_double(std::string& s, double v)
+{
+    append_printf(s, "%g", v);
+}
+
+void append_json_string(std::string& s, const char* d, std::size_t n)
+{
+    s += '"';
+    const char* e = d + n;
+    // Runs of characters which need no escaping are appended at once.
+    for (const char* p = find_json_special(d, e); p != e; p = find_json_special(d, e)) {
+        s.append(d, p - d);
+        d = p + 1;
+        unsigned char c = static_cast<unsigned char>(*p);
+        s += '\\';
+        switch (c) {
+        case '"':
+        case '\\':
+            s += static_cast<char>(c);
+            break;
+        case '\n':
+            s += 'n';
+            break;
+        case '\r':
+            s += 'r';
+            break;
+        case '\t':
+            s += 't';
+            break;
+        default:
+            s += "u00";
+            s += s_hex_digits[c >> 4];
+            s += s_hex_digits[c & 0xf];
+            break;
+        }
+    }
+    s.append(d, e - d);
+    s += '"';
+}
+
+}
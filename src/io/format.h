@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+namespace io {
+
+/**
+ * @brief Writes decimal digits of v into the buffer which ends at e.
+ * @return Pointer to the first digit.
+ */
+char* format_decimal(char* e, unsigned long long v);
+
+/**
+ * @brief Appends v as printf "%*.*f" does.
+ * @param w Minimal width, the number is right aligned.
+ * @param p Count of digits after the decimal point.
+ */
+void append_fixed(std::string& s, double v, int w, int p);
+
+/// @brief Appends v as std::ostream with default flags does.
+void append_double(std::string& s, double v);
+
+/// @brief Appends n characters of d as json string, in quotes.
+void append_json_string(std::string& s, const char* d, std::size_t n);
+
+/// @brief Appends decimal representation of integer v.
+template <typename T>
+void append_integer(std::string& s, T v)
+{
+    // Digits of the largest integer and the sign.
+    char b[24];
+    char* e = b + sizeof(b);
+    unsigned long long u = static_cast<unsigned long long>(v);
+    bool negative = v < T();
+    char* p = format_decimal(e, negative ? 0 - u : u);
+    if (negative) {
+        *--p = '-';
+    }
+    s.append(p, e - p);
+}
+
+// append_text appends the text of value, as std::ostream with default
+// flags writes it, without the overhead of stream formatting.
+
+/// @brief Appends C string.
+inline void append_text(std::string& s, const char* v)
+{
+    s.append(v);
+}
+
+/// @brief Appends character.
+inline void append_text(std::string& s, char v)
+{
+    s += v;
+}
+
+/// @brief Appends string or string reference, anything with data() and size().
+template <typename T>
+auto append_text(std::string& s, const T& v) -> decltype(s.append(v.data(), v.size()), void())
+{
+    s.append(v.data(), v.size());
+}
+
+/// @brief Appends integer.
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type append_text(std::string& s, T v)
+{
+    append_integer(s, v);
+}
+
+/// @brief Appends floating point number.
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value>::type append_text(std::string& s, T v)
+{
+    append_double(s, v);
+}
+
+}
@@ -0,0 +1,371 @@
+#include "json_extractor.h"
+#include "exceptions.h"
+
+#include <cstdlib>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace io {
+
+namespace {
+
+class index_builder
+{
+public:
+    index_builder(const std::string& d, std::vector<std::uint32_t>& i)
+        : m_data{d.data()}
+        , m_index(i)
+        , m_in_string{false}
+    {
+    }
+
+    void add(std::size_t p)
+    {
+        char c = m_data[p];
+        if (c == '"') {
+            if (m_in_string && escaped(p)) {
+                return;
+            }
+            m_in_string = !m_in_string;
+            m_index.push_back(static_cast<std::uint32_t>(p));
+        } else if (!m_in_string) {
+            m_index.push_back(static_cast<std::uint32_t>(p));
+        }
+    }
+
+private:
+    bool escaped(std::size_t p) const
+    {
+        std::size_t n = 0;
+        while (p > n && m_data[p - n - 1] == '\\') {
+            ++n;
+        }
+        return n % 2 == 1;
+    }
+
+private:
+    const char* m_data;
+    std::vector<std::uint32_t>& m_index;
+    bool m_in_string;
+};
+
+bool is_structural(char c)
+{
+    return c == '"' || c == '{' || c == '}' || c == '[' || c == ']' ||
+        c == ':' || c == ',';
+}
+
+void build_index(const std::string& d, std::vector<std::uint32_t>& x)
+{
+    index_builder b(d, x);
+    const char* s = d.data();
+    std::size_t n = d.size();
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i lbrace = _mm_set1_epi8('{');
+    const __m128i rbrace = _mm_set1_epi8('}');
+    const __m128i lbracket = _mm_set1_epi8('[');
+    const __m128i rbracket = _mm_set1_epi8(']');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i m = _mm_or_si128(
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, colon)),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, lbrace), _mm_cmpeq_epi8(v, rbrace))),
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, lbracket), _mm_cmpeq_epi8(v, rbracket)),
+                    _mm_cmpeq_epi8(v, comma)));
+        unsigned bits = static_cast<unsigned>(_mm_movemask_epi8(m));
+        while (bits != 0) {
+            b.add(i + __builtin_ctz(bits));
+            bits &= bits - 1;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (is_structural(s[i])) {
+            b.add(i);
+        }
+    }
+}
+
+std::size_t skip_whitespace(const std::string& d, std::size_t p)
+{
+    while (p < d.size() && (d[p] == ' ' || d[p] == '\t' || d[p] == '\n' || d[p] == '\r')) {
+        ++p;
+    }
+    return p;
+}
+
+void append_code_point(std::string& s, unsigned c)
+{
+    if (c < 0x80) {
+        s += static_cast<char>(c);
+    } else if (c < 0x800) {
+        s += static_cast<char>(0xC0 | (c >> 6));
+        s += static_cast<char>(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        s += static_cast<char>(0xE0 | (c >> 12));
+        s += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+        s += static_cast<char>(0xF0 | (c >> 18));
+        s += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        s += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        s += static_cast<char>(0x80 | (c & 0x3F));
+    }
+}
+
+bool read_hex(const char* p, const char* e, unsigned& c)
+{
+    if (e - p < 4) {
+        return false;
+    }
+    c = 0;
+    for (int i = 0; i < 4; ++i) {
+        char x = p[i];
+        c <<= 4;
+        if (x >= '0' && x <= '9') {
+            c |= x - '0';
+        } else if (x >= 'a' && x <= 'f') {
+            c |= x - 'a' + 10;
+        } else if (x >= 'A' && x <= 'F') {
+            c |= x - 'A' + 10;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool unescape(const char* p, const char* e, std::string& s)
+{
+    s.clear();
+    while (p != e) {
+        const char* b = p;
+        while (p != e && *p != '\\') {
+            ++p;
+        }
+        s.append(b, p);
+        if (p == e) {
+            break;
+        }
+        if (++p == e) {
+            return false;
+        }
+        switch (*p++) {
+        case '"': s += '"'; break;
+        case '\\': s += '\\'; break;
+        case '/': s += '/'; break;
+        case 'b': s += '\b'; break;
+        case 'f': s += '\f'; break;
+        case 'n': s += '\n'; break;
+        case 'r': s += '\r'; break;
+        case 't': s += '\t'; break;
+        case 'u':
+        {
+            unsigned c = 0;
+            if (!read_hex(p, e, c)) {
+                return false;
+            }
+            p += 4;
+            unsigned l = 0;
+            if (c >= 0xD800 && c < 0xDC00 && e - p >= 6 && p[0] == '\\' &&
+                    p[1] == 'u' && read_hex(p + 2, e, l) && l >= 0xDC00 && l < 0xE000) {
+                c = 0x10000 + ((c - 0xD800) << 10) + (l - 0xDC00);
+                p += 6;
+            } else if (c >= 0xD800 && c < 0xE000) {
+                // Unpaired surrogate.
+                c = 0xFFFD;
+            }
+            append_code_point(s, c);
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+json_extractor::json_extractor(const std::string& d)
+    : m_document(d)
+{
+    build_index(d, m_index);
+}
+
+bool json_extractor::get(const std::string& p, std::string& v) const
+{
+    index::size_type i = 0;
+    if (!find(p, i)) {
+        return false;
+    }
+    std::size_t b = i == 0 ? skip_whitespace(m_document, 0) :
+        skip_whitespace(m_document, m_index[i - 1] + 1);
+    char c = b < m_document.size() ? m_document[b] : '\0';
+    if (c == '"') {
+        if (at(i + 1) != '"') {
+            error("unterminated string");
+        }
+        const char* d = m_document.data();
+        if (!unescape(d + m_index[i] + 1, d + m_index[i + 1], v)) {
+            error("invalid escape sequence");
+        }
+    } else if (c == '{' || c == '[') {
+        index::size_type j = skip_value(i);
+        v.assign(m_document, b, m_index[j - 1] + 1 - b);
+    } else {
+        std::size_t e = i < m_index.size() ? m_index[i] : m_document.size();
+        while (e > b && (m_document[e - 1] == ' ' || m_document[e - 1] == '\t' ||
+                    m_document[e - 1] == '\n' || m_document[e - 1] == '\r')) {
+            --e;
+        }
+        if (e == b) {
+            error("missing value");
+        }
+        v.assign(m_document, b, e - b);
+    }
+    return true;
+}
+
+bool json_extractor::has(const std::string& p) const
+{
+    index::size_type i = 0;
+    return find(p, i);
+}
+
+bool json_extractor::find(const std::string& p, index::size_type& i) const
+{
+    i = 0;
+    std::size_t s = 0;
+    while (s <= p.size()) {
+        std::size_t e = p.find('.', s);
+        if (e == std::string::npos) {
+            e = p.size();
+        }
+        std::string k = p.substr(s, e - s);
+        s = e + 1;
+        std::size_t b = i == 0 ? skip_whitespace(m_document, 0) :
+            skip_whitespace(m_document, m_index[i - 1] + 1);
+        if (i >= m_index.size() || m_index[i] != b) {
+            // Scalar value, there is nothing inside it.
+            return false;
+        }
+        char c = at(i);
+        if (c == '{') {
+            i = find_member(i, k);
+        } else if (c == '[' && !k.empty() &&
+                k.find_first_not_of("0123456789") == std::string::npos) {
+            i = find_element(i, std::atoi(k.c_str()));
+        } else {
+            return false;
+        }
+        if (i == m_index.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+json_extractor::index::size_type json_extractor::skip_value(index::size_type i) const
+{
+    std::size_t b = i == 0 ? skip_whitespace(m_document, 0) :
+        skip_whitespace(m_document, m_index[i - 1] + 1);
+    if (i >= m_index.size() || m_index[i] != b) {
+        return i;
+    }
+    char c = at(i);
+    if (c == '"') {
+        return i + 2;
+    }
+    if (c != '{' && c != '[') {
+        error(std::string("unexpected '") + c + "'");
+    }
+    unsigned depth = 0;
+    for (; i < m_index.size(); ++i) {
+        c = at(i);
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (--depth == 0) {
+                return i + 1;
+            }
+        }
+    }
+    error("unexpected end of document");
+}
+
+json_extractor::index::size_type json_extractor::find_member(index::size_type i,
+        const std::string& k) const
+{
+    ++i;
+    if (at(i) == '}') {
+        return m_index.size();
+    }
+    const char* d = m_document.data();
+    std::string u;
+    while (true) {
+        if (at(i) != '"' || at(i + 1) != '"' || at(i + 2) != ':') {
+            error("invalid object");
+        }
+        const char* b = d + m_index[i] + 1;
+        const char* e = d + m_index[i + 1];
+        bool match = false;
+        if (std::string::traits_type::find(b, e - b, '\\') == nullptr) {
+            match = k.size() == std::size_t(e - b) && k.compare(0, k.size(), b, e - b) == 0;
+        } else {
+            match = unescape(b, e, u) && u == k;
+        }
+        if (match) {
+            return i + 3;
+        }
+        i = skip_value(i + 3);
+        char c = at(i);
+        if (c == '}') {
+            return m_index.size();
+        }
+        if (c != ',') {
+            error("invalid object");
+        }
+        ++i;
+    }
+}
+
+json_extractor::index::size_type json_extractor::find_element(index::size_type i,
+        unsigned n) const
+{
+    std::size_t b = skip_whitespace(m_document, m_index[i] + 1);
+    if (b < m_document.size() && m_document[b] == ']') {
+        return m_index.size();
+    }
+    ++i;
+    for (unsigned x = 0; x < n; ++x) {
+        i = skip_value(i);
+        char c = at(i);
+        if (c == ']') {
+            return m_index.size();
+        }
+        if (c != ',') {
+            error("invalid array");
+        }
+        ++i;
+    }
+    return i;
+}
+
+char json_extractor::at(index::size_type i) const
+{
+    return i < m_index.size() ? m_document[m_index[i]] : '\0';
+}
+
+void json_extractor::error(const std::string& m) const
+{
+    throw invalid_json(m);
+}
+
+}
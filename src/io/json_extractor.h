@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace io {
+
+/**
+ * @class json_extractor
+ * @brief On-demand reader of single fields from json text.
+ *
+ *        On construction the positions of structural characters (quotes,
+ *        braces, brackets, colons and commas outside of strings) are
+ *        indexed, using SIMD instructions where available. Fields are then
+ *        found by walking that index and skipping the values which are not
+ *        on the requested path, so nothing is decoded except the requested
+ *        field itself.
+ *
+ *        Paths are member names and array indices separated by dots,
+ *        for example "message.id" or "errors.0".
+ */
+class json_extractor final
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param d Json text, must outlive the extractor.
+     */
+    json_extractor(const std::string& d);
+
+public:
+    /**
+     * @brief Gets the value of the field by the given path.
+     *
+     *        Strings are unescaped, other scalars are returned as they are
+     *        written in the document, objects and arrays as their raw text.
+     * @param p Path of the field.
+     * @param[out] v Value of the field.
+     * @return false if document has no such field.
+     * @throw invalid_json.
+     */
+    bool get(const std::string& p, std::string& v) const;
+
+    /// @brief Checks whether the document has field by the given path.
+    bool has(const std::string& p) const;
+
+private:
+    using index = std::vector<std::uint32_t>;
+
+    bool find(const std::string& p, index::size_type& i) const;
+    index::size_type skip_value(index::size_type i) const;
+    index::size_type find_member(index::size_type i, const std::string& k) const;
+    index::size_type find_element(index::size_type i, unsigned n) const;
+    char at(index::size_type i) const;
+    [[noreturn]] void error(const std::string& m) const;
+
+private:
+    const std::string& m_document;
+    index m_index;
+};
+
+}
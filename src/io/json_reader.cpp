@@ -0,0 +1,340 @@
+#include "json_reader.h"
+#include "exceptions.h"
+
+namespace io {
+
+json_reader::json_reader(json_handler& h)
+    : m_handler{h}
+    , m_buffer{}
+    , m_lexeme{lexeme::none}
+    , m_expect{expect::value}
+    , m_key{false}
+    , m_code_point{0}
+    , m_code_digits{0}
+    , m_high_surrogate{0}
+{
+}
+
+void json_reader::feed(const char* d, std::size_t n)
+{
+    const char* e = d + n;
+    while (d != e) {
+        switch (m_lexeme) {
+        case lexeme::none:
+            d = read_structure(d, e);
+            break;
+        case lexeme::string:
+            d = read_string(d, e);
+            break;
+        case lexeme::escape:
+            d = read_escape(d);
+            break;
+        case lexeme::unicode:
+            d = read_unicode(d, e);
+            break;
+        case lexeme::number:
+            d = read_number(d, e);
+            break;
+        case lexeme::literal:
+            d = read_literal(d, e);
+            break;
+        }
+    }
+}
+
+void json_reader::finish()
+{
+    if (m_lexeme == lexeme::number) {
+        end_number();
+    } else if (m_lexeme == lexeme::literal) {
+        end_literal();
+    }
+    if (m_lexeme != lexeme::none || m_expect != expect::nothing) {
+        error("unexpected end of document");
+    }
+}
+
+const char* json_reader::read_structure(const char* p, const char* e)
+{
+    for (; p != e; ++p) {
+        char c = *p;
+        switch (c) {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            continue;
+        case '{':
+            begin_value();
+            m_stack.push_back('{');
+            m_expect = expect::key_or_end;
+            m_handler.begin_object();
+            continue;
+        case '[':
+            begin_value();
+            m_stack.push_back('[');
+            m_expect = expect::value_or_end;
+            m_handler.begin_array();
+            continue;
+        case '}':
+            if (m_stack.empty() || m_stack.back() != '{' ||
+                    (m_expect != expect::key_or_end && m_expect != expect::comma_or_end)) {
+                error("unexpected '}'");
+            }
+            m_stack.pop_back();
+            m_handler.end_object();
+            after_value();
+            continue;
+        case ']':
+            if (m_stack.empty() || m_stack.back() != '[' ||
+                    (m_expect != expect::value_or_end && m_expect != expect::comma_or_end)) {
+                error("unexpected ']'");
+            }
+            m_stack.pop_back();
+            m_handler.end_array();
+            after_value();
+            continue;
+        case ',':
+            if (m_expect != expect::comma_or_end) {
+                error("unexpected ','");
+            }
+            m_expect = m_stack.back() == '{' ? expect::key : expect::value;
+            continue;
+        case ':':
+            if (m_expect != expect::colon) {
+                error("unexpected ':'");
+            }
+            m_expect = expect::value;
+            continue;
+        case '"':
+            if (m_expect == expect::key || m_expect == expect::key_or_end) {
+                m_key = true;
+            } else {
+                begin_value();
+                m_key = false;
+            }
+            m_buffer.clear();
+            m_lexeme = lexeme::string;
+            return p + 1;
+        case '-':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            begin_value();
+            m_buffer.assign(1, c);
+            m_lexeme = lexeme::number;
+            return p + 1;
+        case 't':
+        case 'f':
+        case 'n':
+            begin_value();
+            m_buffer.assign(1, c);
+            m_lexeme = lexeme::literal;
+            return p + 1;
+        default:
+            error(std::string("unexpected character '") + c + "'");
+        }
+    }
+    return p;
+}
+
+const char* json_reader::read_string(const char* p, const char* e)
+{
+    if (p != e && *p != '\\') {
+        end_surrogate();
+    }
+    const char* b = p;
+    while (p != e && *p != '"' && *p != '\\') {
+        ++p;
+    }
+    m_buffer.append(b, p);
+    if (p == e) {
+        return p;
+    }
+    if (*p == '\\') {
+        m_lexeme = lexeme::escape;
+        return p + 1;
+    }
+    m_lexeme = lexeme::none;
+    if (m_key) {
+        m_expect = expect::colon;
+        m_handler.key(m_buffer);
+    } else {
+        m_handler.value(json_value_type::string, m_buffer);
+        after_value();
+    }
+    return p + 1;
+}
+
+const char* json_reader::read_escape(const char* p)
+{
+    m_lexeme = lexeme::string;
+    if (*p != 'u') {
+        end_surrogate();
+    }
+    switch (*p) {
+    case '"':
+    case '\\':
+    case '/':
+        m_buffer += *p;
+        break;
+    case 'b':
+        m_buffer += '\b';
+        break;
+    case 'f':
+        m_buffer += '\f';
+        break;
+    case 'n':
+        m_buffer += '\n';
+        break;
+    case 'r':
+        m_buffer += '\r';
+        break;
+    case 't':
+        m_buffer += '\t';
+        break;
+    case 'u':
+        m_lexeme = lexeme::unicode;
+        m_code_point = 0;
+        m_code_digits = 0;
+        break;
+    default:
+        error(std::string("invalid escape '\\") + *p + "'");
+    }
+    return p + 1;
+}
+
+const char* json_reader::read_unicode(const char* p, const char* e)
+{
+    for (; p != e && m_code_digits < 4; ++p, ++m_code_digits) {
+        char c = *p;
+        unsigned x = 0;
+        if (c >= '0' && c <= '9') {
+            x = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            x = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            x = c - 'A' + 10;
+        } else {
+            error("invalid unicode escape");
+        }
+        m_code_point = (m_code_point << 4) | x;
+    }
+    if (m_code_digits < 4) {
+        return p;
+    }
+    m_lexeme = lexeme::string;
+    unsigned c = m_code_point;
+    if (c >= 0xDC00 && c < 0xE000 && m_high_surrogate != 0) {
+        c = 0x10000 + ((m_high_surrogate - 0xD800) << 10) + (c - 0xDC00);
+        m_high_surrogate = 0;
+    } else {
+        end_surrogate();
+        if (c >= 0xD800 && c < 0xDC00) {
+            m_high_surrogate = c;
+            return p;
+        }
+        if (c >= 0xDC00 && c < 0xE000) {
+            c = 0xFFFD;
+        }
+    }
+    append_code_point(c);
+    return p;
+}
+
+const char* json_reader::read_number(const char* p, const char* e)
+{
+    const char* b = p;
+    while (p != e && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' ||
+                *p == 'E' || *p == '+' || *p == '-')) {
+        ++p;
+    }
+    m_buffer.append(b, p);
+    if (p != e) {
+        end_number();
+    }
+    return p;
+}
+
+const char* json_reader::read_literal(const char* p, const char* e)
+{
+    const char* b = p;
+    while (p != e && *p >= 'a' && *p <= 'z') {
+        ++p;
+    }
+    m_buffer.append(b, p);
+    if (p != e) {
+        end_literal();
+    }
+    return p;
+}
+
+void json_reader::end_number()
+{
+    m_lexeme = lexeme::none;
+    if (m_buffer == "-") {
+        error("invalid number");
+    }
+    m_handler.value(json_value_type::number, m_buffer);
+    after_value();
+}
+
+void json_reader::end_literal()
+{
+    m_lexeme = lexeme::none;
+    if (m_buffer == "true" || m_buffer == "false") {
+        m_handler.value(json_value_type::boolean, m_buffer);
+    } else if (m_buffer == "null") {
+        m_handler.value(json_value_type::null, m_buffer);
+    } else {
+        error("invalid literal '" + m_buffer + "'");
+    }
+    after_value();
+}
+
+void json_reader::end_surrogate()
+{
+    // High surrogate not followed by low one is replaced by U+FFFD, as in
+    // json_extractor.
+    if (m_high_surrogate != 0) {
+        m_high_surrogate = 0;
+        append_code_point(0xFFFD);
+    }
+}
+
+void json_reader::append_code_point(unsigned c)
+{
+    if (c < 0x80) {
+        m_buffer += static_cast<char>(c);
+    } else if (c < 0x800) {
+        m_buffer += static_cast<char>(0xC0 | (c >> 6));
+        m_buffer += static_cast<char>(0x80 | (c & 0x3F));
+    } else if (c < 0x10000) {
+        m_buffer += static_cast<char>(0xE0 | (c >> 12));
+        m_buffer += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        m_buffer += static_cast<char>(0x80 | (c & 0x3F));
+    } else {
+        m_buffer += static_cast<char>(0xF0 | (c >> 18));
+        m_buffer += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+        m_buffer += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        m_buffer += static_cast<char>(0x80 | (c & 0x3F));
+    }
+}
+
+void json_reader::begin_value()
+{
+    if (m_expect != expect::value && m_expect != expect::value_or_end) {
+        error("unexpected value");
+    }
+}
+
+void json_reader::after_value()
+{
+    m_expect = m_stack.empty() ? expect::nothing : expect::comma_or_end;
+}
+
+void json_reader::error(const std::string& m) const
+{
+    throw invalid_json(m);
+}
+
+}
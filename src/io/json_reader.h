@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace io {
+
+/// @brief Types of scalar json values.
+enum class json_value_type {
+    string,
+    number,
+    boolean,
+    null
+};
+
+/**
+ * @class json_handler
+ * @brief Receiver of the tokens read by json_reader.
+ *
+ *        String arguments refer to the internal buffer of reader and are
+ *        only valid during the call.
+ */
+class json_handler
+{
+public:
+    virtual ~json_handler() = default;
+
+public:
+    virtual void begin_object() = 0;
+    virtual void end_object() = 0;
+    virtual void begin_array() = 0;
+    virtual void end_array() = 0;
+
+    /// @brief Called for the key of object member, before its value.
+    virtual void key(const std::string& k) = 0;
+
+    /**
+     * @brief Called for scalar values.
+     * @param t Type of value.
+     * @param v Unescaped string, or number, "true", "false", "null" as
+     *        they are written in the document.
+     */
+    virtual void value(json_value_type t, const std::string& v) = 0;
+};
+
+/**
+ * @class json_reader
+ * @brief Incremental (push) json reader.
+ *
+ *        The document can be given by arbitrary chunks, for example as
+ *        they come from network, tokens are passed to the handler as soon
+ *        as they are complete. No document tree is built, so the memory
+ *        usage does not depend on the size of the document.
+ */
+class json_reader final
+{
+public:
+    /// @brief Constructor.
+    /// @param h Handler to pass the tokens.
+    json_reader(json_handler& h);
+
+    json_reader(const json_reader&) = delete;
+    json_reader& operator=(const json_reader&) = delete;
+
+public:
+    /**
+     * @brief Reads the next chunk of document.
+     * @param d Chunk data.
+     * @param n Chunk size.
+     * @throw invalid_json.
+     */
+    void feed(const char* d, std::size_t n);
+
+    /**
+     * @brief Checks that the whole document is read.
+     * @throw invalid_json.
+     */
+    void finish();
+
+private:
+    enum class lexeme {
+        none,
+        string,
+        escape,
+        unicode,
+        number,
+        literal
+    };
+
+    enum class expect {
+        value,
+        value_or_end,
+        key,
+        key_or_end,
+        colon,
+        comma_or_end,
+        nothing
+    };
+
+private:
+    const char* read_structure(const char* p, const char* e);
+    const char* read_string(const char* p, const char* e);
+    const char* read_escape(const char* p);
+    const char* read_unicode(const char* p, const char* e);
+    const char* read_number(const char* p, const char* e);
+    const char* read_literal(const char* p, const char* e);
+    void end_number();
+    void end_literal();
+    void append_code_point(unsigned c);
+    void end_surrogate();
+    void after_value();
+    void begin_value();
+    [[noreturn]] void error(const std::string& m) const;
+
+private:
+    json_handler& m_handler;
+    std::vector<char> m_stack;
+    std::string m_buffer;
+    lexeme m_lexeme;
+    expect m_expect;
+    bool m_key;
+    unsigned m_code_point;
+    unsigned m_code_digits;
+    unsigned m_high_surrogate;
+};
+
+}
@@ -0,0 +1,259 @@
+#include "json_slicer.h"
+#include "exceptions.h"
+
+namespace io {
+
+namespace {
+
+constexpr unsigned s_root_depth = 1;
+constexpr unsigned s_list_depth = 2;
+
+bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+}
+
+json_slicer::json_slicer(const std::string& l, json_slice_handler& h)
+    : m_list{l}
+    , m_handler{h}
+    , m_member{member::other}
+    , m_depth{0}
+    , m_started{false}
+    , m_in_string{false}
+    , m_escape{false}
+    , m_in_key{false}
+    , m_expect_key{true}
+    , m_in_value{false}
+    , m_in_element{false}
+    , m_in_scalar{false}
+    , m_done{false}
+{
+}
+
+void json_slicer::feed(const char* d, std::size_t n)
+{
+    // Start of the element bytes which are not passed to handler yet.
+    const char* run = nullptr;
+    const char* e = d + n;
+    for (const char* p = d; p != e; ++p) {
+        char c = *p;
+        if (m_in_element) {
+            if (m_in_string) {
+                if (run == nullptr) {
+                    run = p;
+                }
+                if (m_escape) {
+                    m_escape = false;
+                } else if (c == '\\') {
+                    m_escape = true;
+                } else if (c == '"') {
+                    m_in_string = false;
+                    if (m_depth == s_list_depth) {
+                        m_handler.element_data(run, p + 1 - run);
+                        run = nullptr;
+                        end_element();
+                    }
+                }
+                continue;
+            }
+            if (m_in_scalar) {
+                if (c != ',' && c != ']' && !is_space(c)) {
+                    if (run == nullptr) {
+                        run = p;
+                    }
+                    continue;
+                }
+                if (run != nullptr) {
+                    m_handler.element_data(run, p - run);
+                    run = nullptr;
+                }
+                end_element();
+                // The delimiter belongs to the list.
+            } else {
+                if (is_space(c)) {
+                    if (run != nullptr) {
+                        m_handler.element_data(run, p - run);
+                        run = nullptr;
+                    }
+                    continue;
+                }
+                if (run == nullptr) {
+                    run = p;
+                }
+                if (c == '"') {
+                    m_in_string = true;
+                } else if (c == '{' || c == '[') {
+                    ++m_depth;
+                } else if (c == '}' || c == ']') {
+                    if (--m_depth == s_list_depth) {
+                        m_handler.element_data(run, p + 1 - run);
+                        run = nullptr;
+                        end_element();
+                    }
+                }
+                continue;
+            }
+        }
+        if (m_member == member::list) {
+            if (is_space(c) || c == ',') {
+                continue;
+            }
+            if (c == ']') {
+                m_depth = s_root_depth;
+                end_value();
+                continue;
+            }
+            m_in_element = true;
+            m_handler.begin_element();
+            run = p;
+            if (c == '{' || c == '[') {
+                ++m_depth;
+            } else if (c == '"') {
+                m_in_string = true;
+            } else {
+                m_in_scalar = true;
+            }
+            continue;
+        }
+        root_char(c);
+    }
+    if (run != nullptr) {
+        m_handler.element_data(run, e - run);
+    }
+}
+
+void json_slicer::root_char(char c)
+{
+    if (!m_started) {
+        if (is_space(c)) {
+            return;
+        }
+        if (c != '{') {
+            throw invalid_json("object expected");
+        }
+        m_started = true;
+        m_depth = s_root_depth;
+        return;
+    }
+    if (m_done) {
+        if (!is_space(c)) {
+            throw invalid_json("unexpected data after document");
+        }
+        return;
+    }
+    if (m_in_value) {
+        if (m_in_scalar) {
+            if (c != ',' && c != '}' && !is_space(c)) {
+                if (m_member == member::errors) {
+                    m_errors += c;
+                }
+                return;
+            }
+            end_value();
+            // The delimiter belongs to the root object.
+        } else {
+            if (m_member == member::errors) {
+                m_errors += c;
+            }
+            if (m_in_string) {
+                if (m_escape) {
+                    m_escape = false;
+                } else if (c == '\\') {
+                    m_escape = true;
+                } else if (c == '"') {
+                    m_in_string = false;
+                    if (m_depth == s_root_depth) {
+                        end_value();
+                    }
+                }
+            } else if (c == '"') {
+                m_in_string = true;
+            } else if (c == '{' || c == '[') {
+                ++m_depth;
+            } else if ((c == '}' || c == ']') && --m_depth == s_root_depth) {
+                end_value();
+            }
+            return;
+        }
+    }
+    if (m_in_key) {
+        if (m_escape) {
+            m_escape = false;
+        } else if (c == '\\') {
+            m_escape = true;
+        } else if (c == '"') {
+            m_in_key = false;
+            m_expect_key = false;
+            return;
+        }
+        m_key += c;
+        return;
+    }
+    if (is_space(c) || c == ':') {
+        return;
+    }
+    if (c == ',') {
+        m_expect_key = true;
+        return;
+    }
+    if (c == '}') {
+        m_depth = 0;
+        m_done = true;
+        return;
+    }
+    if (m_expect_key) {
+        if (c != '"') {
+            throw invalid_json("member name expected");
+        }
+        m_in_key = true;
+        m_key.clear();
+        return;
+    }
+    begin_value(c);
+}
+
+void json_slicer::begin_value(char c)
+{
+    if (m_key == m_list && c == '[') {
+        m_member = member::list;
+        m_depth = s_list_depth;
+        return;
+    }
+    m_member = m_key == "errors" ? member::errors : member::other;
+    m_in_value = true;
+    if (m_member == member::errors) {
+        m_errors += c;
+    }
+    if (c == '"') {
+        m_in_string = true;
+    } else if (c == '{' || c == '[') {
+        ++m_depth;
+    } else {
+        m_in_scalar = true;
+    }
+}
+
+void json_slicer::end_value()
+{
+    m_member = member::other;
+    m_in_value = false;
+    m_in_scalar = false;
+}
+
+void json_slicer::end_element()
+{
+    m_in_element = false;
+    m_in_scalar = false;
+    m_handler.end_element();
+}
+
+void json_slicer::finish()
+{
+    if (!m_done) {
+        throw invalid_json("unexpected end of document");
+    }
+}
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace io {
+
+/**
+ * @class json_slice_handler
+ * @brief Receiver of the elements sliced by json_slicer.
+ */
+class json_slice_handler
+{
+public:
+    virtual ~json_slice_handler() = default;
+
+public:
+    /// @brief Called when the new element of list begins.
+    virtual void begin_element() = 0;
+
+    /**
+     * @brief Called with the pieces of current element, as they are found
+     *        in the chunks of document.
+     * @param d Data, valid only during the call.
+     * @param n Size of data.
+     */
+    virtual void element_data(const char* d, std::size_t n) = 0;
+
+    /// @brief Called when the current element ends.
+    virtual void end_element() = 0;
+};
+
+/**
+ * @class json_slicer
+ * @brief Incremental splitter of the list member of json document into
+ *        the original bytes of its elements.
+ *
+ *        Documents have the form {"<list>": [element, ...], ...}. Only the
+ *        structure is tracked (nesting, strings and escapes), values are
+ *        neither decoded nor validated, so the elements are passed to
+ *        handler with no copying. Whitespace outside of strings is left
+ *        out, each element is written on one line.
+ *        The raw value of root "errors" member is kept, to report the
+ *        errors of server.
+ */
+class json_slicer final
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param l Name of the list member of root object.
+     * @param h Handler of elements.
+     */
+    json_slicer(const std::string& l, json_slice_handler& h);
+
+    json_slicer(const json_slicer&) = delete;
+    json_slicer& operator=(const json_slicer&) = delete;
+
+public:
+    /**
+     * @brief Reads the next chunk of document.
+     * @throw invalid_json if the document is not an object.
+     */
+    void feed(const char* d, std::size_t n);
+
+    /**
+     * @brief Checks that the whole document is read.
+     * @throw invalid_json.
+     */
+    void finish();
+
+    /// @brief Returns the json of root "errors" member, empty if there is
+    ///        no such member.
+    const std::string& errors() const
+    {
+        return m_errors;
+    }
+
+private:
+    /// @brief Member of root object whose value is being read.
+    enum class member {
+        other,
+        list,
+        errors
+    };
+
+    void root_char(char c);
+    void begin_value(char c);
+    void end_value();
+    void end_element();
+
+private:
+    std::string m_list;
+    json_slice_handler& m_handler;
+    std::string m_key;
+    std::string m_errors;
+    member m_member;
+    unsigned m_depth;
+    bool m_started;
+    bool m_in_string;
+    bool m_escape;
+    bool m_in_key;
+    bool m_expect_key;
+    bool m_in_value;
+    bool m_in_element;
+    bool m_in_scalar;
+    bool m_done;
+};
+
+}
@@ -1,10 +0,0 @@
-#include "messenger.h"
-
-namespace io {
-
-messenger* messenger::s_instance = 0;
-endl_type endl;
-flush_type flush;
-messenger& mout = messenger::get();
-
-}
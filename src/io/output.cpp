@@ -0,0 +1,112 @@
+#include "output.h"
+
+#include <cerrno>
+#include <cstring>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace io {
+
+namespace {
+
+constexpr std::size_t s_buffer_size = 256 * 1024;
+
+}
+
+endl_type endl;
+flush_type flush;
+output& mout = output::get();
+
+output_buffer::output_buffer(int fd, std::size_t size)
+    : m_buffer(size)
+    , m_size{0}
+    , m_fd{fd}
+    , m_interactive{isatty(fd) == 1}
+{
+}
+
+output_buffer::~output_buffer()
+{
+    sync();
+}
+
+output_buffer::int_type output_buffer::overflow(int_type c)
+{
+    if (traits_type::eq_int_type(c, traits_type::eof())) {
+        return traits_type::not_eof(c);
+    }
+    char x = traits_type::to_char_type(c);
+    return xsputn(&x, 1) == 1 ? c : traits_type::eof();
+}
+
+std::streamsize output_buffer::xsputn(const char* s, std::streamsize n)
+{
+    std::lock_guard<std::mutex> l(m_mutex);
+    std::size_t c = static_cast<std::size_t>(n);
+    if (c <= m_buffer.size() - m_size) {
+        std::memcpy(m_buffer.data() + m_size, s, c);
+        m_size += c;
+        return n;
+    }
+    return write(s, c) ? n : 0;
+}
+
+int output_buffer::sync()
+{
+    std::lock_guard<std::mutex> l(m_mutex);
+    return write_buffer() ? 0 : -1;
+}
+
+bool output_buffer::write(const char* d, std::size_t n)
+{
+    iovec v[2] = {{m_buffer.data(), m_size}, {const_cast<char*>(d), n}};
+    iovec* b = v;
+    int c = 2;
+    m_size = 0;
+    while (c != 0) {
+        ssize_t r = writev(m_fd, b, c);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        std::size_t w = static_cast<std::size_t>(r);
+        while (c != 0 && w >= b->iov_len) {
+            w -= b->iov_len;
+            ++b;
+            --c;
+        }
+        if (c != 0) {
+            b->iov_base = static_cast<char*>(b->iov_base) + w;
+            b->iov_len -= w;
+        }
+    }
+    return true;
+}
+
+bool output_buffer::write_buffer()
+{
+    if (m_size == 0) {
+        return true;
+    }
+    return write(nullptr, 0);
+}
+
+output& output::get()
+{
+    // Constructed on first use, so it is ready for the statics of other
+    // files; destroyed at exit, before the statics constructed before it,
+    // flushing the buffer.
+    static output o;
+    return o;
+}
+
+output::output()
+    : std::ostream{nullptr}
+    , m_buffer{STDOUT_FILENO, s_buffer_size}
+{
+    rdbuf(&m_buffer);
+}
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+namespace io {
+
+class endl_type{};
+class flush_type{};
+
+extern endl_type endl;
+extern flush_type flush;
+
+/**
+ * @class output_buffer
+ * @brief Stream buffer which collects the output in large block and writes
+ *        it to file descriptor when the block is full or on flush.
+ *
+ *        The buffer has no put area, every write of stream comes to
+ *        xsputn under the lock, so several threads can write to it, each
+ *        write staying whole. Writes
+ *        larger than the free space are written together with the buffered
+ *        data by one writev, without copying.
+ */
+class output_buffer final : public std::streambuf
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param fd File descriptor to write.
+     * @param size Size of buffer.
+     */
+    output_buffer(int fd, std::size_t size);
+
+    /// @brief Destructor, flushes the buffer.
+    ~output_buffer();
+
+    output_buffer(const output_buffer&) = delete;
+    output_buffer& operator=(const output_buffer&) = delete;
+
+public:
+    /// @brief Checks whether the output goes to terminal.
+    bool interactive() const
+    {
+        return m_interactive;
+    }
+
+protected:
+    int_type overflow(int_type c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    int sync() override;
+
+private:
+    bool write(const char* d, std::size_t n);
+    bool write_buffer();
+
+private:
+    std::vector<char> m_buffer;
+    std::size_t m_size;
+    int m_fd;
+    bool m_interactive;
+    std::mutex m_mutex;
+};
+
+/**
+ * @class output
+ * @brief Standard output of utility, for results, messages and errors.
+ *
+ *        Output is flushed by io::flush, by io::endl if it goes to terminal,
+ *        and on exit. Listings written to pipes or files are written by
+ *        large blocks.
+ *
+ *        Only the buffer is shared safely by threads. The format state of
+ *        stream (width, fill, flags) is not synchronized, so other threads
+ *        than main write formatted strings and never change the state.
+ */
+class output final : public std::ostream
+{
+public:
+    /// @brief Returns the standard output.
+    static output& get();
+
+private:
+    output();
+
+    output(const output&) = delete;
+    output& operator=(const output&) = delete;
+
+public:
+    /// @brief Puts end of line, flushes it if output is interactive.
+    output& operator<<(endl_type)
+    {
+        put('\n');
+        if (m_buffer.interactive()) {
+            std::ostream::flush();
+        }
+        return *this;
+    }
+
+    /// @brief Flushes the output.
+    output& operator<<(flush_type)
+    {
+        std::ostream::flush();
+        return *this;
+    }
+
+    /**
+     * @brief Writes given object to the stream.
+     * @param t Object to write.
+     */
+    template <typename T>
+    output& operator<<(const T& t)
+    {
+        static_cast<std::ostream&>(*this) << t;
+        return *this;
+    }
+
+private:
+    output_buffer m_buffer;
+};
+
+extern output& mout;
+
+}
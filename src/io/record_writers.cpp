@@ -0,0 +1,112 @@
+#include "record_writers.h"
+
+namespace io {
+
+constexpr std::size_t table_writer::s_date_size;
+
+table_writer::table_writer(std::ostream& o)
+    : m_output(o)
+    , m_column{0}
+{
+}
+
+void table_writer::add_column(const char* t, int w)
+{
+    m_titles.push_back(t);
+    m_widths.push_back(w);
+}
+
+void table_writer::write_header()
+{
+    m_line += '+';
+    for (int w : m_widths) {
+        m_line.append(w, '-');
+        m_line += '+';
+    }
+    m_line += '\n';
+    m_row = m_line;
+    m_row += '|';
+    for (std::size_t i = 0; i < m_titles.size(); ++i) {
+        std::size_t b = m_row.size();
+        m_row.append(m_titles[i], 0, m_widths[i]);
+        end_cell(b, m_widths[i]);
+    }
+    m_row += '\n';
+    m_row += m_line;
+    m_output.write(m_row.data(), m_row.size());
+    m_row.clear();
+}
+
+void table_writer::end_cell(std::size_t b, int w)
+{
+    std::size_t n = m_row.size() - b;
+    std::size_t c = static_cast<std::size_t>(w);
+    // Cells are right aligned, longer values are not cut.
+    if (n < c) {
+        m_row.insert(b, c - n, ' ');
+    }
+    m_row += '|';
+    ++m_column;
+}
+
+void table_writer::end_record()
+{
+    m_row += '\n';
+    unsigned rows = 0;
+    for (const more& m : m_more) {
+        rows = std::max(rows, m.index);
+    }
+    for (unsigned i = 1; i <= rows; ++i) {
+        m_column = 0;
+        m_row += '|';
+        for (std::size_t c = 0; c < m_widths.size(); ++c) {
+            std::size_t b = m_row.size();
+            for (const more& m : m_more) {
+                if (m.column == c && m.index == i) {
+                    m_row.append(m.data, m.size);
+                    break;
+                }
+            }
+            end_cell(b, m_widths[c]);
+        }
+        m_row += '\n';
+    }
+    m_more.clear();
+    m_row += m_line;
+    m_output.write(m_row.data(), m_row.size());
+    m_row.clear();
+}
+
+json_writer::json_writer(std::ostream& o, bool lines)
+    : m_output(o)
+    , m_lines{lines}
+    , m_empty{true}
+    , m_first{true}
+{
+}
+
+void json_writer::finish()
+{
+    if (!m_lines) {
+        m_text += m_empty ? "[]\n" : "]\n";
+    }
+    flush();
+}
+
+void json_writer::key(const char* k)
+{
+    if (!m_first) {
+        m_text += ',';
+    }
+    m_first = false;
+    append_json_string(m_text, k, std::char_traits<char>::length(k));
+    m_text += ':';
+}
+
+void json_writer::flush()
+{
+    m_output.write(m_text.data(), m_text.size());
+    m_text.clear();
+}
+
+}
@@ -0,0 +1,453 @@
+#pragma once
+
+#include "csv_stream.h"
+#include "format.h"
+#include "table_printer.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace io {
+
+// Records declare their fields once, in order, by the member template
+//
+//     template <typename W>
+//     void fields(W& w) const;
+//
+// which calls for every field one of
+//
+//     w.field(key, title, width, value);       string or number
+//     w.optional(key, title, width, value);    string, left out of text if empty
+//     w.date(key, title, width, value);        timestamp, tables show the date
+//     w.list(key, title, width, values);       strings
+//     w.records(key, title, item, values);     nested records
+//
+// Key names the field in json, title and width describe the column of
+// table, item is the title of nested record. The writers below are
+// instantiated for every record, so the fields are formatted with no
+// runtime dispatch.
+
+/// @brief Appends v as json value.
+inline void append_json(std::string& s, const char* v)
+{
+    append_json_string(s, v, std::char_traits<char>::length(v));
+}
+
+template <typename T>
+auto append_json(std::string& s, const T& v) -> decltype(v.data(), v.size(), void())
+{
+    append_json_string(s, v.data(), v.size());
+}
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type append_json(std::string& s, T v)
+{
+    append_text(s, v);
+}
+
+/**
+ * @class table_writer
+ * @brief Writes records as rows of table, the header is written before
+ *        the first one, every record is followed by horizontal line.
+ *
+ *        The first values of list fields are in the row of record, the
+ *        others are in the next rows under it. Each record is written to
+ *        the stream by one write.
+ */
+class table_writer final
+{
+public:
+    /// @brief Constructor.
+    /// @param o Stream to write.
+    explicit table_writer(std::ostream& o);
+
+public:
+    /// @brief Writes the record.
+    template <typename R>
+    void write(const R& r)
+    {
+        if (m_line.empty()) {
+            header h{*this};
+            r.fields(h);
+            write_header();
+        }
+        m_column = 0;
+        m_row += '|';
+        r.fields(*this);
+        end_record();
+    }
+
+    template <typename T>
+    void field(const char*, const char*, int w, const T& v)
+    {
+        std::size_t b = m_row.size();
+        append_text(m_row, v);
+        end_cell(b, w);
+    }
+
+    template <typename T>
+    void optional(const char* k, const char* t, int w, const T& v)
+    {
+        field(k, t, w, v);
+    }
+
+    template <typename T>
+    void date(const char*, const char*, int w, const T& v)
+    {
+        std::size_t b = m_row.size();
+        m_row.append(v.data(), std::min<std::size_t>(v.size(), s_date_size));
+        end_cell(b, w);
+    }
+
+    template <typename L>
+    void list(const char*, const char*, int w, const L& v)
+    {
+        std::size_t b = m_row.size();
+        unsigned i = 0;
+        for (const auto& x : v) {
+            if (i == 0) {
+                append_text(m_row, x);
+            } else {
+                m_more.push_back(more{m_column, i, x.data(), x.size()});
+            }
+            ++i;
+        }
+        end_cell(b, w);
+    }
+
+private:
+    /// @brief Collects the columns of table.
+    class header final
+    {
+    public:
+        header(table_writer& w)
+            : m_writer(w)
+        {
+        }
+
+        template <typename T>
+        void field(const char*, const char* t, int w, const T&)
+        {
+            m_writer.add_column(t, w);
+        }
+
+        template <typename T>
+        void optional(const char*, const char* t, int w, const T&)
+        {
+            m_writer.add_column(t, w);
+        }
+
+        template <typename T>
+        void date(const char*, const char* t, int w, const T&)
+        {
+            m_writer.add_column(t, w);
+        }
+
+        template <typename T>
+        void list(const char*, const char* t, int w, const T&)
+        {
+            m_writer.add_column(t, w);
+        }
+
+    private:
+        table_writer& m_writer;
+    };
+
+    /// @brief Value of list which is written under the row of record.
+    struct more
+    {
+        unsigned column;
+        unsigned index;
+        const char* data;
+        std::size_t size;
+    };
+
+    void add_column(const char* t, int w);
+    void write_header();
+    void end_cell(std::size_t b, int w);
+    void end_record();
+
+private:
+    static constexpr std::size_t s_date_size = 10;
+
+    std::ostream& m_output;
+    std::vector<std::string> m_titles;
+    std::vector<int> m_widths;
+    std::vector<more> m_more;
+    std::string m_line;
+    std::string m_row;
+    unsigned m_column;
+};
+
+/**
+ * @class text_writer
+ * @brief Writes the record as lines "Title: value", nested records as
+ *        table.
+ */
+class text_writer final
+{
+public:
+    /// @brief Appends the record to text.
+    template <typename R>
+    void write(const R& r)
+    {
+        r.fields(*this);
+    }
+
+    /// @brief Returns the text.
+    const std::string& str() const
+    {
+        return m_text;
+    }
+
+public:
+    template <typename T>
+    void field(const char*, const char* t, int, const T& v)
+    {
+        m_text += t;
+        m_text += ": ";
+        append_text(m_text, v);
+        m_text += '\n';
+    }
+
+    template <typename T>
+    void optional(const char* k, const char* t, int w, const T& v)
+    {
+        if (!v.empty()) {
+            field(k, t, w, v);
+        }
+    }
+
+    template <typename T>
+    void date(const char* k, const char* t, int w, const T& v)
+    {
+        field(k, t, w, v);
+    }
+
+    template <typename L>
+    void list(const char*, const char* t, int, const L& v)
+    {
+        if (v.empty()) {
+            return;
+        }
+        m_text += t;
+        const char* s = ": ";
+        for (const auto& x : v) {
+            m_text += s;
+            append_text(m_text, x);
+            s = ", ";
+        }
+        m_text += '\n';
+    }
+
+    template <typename L>
+    void records(const char*, const char* t, const char* item, const L& v)
+    {
+        if (v.empty()) {
+            return;
+        }
+        m_text += t;
+        m_text += ":\n";
+        std::stringstream m;
+        io::table_printer tp(&m);
+        tp.add_column("N", s_index_width);
+        tp.add_column(item, s_record_width);
+        tp.print_header();
+        int n = 1;
+        for (const auto& x : v) {
+            text_writer w;
+            w.write(x);
+            tp << n++;
+            std::stringstream ss(w.str());
+            std::string s;
+            std::getline(ss, s);
+            tp << s;
+            while (std::getline(ss, s)) {
+                tp << " " << s;
+            }
+            tp.print_footer();
+        }
+        m_text += m.str();
+    }
+
+private:
+    static constexpr int s_index_width = 4;
+    static constexpr int s_record_width = 140;
+
+    std::string m_text;
+};
+
+/**
+ * @class csv_writer
+ * @brief Writes records as csv records.
+ *
+ *        Lists and nested records are written as their count followed by
+ *        the values.
+ */
+class csv_writer final
+{
+public:
+    /// @brief Constructor.
+    /// @param o Stream to write.
+    explicit csv_writer(std::ostream& o)
+        : m_csv{&o}
+    {
+    }
+
+public:
+    /// @brief Writes the record.
+    template <typename R>
+    void write(const R& r)
+    {
+        r.fields(*this);
+        m_csv.end_row();
+    }
+
+    template <typename T>
+    void field(const char*, const char*, int, const T& v)
+    {
+        m_csv << v;
+    }
+
+    template <typename T>
+    void optional(const char*, const char*, int, const T& v)
+    {
+        m_csv << v;
+    }
+
+    template <typename T>
+    void date(const char*, const char*, int, const T& v)
+    {
+        m_csv << v;
+    }
+
+    template <typename L>
+    void list(const char*, const char*, int, const L& v)
+    {
+        m_csv << v.size();
+        for (const auto& x : v) {
+            m_csv << x;
+        }
+    }
+
+    template <typename L>
+    void records(const char*, const char*, const char*, const L& v)
+    {
+        m_csv << v.size();
+        for (const auto& x : v) {
+            x.fields(*this);
+        }
+    }
+
+private:
+    csv_ostream m_csv;
+};
+
+/**
+ * @class json_writer
+ * @brief Writes records as json objects, either elements of array or
+ *        one per line.
+ */
+class json_writer final
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param o Stream to write.
+     * @param lines Whether to write the records on separate lines, instead
+     *        of array.
+     */
+    json_writer(std::ostream& o, bool lines);
+
+public:
+    /// @brief Writes the record.
+    template <typename R>
+    void write(const R& r)
+    {
+        if (!m_lines) {
+            m_text += m_empty ? '[' : ',';
+        }
+        m_empty = false;
+        write_object(r);
+        if (m_lines) {
+            m_text += '\n';
+        }
+        flush();
+    }
+
+    /// @brief Ends the array.
+    void finish();
+
+    template <typename T>
+    void field(const char* k, const char*, int, const T& v)
+    {
+        key(k);
+        append_json(m_text, v);
+    }
+
+    template <typename T>
+    void optional(const char* k, const char* t, int w, const T& v)
+    {
+        field(k, t, w, v);
+    }
+
+    template <typename T>
+    void date(const char* k, const char* t, int w, const T& v)
+    {
+        field(k, t, w, v);
+    }
+
+    template <typename L>
+    void list(const char* k, const char*, int, const L& v)
+    {
+        key(k);
+        char s = '[';
+        for (const auto& x : v) {
+            m_text += s;
+            append_json(m_text, x);
+            s = ',';
+        }
+        m_text += v.empty() ? "[]" : "]";
+    }
+
+    template <typename L>
+    void records(const char* k, const char*, const char*, const L& v)
+    {
+        key(k);
+        char s = '[';
+        for (const auto& x : v) {
+            m_text += s;
+            write_object(x);
+            s = ',';
+        }
+        m_text += v.empty() ? "[]" : "]";
+    }
+
+private:
+    template <typename R>
+    void write_object(const R& r)
+    {
+        m_text += '{';
+        m_first = true;
+        r.fields(*this);
+        m_text += '}';
+        m_first = false;
+    }
+
+    void key(const char* k);
+    void flush();
+
+private:
+    std::ostream& m_output;
+    std::string m_text;
+    bool m_lines;
+    bool m_empty;
+    bool m_first;
+};
+
+}
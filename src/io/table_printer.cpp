@@ -1,6 +1,5 @@
 #include "table_printer.h"
 
-#include <iomanip>
 #include <stdexcept>
 
 namespace io {
@@ -27,32 +26,39 @@ void table_printer::add_column(const std::string & header_name, int column_width
 
     m_column_headers.push_back(header_name);
     m_column_widths.push_back(column_width);
+    m_line.clear();
 }
 
 void table_printer::print_horizontal_line()
 {
-    *m_out_stream << "+";
-    for (unsigned j = 0; j < m_column_widths.size(); ++j) {
-        for (int i = 0; i < m_column_widths[j]; ++i) {
-            *m_out_stream << "-";
+    if (m_line.empty()) {
+        m_line += '+';
+        for (unsigned j = 0; j < m_column_widths.size(); ++j) {
+            m_line.append(m_column_widths[j], '-');
+            m_line += '+';
         }
-        *m_out_stream << "+";
+        m_line += '\n';
     }
-    *m_out_stream << "\n";
+    m_out_stream->write(m_line.data(), m_line.size());
 }
 
 void table_printer::print_header()
 {
     print_horizontal_line();
-    *m_out_stream << "|";
+    m_row += '|';
     for (int i=0; i < get_num_columns(); ++i) {
-        *m_out_stream << std::setw(m_column_widths.at(i)) <<
-            m_column_headers.at(i).substr(0, m_column_widths.at(i));
+        std::size_t w = m_column_widths.at(i);
+        const std::string& h = m_column_headers.at(i);
+        if (h.size() < w) {
+            m_row.append(w - h.size(), ' ');
+        }
+        m_row.append(h, 0, w);
         if (i != get_num_columns() - 1) {
-            *m_out_stream << m_separator;
+            m_row += m_separator;
         }
     }
-    *m_out_stream << "|\n";
+    m_row += "|\n";
+    write_row();
     print_horizontal_line();
 }
 
@@ -61,6 +67,35 @@ void table_printer::print_footer()
     print_horizontal_line();
 }
 
+void table_printer::put_cell()
+{
+    if (m_j == 0) {
+        m_row += '|';
+    }
+
+    std::size_t w = m_column_widths.at(m_j);
+    if (m_cell.size() < w) {
+        m_row.append(w - m_cell.size(), ' ');
+    }
+    m_row += m_cell;
+
+    if (m_j == get_num_columns() - 1) {
+        m_row += "|\n";
+        write_row();
+        m_i = m_i + 1;
+        m_j = 0;
+    } else {
+        m_row += m_separator;
+        m_j = m_j + 1;
+    }
+}
+
+void table_printer::write_row()
+{
+    m_out_stream->write(m_row.data(), m_row.size());
+    m_row.clear();
+}
+
 table_printer& table_printer::operator<<(float input)
 {
     output_decimal_number<float>(input);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "format.h"
+
 #include <cmath>
 #include <iomanip>
 #include <iostream>
@@ -12,6 +14,9 @@ namespace io {
 /**
  * @class table_printer.
  * @brief Console pretty table printer class.
+ *
+ *        Cells are formatted into the row buffer, the row is written to
+ *        the stream by one write when its last cell is added.
  */
 class table_printer
 {
@@ -51,29 +56,18 @@ public:
      * @param input Input to print to the stream.
      */
     template<typename T>
-    table_printer& operator<<(T input)
+    table_printer& operator<<(const T& input)
     {
-        if (m_j == 0) {
-            *m_out_stream << "|";
-        }
-
-        *m_out_stream << std::setw(m_column_widths.at(m_j))
-            << input;
-
-        if (m_j == get_num_columns()-1) {
-            *m_out_stream << "|\n";
-            m_i = m_i + 1;
-            m_j = 0;
-        } else {
-            *m_out_stream << m_separator;
-            m_j = m_j + 1;
-        }
-
+        m_cell.clear();
+        append_text(m_cell, input);
+        put_cell();
         return *this;
     }
 
 private:
     void print_horizontal_line();
+    void put_cell();
+    void write_row();
 
     template<typename T>
     void output_decimal_number(T input);
@@ -82,6 +76,9 @@ private:
     std::vector<std::string> m_column_headers;
     std::vector<int> m_column_widths;
     std::string m_separator;
+    std::string m_line;
+    std::string m_row;
+    std::string m_cell;
 
     int m_i;
     int m_j;
@@ -90,18 +87,14 @@ private:
 template<typename T>
 void table_printer::output_decimal_number(T input)
 {
-    if (input < 10 * (m_column_widths.at(m_j) - 1) || input > 10 * m_column_widths.at(m_j)) {
-        std::stringstream string_out;
-        string_out << std::setiosflags(std::ios::fixed)
-            << std::setprecision(m_column_widths.at(m_j))
-            << std::setw(m_column_widths.at(m_j))
-            << input;
-        std::string string_rep_of_number = string_out.str();
-        string_rep_of_number[m_column_widths.at(m_j) - 1] = '*';
-        std::string string_to_print = string_rep_of_number.substr(0, m_column_widths.at(m_j));
-        *m_out_stream << string_to_print;
+    int width = m_column_widths.at(m_j);
+    m_cell.clear();
+    if (input < 10 * (width - 1) || input > 10 * width) {
+        append_fixed(m_cell, input, width, width);
+        m_cell[width - 1] = '*';
+        m_cell.resize(width);
     } else {
-        int precision = m_column_widths.at(m_j) - 1; // leave room for the decimal point
+        int precision = width - 1; // leave room for the decimal point
         if (input < 0) {
             --precision;
         }
@@ -117,20 +110,9 @@ void table_printer::output_decimal_number(T input)
             precision = 0; // don't go negative with precision
         }
 
-        *m_out_stream << std::setiosflags(std::ios::fixed)
-            << std::setprecision(precision)
-            << std::setw(m_column_widths.at(m_j))
-            << input;
-    }
-
-    if (m_j == get_num_columns() - 1) {
-        *m_out_stream << "|\n";
-        m_i = m_i + 1;
-        m_j = 0;
-    } else {
-        *m_out_stream << m_separator;
-        m_j = m_j + 1;
+        append_fixed(m_cell, input, width, precision);
     }
+    put_cell();
 }
 
 }
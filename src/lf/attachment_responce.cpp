@@ -1,18 +1,18 @@
 #include "attachment_responce.h"
 
-#include <io/csv_stream.h>
+#include <io/record_writers.h>
 
 #include <cstdlib>
 #include <sstream>
 
 namespace lf {
 
-void attachment_responce::read(const nlohmann::json& j)
+void attachment_responce::read(const nlohmann::json& j, base::arena& a)
 {
-    filename_ = j["filename"].get<std::string>();
-    checksum_ = j["checksum"].get<std::string>();
-    crc32_ = j["crc32"].get<std::string>();
-    url_ = j["url"].get<std::string>();
+    filename_ = a.copy(j["filename"].get_ref<const std::string&>());
+    checksum_ = a.copy(j["checksum"].get_ref<const std::string&>());
+    crc32_ = a.copy(j["crc32"].get_ref<const std::string&>());
+    url_ = a.copy(j["url"].get_ref<const std::string&>());
     size_ = j["size"].get<int>();
 }
 
@@ -21,32 +21,26 @@ std::string attachment_responce::to_string(output_format f) const
     std::stringstream m;
     switch (f) {
     case output_format::table:
-        if (!filename_.empty()) {
-            m << "Filename: " << filename_ << "\n";
-        }
-        if (!content_type_.empty()) {
-            m << "Content Type: " << content_type_ << "\n";
-        }
-        if (!checksum_.empty()) {
-            m << "Checksum: " << checksum_ << "\n";
-        }
-        if (!crc32_.empty()) {
-            m << "CRC32: " << crc32_ << "\n";
-        }
-        if (!url_.empty()) {
-            m << "URL: " << url_ << "\n";
-        }
-        m << "Size: " << size_ << "\n";
+    {
+        io::text_writer w;
+        w.write(*this);
+        m << w.str();
         break;
+    }
     case output_format::csv:
     {
-        io::csv_ostream cp(&m);
-        cp << filename_ << content_type_ << checksum_ << crc32_ << url_ << size_;
+        io::csv_writer w(m);
+        w.write(*this);
+        break;
     }
-    default:
+    case output_format::json:
+    case output_format::ndjson:
+    {
+        io::json_writer w(m, true);
+        w.write(*this);
         break;
     }
-
+    }
     return m.str();
 }
 
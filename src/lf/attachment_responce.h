@@ -2,6 +2,7 @@
 
 #include "declarations.h"
 
+#include <base/arena.h>
 #include <io/json.h>
 
 #include <string>
@@ -18,8 +19,9 @@ public:
     /**
      * @brief Generates attachment_responce from json object.
      * @param j Json object
+     * @param a Arena to keep the strings in.
      */
-    void read(const nlohmann::json& j);
+    void read(const nlohmann::json& j, base::arena& a);
 
 public:
     /**
@@ -28,33 +30,45 @@ public:
      */
     std::string to_string(output_format f) const;
 
+    /// @brief Declares the fields of attachment.
+    template <typename W>
+    void fields(W& w) const
+    {
+        w.optional("filename", "Filename", 30, filename_);
+        w.optional("content_type", "Content Type", 20, content_type_);
+        w.optional("checksum", "Checksum", 64, checksum_);
+        w.optional("crc32", "CRC32", 8, crc32_);
+        w.optional("url", "URL", 60, url_);
+        w.field("size", "Size", 10, size_);
+    }
+
 public:
     /// @brief Access to filiename.
-    const std::string& filename() const
+    const base::string_ref& filename() const
     {
         return filename_;
     }
 
     /// @brief Access to content type.
-    const std::string& content_type() const
+    const base::string_ref& content_type() const
     {
         return content_type_;
     }
 
     /// @brief Access to checksum.
-    const std::string& checksum() const
+    const base::string_ref& checksum() const
     {
         return checksum_;
     }
 
     /// @brief Access to crc32.
-    const std::string& crc32() const
+    const base::string_ref& crc32() const
     {
         return crc32_;
     }
 
     /// @brief Access to url string.
-    const std::string& url() const
+    const base::string_ref& url() const
     {
         return url_;
     }
@@ -66,12 +80,12 @@ public:
     }
 
 private:
-    std::string filename_;
-    std::string content_type_;
-    std::string checksum_;
-    std::string crc32_;
-    std::string url_;
-    int size_;
+    base::string_ref filename_;
+    base::string_ref content_type_;
+    base::string_ref checksum_;
+    base::string_ref crc32_;
+    base::string_ref url_;
+    int size_ = 0;
 };
 
 }
@@ -0,0 +1,181 @@
+#include "console_event_sink.h"
+
+#include <io/output.h>
+
+#include <iomanip>
+
+namespace lf {
+
+console_event_sink::console_event_sink(io::output& m)
+    : m_output{m}
+    , m_progress_shown{false}
+{
+}
+
+void console_event_sink::transfer_started(transfer t, const std::string& name)
+{
+    end_progress();
+    switch (t) {
+    case transfer::upload:
+        m_output << "Uploading file '" << name << "'." << io::endl;
+        break;
+    case transfer::upload_chunk:
+        m_output << "Uploading chunk '" << name << "'." << io::endl;
+        break;
+    case transfer::download:
+        m_output << "Downloading file '" << name << "'" << io::endl;
+        break;
+    default:
+        break;
+    }
+    // Status lines are shown at once, even if output is not terminal.
+    m_output << io::flush;
+}
+
+void console_event_sink::transfer_progress(transfer, double now, double total)
+{
+    if (total <= 0) {
+        return;
+    }
+    int length = 80;
+    double fraction = now / total;
+    int dd = fraction * length;
+    m_output << std::fixed << std::setprecision(0);
+    m_output << std::setw(3) << fraction * 100 << "% [";
+    if (dd > 0) {
+        m_output << std::setw(dd) << std::setfill('=') << '=';
+    }
+    if (dd < length) {
+        m_output << std::setw(length - dd) << std::setfill(' ') << ' ';
+    }
+    m_output << "]\r";
+    m_output << io::flush;
+    m_progress_shown = true;
+}
+
+void console_event_sink::transfer_finished(transfer t, const std::string&,
+        const std::string& id)
+{
+    end_progress();
+    switch (t) {
+    case transfer::upload:
+        m_output << "File uploaded successfully. ID: " << id << io::endl;
+        break;
+    case transfer::upload_chunk:
+        if (id.empty()) {
+            m_output << "Current chunk uploaded successfully." << io::endl;
+        } else {
+            m_output << "All chunks of file uploaded successfully. ID: "
+                << id << io::endl;
+        }
+        break;
+    default:
+        break;
+    }
+    m_output << io::flush;
+}
+
+void console_event_sink::request_started(request r, const std::string& subject)
+{
+    end_progress();
+    switch (r) {
+    case request::send:
+        m_output << "Sending message to user '" << subject << "'" << io::endl;
+        break;
+    case request::filedrop:
+        m_output << "Sending message to filedrop" << io::endl;
+        break;
+    case request::file_request:
+        m_output << "Sending file request to user '" << subject << "'" << io::endl;
+        break;
+    case request::get_api_key:
+        m_output << "Getting API key for user '" << subject << "'" << io::endl;
+        break;
+    case request::get_filedrop_api_key:
+        m_output << "Getting filedrop API key" << io::endl;
+        break;
+    case request::create_filelink:
+        m_output << "Creating filelink" << io::endl;
+        break;
+    case request::delete_filelink:
+        m_output << "Deleting filelink with id '" << subject << "'" << io::endl;
+        break;
+    case request::list_filelinks:
+        m_output << "Getting filelinks from the server." << io::endl;
+        break;
+    case request::delete_attachment:
+        m_output << "Deleting attachment '" << subject << "'" << io::endl;
+        break;
+    case request::delete_message_attachments:
+        m_output << "Deleting attachments of the message." << io::endl;
+        break;
+    case request::get_message:
+        m_output << "Getting message from the server." << io::endl;
+        break;
+    case request::get_message_attachments:
+        m_output << "Retrieving attachments of message." << io::endl;
+        break;
+    case request::list_messages:
+        m_output << "Getting messages from the server." << io::endl;
+        break;
+    default:
+        break;
+    }
+    m_output << io::flush;
+}
+
+void console_event_sink::request_completed(request r, const std::string& result)
+{
+    end_progress();
+    switch (r) {
+    case request::send:
+        m_output << "Message sent successfully. ID: " << result << io::endl;
+        break;
+    case request::filedrop:
+    case request::get_api_key:
+        m_output << result << io::endl;
+        break;
+    case request::file_request:
+        m_output << "Request sent successfully. URL: " << result << io::endl;
+        break;
+    case request::get_filedrop_api_key:
+        m_output << "Got filedrop API key: " << result << io::endl;
+        break;
+    case request::create_filelink:
+        m_output << "Created filelink sucessfully. URL: " << result << io::endl;
+        break;
+    case request::delete_filelink:
+        m_output << "Filelink deleted successfully." << io::endl;
+        break;
+    case request::delete_attachment:
+        m_output << "Deleted successfully." << io::endl;
+        break;
+    case request::delete_message_attachments:
+        m_output << "Deleted attachments successfully." << io::endl;
+        break;
+    default:
+        break;
+    }
+    m_output << io::flush;
+}
+
+void console_event_sink::error(const base::exception&)
+{
+    // The error itself is reported by command processor.
+    end_progress();
+}
+
+bool console_event_sink::wants_progress() const
+{
+    return true;
+}
+
+void console_event_sink::end_progress()
+{
+    if (m_progress_shown) {
+        m_output << io::endl;
+        m_progress_shown = false;
+    }
+}
+
+}
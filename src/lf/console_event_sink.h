@@ -0,0 +1,41 @@
+#pragma once
+
+#include "event_sink.h"
+
+namespace io {
+class output;
+}
+
+namespace lf {
+
+/**
+ * @class console_event_sink
+ * @brief Event sink which prints human readable status messages and
+ *        progress bar to the given output.
+ */
+class console_event_sink final : public event_sink
+{
+public:
+    /// @brief Constructor.
+    /// @param m Output to write messages.
+    console_event_sink(io::output& m);
+
+public:
+    void transfer_started(transfer t, const std::string& name) override;
+    void transfer_progress(transfer t, double now, double total) override;
+    void transfer_finished(transfer t, const std::string& name,
+            const std::string& id) override;
+    void request_started(request r, const std::string& subject) override;
+    void request_completed(request r, const std::string& result) override;
+    void error(const base::exception& e) override;
+    bool wants_progress() const override;
+
+private:
+    void end_progress();
+
+private:
+    io::output& m_output;
+    bool m_progress_shown;
+};
+
+}
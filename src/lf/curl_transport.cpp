@@ -0,0 +1,373 @@
+#include "curl_transport.h"
+#include "dns_cache.h"
+#include "exceptions.h"
+
+#include <base/lf_string.h>
+#include <base/trace.h>
+
+#include <exception>
+#include <mutex>
+
+namespace lf {
+
+namespace {
+
+struct exchange
+{
+    responce_handler* handler;
+    std::exception_ptr error;
+};
+
+size_t write_function(char* ptr, size_t size, size_t nmemb, void* data)
+{
+    exchange* e = static_cast<exchange*>(data);
+    try {
+        e->handler->data(ptr, size * nmemb);
+    } catch (...) {
+        // Exceptions must not pass through curl, returning less than given
+        // aborts the transfer.
+        e->error = std::current_exception();
+        return 0;
+    }
+    return size * nmemb;
+}
+
+int progress_function(void* data, curl_off_t td, curl_off_t nd, curl_off_t tu, curl_off_t nu)
+{
+    exchange* e = static_cast<exchange*>(data);
+    if (td > 0) {
+        e->handler->progress(nd, td);
+    } else if (tu > 0) {
+        e->handler->progress(nu, tu);
+    }
+    return 0;
+}
+
+class slist_guard
+{
+public:
+    slist_guard(const std::vector<std::string>& s)
+        : m_slist{nullptr}
+    {
+        for (const auto& i : s) {
+            m_slist = curl_slist_append(m_slist, i.c_str());
+        }
+    }
+
+    ~slist_guard()
+    {
+        curl_slist_free_all(m_slist);
+    }
+
+    curl_slist* get() const
+    {
+        return m_slist;
+    }
+
+private:
+    curl_slist* m_slist;
+};
+
+class form_guard
+{
+public:
+    form_guard(const std::vector<form_field>& f)
+        : m_formpost{nullptr}
+    {
+        curl_httppost* lastptr = nullptr;
+        for (const auto& i : f) {
+            curl_formadd(&m_formpost,
+                    &lastptr,
+                    CURLFORM_COPYNAME, i.name.c_str(),
+                    i.is_file ? CURLFORM_FILE : CURLFORM_COPYCONTENTS, i.value.c_str(),
+                    CURLFORM_END);
+        }
+    }
+
+    ~form_guard()
+    {
+        curl_formfree(m_formpost);
+    }
+
+    curl_httppost* get() const
+    {
+        return m_formpost;
+    }
+
+private:
+    curl_httppost* m_formpost;
+};
+
+/// @brief Handler ignoring the body of responce.
+class discard_handler final : public responce_handler
+{
+public:
+    void data(const char*, std::size_t) override
+    {
+    }
+};
+
+/// @brief Returns the time of given phase of transfer in microseconds.
+std::int64_t phase_time(CURL* c, CURLINFO i)
+{
+    double t = 0;
+    curl_easy_getinfo(c, i, &t);
+    return static_cast<std::int64_t>(t * 1000000);
+}
+
+void record_phase(const char* n, std::int64_t start, std::int64_t from, std::int64_t to)
+{
+    if (to > from) {
+        base::trace::record("http", n, start + from, to - from);
+    }
+}
+
+/**
+ * @brief Records the phases of transfer which the engine can't see:
+ *        name lookup, connection, TLS handshake and waiting for the first
+ *        byte of responce. Phases are skipped for reused connections.
+ */
+void trace_phases(CURL* c, std::int64_t start)
+{
+    std::int64_t dns = phase_time(c, CURLINFO_NAMELOOKUP_TIME);
+    std::int64_t connect = phase_time(c, CURLINFO_CONNECT_TIME);
+    std::int64_t tls = phase_time(c, CURLINFO_APPCONNECT_TIME);
+    std::int64_t pretransfer = phase_time(c, CURLINFO_PRETRANSFER_TIME);
+    std::int64_t first_byte = phase_time(c, CURLINFO_STARTTRANSFER_TIME);
+    if (connect > 0) {
+        record_phase("dns", start, 0, dns);
+        record_phase("connect", start, dns, connect);
+        record_phase("tls", start, connect, tls);
+    }
+    record_phase("wait", start, pretransfer, first_byte);
+}
+
+/**
+ * @brief Gets the host and port of URL.
+ * @return false if host is an address, it needs no resolving.
+ */
+bool parse_host(const std::string& url, std::string& host, int& port)
+{
+    std::size_t b = url.find("://");
+    if (b == std::string::npos) {
+        return false;
+    }
+    std::string scheme = url.substr(0, b);
+    b += 3;
+    std::size_t e = url.find_first_of("/?#", b);
+    if (e == std::string::npos) {
+        e = url.size();
+    }
+    std::size_t u = url.rfind('@', e);
+    if (u != std::string::npos && u >= b) {
+        b = u + 1;
+    }
+    if (b == e || url[b] == '[') {
+        return false;
+    }
+    std::size_t c = url.find(':', b);
+    if (c != std::string::npos && c < e) {
+        if (c + 1 == e || base::parse_integer(url.data() + c + 1, url.data() + e, port) != url.data() + e) {
+            return false;
+        }
+    } else if (scheme == "https") {
+        c = e;
+        port = 443;
+    } else if (scheme == "http") {
+        c = e;
+        port = 80;
+    } else {
+        return false;
+    }
+    host = url.substr(b, c - b);
+    return host.find_first_not_of("0123456789.") != std::string::npos;
+}
+
+/// @brief Returns the entry of CURLOPT_RESOLVE for given address.
+std::string resolve_entry(const std::string& host, int port, const std::string& a)
+{
+    std::string r = host + ":" + std::to_string(port) + ":";
+    if (a.find(':') != std::string::npos) {
+        return r + "[" + a + "]";
+    }
+    return r + a;
+}
+
+/**
+ * @brief Checks whether the failure of request can be caused by the cached
+ *        address of server being used by another host, or by no one.
+ *
+ *        Timeouts are counted only if nothing of request is sent yet.
+ */
+bool stale_address(CURL* c, CURLcode e)
+{
+    switch (e) {
+    case CURLE_COULDNT_CONNECT:
+    case CURLE_SSL_CONNECT_ERROR:
+    case CURLE_PEER_FAILED_VERIFICATION:
+        return true;
+    case CURLE_OPERATION_TIMEDOUT:
+    {
+        long n = 0;
+        return curl_easy_getinfo(c, CURLINFO_REQUEST_SIZE, &n) == CURLE_OK && n == 0;
+    }
+    default:
+        return false;
+    }
+}
+
+std::once_flag s_global_init;
+
+}
+
+curl_transport::curl_transport(dns_cache* c)
+    : m_curl{nullptr}
+    , m_dns_cache{c}
+{
+}
+
+curl_transport::~curl_transport()
+{
+    if (m_preconnect.joinable()) {
+        m_preconnect.join();
+    }
+    if (m_curl != nullptr) {
+        curl_easy_cleanup(m_curl);
+        m_curl = nullptr;
+    }
+}
+
+void curl_transport::perform(const http_request& r, responce_handler& h)
+{
+    if (m_preconnect.joinable()) {
+        base::trace_span t("http", "wait_preconnect");
+        m_preconnect.join();
+    }
+    perform_request(r, h);
+}
+
+void curl_transport::preconnect(const http_request& r)
+{
+    if (m_preconnect.joinable()) {
+        return;
+    }
+    // The handle is used by thread until perform joins it, connection
+    // stays in the handle for the following requests.
+    m_preconnect = std::thread([this, r] {
+        base::trace_span t("http", "preconnect");
+        discard_handler h;
+        try {
+            perform_request(r, h);
+        } catch (...) {
+        }
+    });
+}
+
+void curl_transport::perform_request(const http_request& r, responce_handler& h)
+{
+    if (m_curl == nullptr) {
+        // Global initialization is done by the first request, so commands
+        // which make no requests don't pay for it. It is not thread safe in
+        // older versions of curl, call_once makes it safe for transports
+        // used by several threads.
+        std::call_once(s_global_init, [] {
+            curl_global_init(CURL_GLOBAL_ALL);
+        });
+        m_curl = curl_easy_init();
+        if (m_curl == nullptr) {
+            throw curl_error("Failed to initialize CURL");
+        }
+    } else {
+        // Reset keeps the connections and caches of handle.
+        curl_easy_reset(m_curl);
+    }
+    std::string host;
+    int port = 0;
+    std::string address;
+    // Without validation of certificate another host on the cached address
+    // can't be told from the server, so the name is always resolved.
+    bool named = m_dns_cache != nullptr && r.validate != validate_cert::not_validate &&
+        parse_host(r.url, host, port);
+    bool cached = named && m_dns_cache->find(host, port, address);
+    CURLcode res = perform_once(r, h, cached ? resolve_entry(host, port, address) : "");
+    if (cached && stale_address(m_curl, res)) {
+        // Server moved, nothing is sent yet, so the request is repeated
+        // with the name resolved, after removing the address from the
+        // caches of file and handle.
+        m_dns_cache->remove(host, port);
+        curl_easy_reset(m_curl);
+        res = perform_once(r, h, "-" + host + ":" + std::to_string(port));
+    }
+    if (res != CURLE_OK) {
+        throw curl_error(std::string(curl_easy_strerror(res)));
+    }
+    long connects = 0;
+    char* ip = nullptr;
+    if (named &&
+            curl_easy_getinfo(m_curl, CURLINFO_NUM_CONNECTS, &connects) == CURLE_OK && connects > 0 &&
+            curl_easy_getinfo(m_curl, CURLINFO_PRIMARY_IP, &ip) == CURLE_OK && ip != nullptr) {
+        m_dns_cache->store(host, port, ip);
+    }
+}
+
+CURLcode curl_transport::perform_once(const http_request& r, responce_handler& h,
+        const std::string& resolve)
+{
+    exchange e{&h, nullptr};
+    curl_easy_setopt(m_curl, CURLOPT_URL, r.url.c_str());
+    curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, &write_function);
+    curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, &e);
+    std::string credentials;
+    if (!r.user.empty()) {
+        credentials = r.user + ":" + r.password;
+        curl_easy_setopt(m_curl, CURLOPT_USERPWD, credentials.c_str());
+    }
+    if (r.validate == validate_cert::not_validate) {
+        curl_easy_setopt(m_curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    }
+    if (r.verbose) {
+        curl_easy_setopt(m_curl, CURLOPT_VERBOSE, 1L);
+    }
+    if (h.wants_progress()) {
+        curl_easy_setopt(m_curl, CURLOPT_XFERINFOFUNCTION, &progress_function);
+        curl_easy_setopt(m_curl, CURLOPT_XFERINFODATA, &e);
+        curl_easy_setopt(m_curl, CURLOPT_NOPROGRESS, 0L);
+    }
+    slist_guard hg(r.headers);
+    curl_easy_setopt(m_curl, CURLOPT_HTTPHEADER, hg.get());
+    form_guard fg(r.form);
+    slist_guard rg(resolve.empty() ? std::vector<std::string>() : std::vector<std::string>{resolve});
+    if (rg.get() != nullptr) {
+        curl_easy_setopt(m_curl, CURLOPT_RESOLVE, rg.get());
+    }
+    switch (r.method) {
+    case http_method::post:
+        if (fg.get() != nullptr) {
+            curl_easy_setopt(m_curl, CURLOPT_HTTPPOST, fg.get());
+        } else {
+            curl_easy_setopt(m_curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(r.body.size()));
+            curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, r.body.c_str());
+        }
+        break;
+    case http_method::delete_:
+        curl_easy_setopt(m_curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+        break;
+    case http_method::head:
+        curl_easy_setopt(m_curl, CURLOPT_NOBODY, 1L);
+        break;
+    case http_method::get:
+    default:
+        break;
+    }
+    std::int64_t start = base::trace::enabled() ? base::trace::now() : -1;
+    CURLcode res = curl_easy_perform(m_curl);
+    if (start >= 0) {
+        trace_phases(m_curl, start);
+    }
+    if (e.error) {
+        std::rethrow_exception(e.error);
+    }
+    return res;
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "transport.h"
+
+#include <curl/curl.h>
+
+#include <string>
+#include <thread>
+
+namespace lf {
+
+class dns_cache;
+
+/**
+ * @class curl_transport
+ * @brief Transport performing requests one by one with curl easy handle.
+ *
+ *        The handle is kept between requests, so connections to the
+ *        server are reused. With dns_cache the first connection of process
+ *        goes to the address resolved by previous processes.
+ */
+class curl_transport final : public transport
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param c Cache of server addresses, must outlive transport. Names are
+     *        always resolved if it is null.
+     */
+    curl_transport(dns_cache* c = nullptr);
+
+    /// @brief Destructor.
+    ~curl_transport();
+
+    curl_transport(const curl_transport&) = delete;
+    curl_transport& operator=(const curl_transport&) = delete;
+
+public:
+    /// @brief Performs the request.
+    void perform(const http_request& r, responce_handler& h) override;
+
+    /// @brief Performs the request in thread, perform waits for it.
+    void preconnect(const http_request& r) override;
+
+private:
+    /// @brief Performs the request, handle must not be used by other thread.
+    void perform_request(const http_request& r, responce_handler& h);
+
+    /**
+     * @brief Sets the options of request and performs it.
+     * @param resolve Entry of CURLOPT_RESOLVE, none if empty.
+     */
+    CURLcode perform_once(const http_request& r, responce_handler& h,
+            const std::string& resolve);
+
+private:
+    CURL* m_curl;
+    dns_cache* m_dns_cache;
+    std::thread m_preconnect;
+};
+
+}
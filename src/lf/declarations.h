@@ -21,9 +21,16 @@ inline std::ostream& operator<<(std::ostream& s, validate_cert v)
     return s;
 }
 
+enum class cache_use {
+    cached,
+    refresh
+};
+
 enum class output_format {
     table,
-    csv
+    csv,
+    json,
+    ndjson
 };
 
 }
@@ -0,0 +1,123 @@
+#include "dns_cache.h"
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lf {
+
+namespace {
+
+std::string make_key(const std::string& h, int p)
+{
+    return h + ":" + std::to_string(p);
+}
+
+std::int64_t now()
+{
+    return static_cast<std::int64_t>(std::time(nullptr));
+}
+
+}
+
+dns_cache::dns_cache(const std::string& f, std::int64_t ttl)
+    : m_file{f}
+    , m_ttl{ttl}
+    , m_loaded{false}
+{
+}
+
+bool dns_cache::find(const std::string& h, int p, std::string& a)
+{
+    std::lock_guard<std::mutex> l(m_mutex);
+    load();
+    auto i = m_entries.find(make_key(h, p));
+    if (i == m_entries.end() || i->second.expires <= now()) {
+        return false;
+    }
+    a = i->second.address;
+    return true;
+}
+
+void dns_cache::store(const std::string& h, int p, const std::string& a)
+{
+    std::lock_guard<std::mutex> l(m_mutex);
+    load();
+    std::int64_t t = now();
+    entry& e = m_entries[make_key(h, p)];
+    // Connections to the cached address don't extend its life, otherwise
+    // the name would never be resolved again.
+    if (e.address == a && e.expires > t) {
+        return;
+    }
+    e.address = a;
+    e.expires = t + m_ttl;
+    save();
+}
+
+void dns_cache::remove(const std::string& h, int p)
+{
+    std::lock_guard<std::mutex> l(m_mutex);
+    load();
+    if (m_entries.erase(make_key(h, p)) != 0) {
+        save();
+    }
+}
+
+void dns_cache::load()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+    if (m_file.empty()) {
+        return;
+    }
+    std::ifstream f(m_file.c_str());
+    int version = 0;
+    f >> version;
+    if (version != m_serial_version) {
+        return;
+    }
+    std::string k;
+    entry e;
+    std::int64_t t = now();
+    while (f >> k >> e.address >> e.expires) {
+        if (e.expires > t) {
+            m_entries[k] = e;
+        }
+    }
+}
+
+void dns_cache::save()
+{
+    if (m_file.empty()) {
+        return;
+    }
+    // Concurrent invocations may save at the same time, rename replaces
+    // the file atomically, so it is never read half written.
+    std::string tmp = m_file + "." + std::to_string(getpid());
+    {
+        std::ofstream f(tmp.c_str());
+        std::size_t d = m_file.rfind('/');
+        if (!f && d != std::string::npos) {
+            mkdir(m_file.substr(0, d).c_str(), S_IRWXU);
+            f.open(tmp.c_str());
+        }
+        f << m_serial_version << std::endl;
+        for (const auto& i : m_entries) {
+            f << i.first << ' ' << i.second.address << ' ' << i.second.expires << '\n';
+        }
+        if (!f) {
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp.c_str(), m_file.c_str()) != 0) {
+        std::remove(tmp.c_str());
+    }
+}
+
+}
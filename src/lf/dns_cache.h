@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace lf {
+
+/**
+ * @class dns_cache
+ * @brief Addresses of servers resolved by previous invocations, kept in
+ *        file.
+ *
+ *        Each run of utility is a new process, so it would resolve the
+ *        server name again before every first request. curl_transport
+ *        connects to the cached address instead, while it is not expired,
+ *        and stores the address of each new connection.
+ *
+ *        The file is read on first lookup and rewritten on each change,
+ *        it is small and changes once per expiry period.
+ */
+class dns_cache final
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param f Path of file, cache is not kept if empty.
+     * @param ttl Time in seconds the addresses are used.
+     */
+    dns_cache(const std::string& f, std::int64_t ttl = s_default_ttl);
+
+    dns_cache(const dns_cache&) = delete;
+    dns_cache& operator=(const dns_cache&) = delete;
+
+public:
+    /**
+     * @brief Finds not expired address of host.
+     * @param h Host name.
+     * @param p Port.
+     * @param[out] a Address.
+     * @return false if there is no such address.
+     */
+    bool find(const std::string& h, int p, std::string& a);
+
+    /// @brief Stores the address of host, which expires after ttl.
+    void store(const std::string& h, int p, const std::string& a);
+
+    /// @brief Removes the address of host, e.g. if it can't be connected.
+    void remove(const std::string& h, int p);
+
+public:
+    /// @brief Default time of using the address, curl does not report
+    ///        the TTL of DNS records.
+    static const std::int64_t s_default_ttl = 600;
+
+    static const int m_serial_version = 1;
+
+private:
+    struct entry
+    {
+        std::string address;
+        std::int64_t expires;
+    };
+
+    void load();
+    void save();
+
+private:
+    std::string m_file;
+    std::int64_t m_ttl;
+    std::mutex m_mutex;
+    bool m_loaded;
+    std::map<std::string, entry> m_entries;
+};
+
+}
@@ -1,18 +1,28 @@
 #include "engine.h"
 #include "attachment_responce.h"
+#include "curl_transport.h"
 #include "exceptions.h"
 #include "filelinks_responce.h"
 #include "messages_responce.h"
 #include "message_responce.h"
+#include "record_writer.h"
 
 #include <base/lf_string.h>
-#include <io/messenger.h>
+#include <base/mapped_file.h>
+#include <base/trace.h>
+#include <io/output.h>
+#include <io/exceptions.h>
 #include <io/json.h>
+#include <io/json_extractor.h>
+#include <io/json_reader.h>
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
-#include <iomanip>
+#include <ctime>
+#include <sstream>
+#include <unordered_map>
 #include <vector>
 
 #include <errno.h>
@@ -23,203 +33,249 @@ namespace {
 
 constexpr unsigned s_normal_id_size = 22;
 
-std::string s_data;
+const char* const s_json_header = "Content-Type: application/json";
 
-size_t data_get(void* ptr, size_t size, size_t nmemb, FILE* stream)
-{
-    if (stream != nullptr) {
-        fwrite(ptr, size, nmemb, stream);
-    } else {
-        s_data += std::string(static_cast<char*>(ptr), nmemb);
-    }
+/// @brief Seconds before the last synchronization, whose messages are read
+///        again: sent_after has the granularity of day, and the clocks of
+///        server and client differ.
+constexpr std::int64_t s_sync_overlap = 24 * 60 * 60;
 
-    return size * nmemb;
-}
+/// @brief Seconds the cached filelinks are used. Filelinks have no
+///        creation time to read only the new ones.
+constexpr std::int64_t s_links_ttl = 600;
+
+/// @brief Seconds the cached messages are used with no synchronization.
+///        Messages sent by this utility mark them out of date at once.
+constexpr std::int64_t s_messages_ttl = 600;
 
-int progress_function(void* ptr, double td, double nd, double tu, double nu)
+/// @brief Name of the cached columns of messages, built from the listing.
+const char* const s_message_columns = "messages.columns";
+
+/// @brief Size of the blocks of cached listing fed to handlers.
+constexpr std::size_t s_replay_block = 64 * 1024;
+
+std::int64_t now()
 {
-    int length = 80;
-    double fraction = .0;
+    return static_cast<std::int64_t>(std::time(nullptr));
+}
 
-    if (td > 0.0) {
-        fraction = nd / td;
-    } else if (tu > 0) {
-        fraction = nu / tu;
-    } else {
-        return 0;
-    }
-    int dd = fraction * length;
-    io::mout << std::fixed << std::setprecision(0);
-    io::mout << std::setw(3) << fraction * 100 << "% [";
-    if (dd > 0) {
-        io::mout << std::setw(dd) << std::setfill('=') << '=';
-    }
-    if (dd < length) {
-        io::mout << std::setw(length - dd) << std::setfill(' ') << ' ';
+const char* method_name(http_method m)
+{
+    switch (m) {
+    case http_method::post:
+        return "POST";
+    case http_method::delete_:
+        return "DELETE";
+    case http_method::head:
+        return "HEAD";
+    case http_method::get:
+    default:
+        return "GET";
     }
-    io::mout << "]\r";
-    io::mout << io::flush;
-    return 0;
 }
 
-class curl_header_guard
+null_event_sink s_null_events;
+
+/**
+ * @class progress_handler
+ * @brief Base of responce handlers reporting the progress of transfer.
+ */
+class progress_handler : public responce_handler
 {
 public:
-    curl_header_guard(CURL* c)
-        : m_slist{nullptr}
+    progress_handler(event_sink& e, transfer t)
+        : m_events{e}
+        , m_kind{t}
     {
-        m_slist = curl_slist_append(m_slist, "Content-Type: application/json");
-        curl_easy_setopt(c, CURLOPT_HTTPHEADER, m_slist);
     }
 
-    ~curl_header_guard()
+    void progress(double now, double total) override
     {
-        curl_slist_free_all(m_slist);
+        m_events.transfer_progress(m_kind, now, total);
+    }
+
+    bool wants_progress() const override
+    {
+        return m_events.wants_progress();
     }
 
 private:
-    curl_slist* m_slist;
+    event_sink& m_events;
+    transfer m_kind;
 };
 
-class curl_form_guard
+/**
+ * @class string_handler
+ * @brief Collects the whole responce.
+ */
+class string_handler final : public progress_handler
 {
 public:
-    curl_form_guard(curl_httppost* f)
-        : m_formpost{f}
+    string_handler(event_sink& e, transfer t)
+        : progress_handler{e, t}
+    {
+    }
+
+    void data(const char* d, std::size_t n) override
     {
+        m_data.append(d, n);
     }
 
-    ~curl_form_guard()
+    std::string& str()
     {
-        curl_formfree(m_formpost);
+        return m_data;
     }
 
 private:
-    curl_httppost* m_formpost;
+    std::string m_data;
 };
 
-class progress_guard
+/**
+ * @class json_stream_handler
+ * @brief Feeds the responce to json reader while it arrives.
+ */
+class json_stream_handler final : public responce_handler
 {
 public:
-    progress_guard(CURL* c, report_level s)
-        : m_curl{c}
-        , m_report_level{s}
+    json_stream_handler(io::json_handler& h)
+        : m_reader{h}
     {
-        if (m_report_level >= report_level::normal) {
-            curl_easy_setopt(m_curl, CURLOPT_PROGRESSFUNCTION, &progress_function);
-            curl_easy_setopt(m_curl, CURLOPT_NOPROGRESS, false);
-        }
     }
 
-    void end()
+    void data(const char* d, std::size_t n) override
     {
-        if (m_report_level >= report_level::normal) {
-            io::mout << io::endl;
-            curl_easy_setopt(m_curl, CURLOPT_PROGRESSFUNCTION, 0);
-            curl_easy_setopt(m_curl, CURLOPT_NOPROGRESS, true);
-        }
+        m_reader.feed(d, n);
     }
 
-    ~progress_guard()
+    void finish()
     {
+        m_reader.finish();
     }
 
 private:
-    CURL* m_curl;
-    report_level m_report_level;
+    io::json_reader m_reader;
 };
 
-class curl_file_guard
+/**
+ * @class file_handler
+ * @brief Writes the responce to file, closes the file at the end.
+ */
+class file_handler final : public progress_handler
 {
 public:
-    curl_file_guard(CURL* c, FILE* f, report_level s)
-        : m_curl{c}
+    file_handler(FILE* f, const std::string& name, event_sink& e)
+        : progress_handler{e, transfer::download}
         , m_file{f}
-        , m_progress{c, s}
+        , m_name{name}
     {
-        curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, m_file);
     }
 
-    ~curl_file_guard()
+    ~file_handler()
     {
         fclose(m_file);
-        curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, 0);
-        m_progress.end();
+    }
+
+    void data(const char* d, std::size_t n) override
+    {
+        if (fwrite(d, 1, n, m_file) != n) {
+            throw file_error(m_name, strerror(errno));
+        }
     }
 
 private:
-    CURL* m_curl;
     FILE* m_file;
-    progress_guard m_progress;
+    const std::string& m_name;
 };
 
 }
 
-void engine::init_curl(std::string key, report_level s, validate_cert v)
+void engine::init_session(const std::string& key, report_level s, validate_cert v)
 {
-    if (m_curl != nullptr) {
-        curl_easy_cleanup(m_curl);
-    }
-    m_curl = curl_easy_init();
-    if (m_curl == nullptr) {
-        throw curl_error("Failed to initialize CURL");
-    }
-    curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, &data_get);
-    curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, 0);
-    if (!key.empty()) {
-        key += ":x";
-        curl_easy_setopt(m_curl, CURLOPT_USERPWD, key.c_str());
-    }
-    if (v == validate_cert::not_validate) {
-        curl_easy_setopt(m_curl, CURLOPT_SSL_VERIFYPEER, false);
-    }
-    if (s == report_level::verbose) {
-        curl_easy_setopt(m_curl, CURLOPT_VERBOSE, 1L);
-    }
+    m_key = key;
+    m_validate = v;
+    m_verbose = s == report_level::verbose;
+}
+
+http_request engine::make_request(http_method m, const std::string& url) const
+{
+    http_request r;
+    r.method = m;
+    r.url = url;
+    r.user = m_key;
+    r.password = "x";
+    r.validate = m_validate;
+    r.verbose = m_verbose;
+    r.headers.push_back(s_json_header);
+    return r;
 }
 
-engine::engine()
-    : m_curl{nullptr}
+engine::engine(event_sink& e, dns_cache* c, metadata_cache* m)
+    : m_default_transport{new curl_transport(c)}
+    , m_transport{*m_default_transport}
+    , m_events{e}
+    , m_metadata{m}
+    , m_validate{validate_cert::validate}
+    , m_verbose{false}
+{
+}
+
+engine::engine(event_sink& e, transport& t)
+    : m_transport{t}
+    , m_events{e}
+    , m_metadata{nullptr}
+    , m_validate{validate_cert::validate}
+    , m_verbose{false}
 {
 }
 
 engine::~engine()
 {
-    if (m_curl != nullptr) {
-        curl_easy_cleanup(m_curl);
-        m_curl = nullptr;
-    }
 }
 
 std::string engine::send(std::string server,
         const std::string& key,
-        const std::string& user,
+        const recipients& to,
         const std::string& subject,
         const std::string& message,
         const strings& fs,
         report_level s,
         validate_cert v)
 {
-    init_curl(key, s, v);
+    set_file_list l(fs);
+    return send(server, key, to, subject, message, l, s, v);
+}
+
+std::string engine::send(std::string server,
+        const std::string& key,
+        const recipients& to,
+        const std::string& subject,
+        const std::string& message,
+        file_list& fs,
+        report_level s,
+        validate_cert v)
+{
+    base::trace_span t("engine", "send");
+    init_session(key, s, v);
     std::set<std::string> attachments;
-    for (const auto& f : fs) {
-        std::string a = attach_impl(server, f, s);
-        attachments.insert(a);
+    std::string f;
+    while (fs.next(f)) {
+        attachments.insert(attach_impl(server, f, s));
     }
-    return send_attachments_impl(server, user, subject, message, attachments, s);
+    return send_attachments_impl(server, key, to, subject, message, attachments, s);
 }
 
 std::string engine::send_attachments(std::string server,
             const std::string& key,
-            const std::string& user,
+            const recipients& to,
             const std::string& subject,
             const std::string& message,
             const strings& fs,
             report_level s,
             validate_cert v)
 {
-    init_curl(key, s, v);
-    return send_attachments_impl(server, user, subject, message, fs, s);
+    base::trace_span t("engine", "send_attachments");
+    init_session(key, s, v);
+    return send_attachments_impl(server, key, to, subject, message, fs, s);
 }
 
 void engine::attach(std::string server,
@@ -228,12 +284,34 @@ void engine::attach(std::string server,
         report_level s,
         validate_cert v)
 {
-    init_curl(key, s, v);
-    for (const auto& f : fs) {
+    set_file_list l(fs);
+    attach(server, key, l, s, v);
+}
+
+void engine::attach(std::string server,
+        const std::string& key,
+        file_list& fs,
+        report_level s,
+        validate_cert v)
+{
+    base::trace_span t("engine", "attach");
+    init_session(key, s, v);
+    std::string f;
+    while (fs.next(f)) {
         attach_impl(server, f, s);
     }
 }
 
+std::string engine::upload(std::string server,
+        const std::string& key,
+        const std::string& file,
+        report_level s,
+        validate_cert v)
+{
+    init_session(key, s, v);
+    return attach_impl(server, file, s);
+}
+
 void engine::attach(std::string server,
         const std::string& key,
         const std::string& file,
@@ -243,40 +321,17 @@ void engine::attach(std::string server,
         report_level s,
         validate_cert v)
 {
-    init_curl(key, s, v);
-    server += "/attachments";
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_httppost* formpost = nullptr;
-    curl_httppost* lastptr = nullptr;
-    curl_formadd(&formpost,
-            &lastptr,
-            CURLFORM_COPYNAME, "Filedata",
-            CURLFORM_FILE, file.c_str(),
-            CURLFORM_END);
-    curl_formadd(&formpost,
-            &lastptr,
-            CURLFORM_COPYNAME, "name",
-            CURLFORM_COPYCONTENTS, filename.c_str(),
-            CURLFORM_END);
-    curl_formadd(&formpost,
-            &lastptr,
-            CURLFORM_COPYNAME, "chunk",
-            CURLFORM_COPYCONTENTS, base::to_string(chunk_id).c_str(),
-            CURLFORM_END);
-    curl_formadd(&formpost,
-            &lastptr,
-            CURLFORM_COPYNAME, "chunks",
-            CURLFORM_COPYCONTENTS, base::to_string(num_chunks).c_str(),
-            CURLFORM_END);
-    curl_form_guard fg(formpost);
-    progress_guard pg(m_curl, s);
-    curl_easy_setopt(m_curl, CURLOPT_HTTPPOST, formpost);
-    if (s >= report_level::normal) {
-        io::mout << "Uploading chunk '" << file << "'." << io::endl;
-    }
-    std::string r = perform();
-    pg.end();
-    process_attach_chunk_responce(r, s);
+    base::trace_span t("engine", "attach_chunk");
+    init_session(key, s, v);
+    http_request q = make_request(http_method::post, server + "/attachments");
+    q.headers.clear();
+    q.form.push_back(form_field{"Filedata", file, true});
+    q.form.push_back(form_field{"name", filename, false});
+    q.form.push_back(form_field{"chunk", base::to_string(chunk_id), false});
+    q.form.push_back(form_field{"chunks", base::to_string(num_chunks), false});
+    events(s).transfer_started(transfer::upload_chunk, file);
+    std::string r = perform(q, transfer::upload_chunk, s);
+    process_attach_chunk_responce(file, r, s);
 }
 
 void engine::messages(std::string server,
@@ -285,10 +340,29 @@ void engine::messages(std::string server,
         const std::string& f,
         output_format of,
         report_level s,
+        validate_cert v,
+        cache_use c)
+{
+    // Rows are written while the responce arrives.
+    if (of == output_format::json || of == output_format::ndjson) {
+        listing_passthrough p("messages", io::mout, of);
+        cached_messages(server, key, l, f, p, s, v, c);
+        return;
+    }
+    messages_responce::printer p(io::mout, of);
+    cached_messages(server, key, l, f, p, s, v, c);
+}
+
+void engine::messages(std::string server,
+        const std::string& key,
+        const std::string& l,
+        const std::string& f,
+        messages_responce& m,
+        report_level s,
         validate_cert v)
 {
-    std::string r = messages_impl(server, key, l, f, s, v);
-    process_output_responce<messages_responce>(r, s, of);
+    messages_responce::decoder d(m);
+    messages_impl(server, key, l, f, d, s, v);
 }
 
 void engine::message(std::string server,
@@ -296,25 +370,105 @@ void engine::message(std::string server,
         const std::string& id,
         output_format f,
         report_level s,
-        validate_cert v)
+        validate_cert v,
+        cache_use c)
 {
-    std::string r = message_impl(server, key, id, s, v, "Getting message from the server.");
+    base::trace_span t("engine", "message");
+    // Messages don't change once sent, so they are read from server once.
+    std::string r;
+    bool cached = m_metadata != nullptr && c == cache_use::cached
+        && m_metadata->find_message(server, key, id, r);
+    t.arg("cached", cached ? "1" : "0");
+    if (!cached) {
+        r = message_impl(server, key, id, s, v, request::get_message);
+    }
+    // Only the responce is checked here, errors of output are reported as
+    // they are.
+    std::string o;
     try {
-        process_output_responce<message_responce>(r, s, f);
+        if (f == output_format::json || f == output_format::ndjson) {
+            auto j = nlohmann::json::parse(r);
+            o = j.at("message").dump() + '\n';
+        } else {
+            o = process_output_responce<message_responce>(r, f);
+        }
     } catch (...) {
-        throw invalid_message_id(id);
+        fail(s, invalid_message_id(id));
+    }
+    io::mout << o;
+    if (!cached && m_metadata != nullptr) {
+        m_metadata->store_message(server, key, id, r);
     }
 }
 
+void engine::query(std::string server,
+        const std::string& key,
+        const message_filter& f,
+        query_group g,
+        output_format of,
+        report_level s,
+        validate_cert v,
+        cache_use c)
+{
+    base::trace_span t("engine", "query");
+    std::string p;
+    if (m_metadata != nullptr) {
+        p = m_metadata->path(server, key, s_message_columns);
+    }
+    base::mapped_file mf(p);
+    message_columns mc;
+    bool mapped = mc.open(mf.data(), mf.size());
+    std::int64_t n = now();
+    // Fresh columns are used as they are, the listing is not even read.
+    bool fresh = mapped && c == cache_use::cached && mc.synced() <= n
+        && n - mc.synced() < s_messages_ttl
+        && !m_metadata->listing_expired(server, key, "messages");
+    std::vector<std::uint64_t> b;
+    if (!fresh) {
+        metadata_cache::listing m;
+        sync_messages(server, key, m, s, v, c);
+        std::string d;
+        if (mapped && mc.generation() == m.generation && mc.size() == m.items.size()) {
+            // Messages are the same, only the time of synchronization is
+            // renewed.
+            d.assign(mf.data(), mf.size());
+            message_columns::set_synced(d, m.synced);
+        } else {
+            d = message_columns::build(m);
+            // Columns are read in place, so they are copied to the buffer
+            // aligned as file mapping is.
+            b.resize((d.size() + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t));
+            std::memcpy(b.data(), d.data(), d.size());
+            if (!mc.open(reinterpret_cast<const char*>(b.data()), d.size())) {
+                fail(s, columns_error(m.items.size()));
+            }
+        }
+        if (m_metadata != nullptr) {
+            m_metadata->store(server, key, s_message_columns, d);
+        }
+    }
+    t.arg("fresh", fresh ? "1" : "0");
+    t.arg("mapped", b.empty() ? "1" : "0");
+    message_query q(mc);
+    std::vector<std::uint32_t> r = q.select(f);
+    record_writer w(io::mout, of);
+    if (g == query_group::none) {
+        for (std::uint32_t i : r) {
+            w.write(q.row(i));
+        }
+    } else {
+        for (const auto& x : q.group(r, g)) {
+            w.write(x);
+        }
+    }
+    w.finish();
+}
+
 namespace {
 
-std::string get_filename(const std::string& url)
+std::string::size_type get_filename_position(const std::string& url)
 {
-    std::string::size_type i = url.find_last_of('/');
-    if (i == std::string::npos) {
-        throw invalid_url(url);
-    }
-    return url.substr(i + 1);
+    return url.find_last_of('/');
 }
 
 }
@@ -325,12 +479,15 @@ void engine::download(const std::set<std::string>& urls,
         report_level s,
         validate_cert v)
 {
-    init_curl(key, s, v);
+    base::trace_span t("engine", "download");
+    init_session(key, s, v);
     std::set<std::string>::const_iterator i = urls.begin();
-    curl_header_guard hg(m_curl);
     while (i != urls.end()) {
-        std::string filename = get_filename(*i);
-        download_impl(*i, path, filename, s);
+        std::string::size_type p = get_filename_position(*i);
+        if (p == std::string::npos) {
+            fail(s, invalid_url(*i));
+        }
+        download_impl(*i, path, i->substr(p + 1), s);
         ++i;
     }
 }
@@ -342,20 +499,21 @@ void engine::download(std::string server,
         report_level s,
         validate_cert v)
 {
-    std::string r = message_impl(server, key, id, s, v, "Retrieving attachments of message.");
+    base::trace_span t("engine", "download_message");
+    std::string r = message_impl(server, key, id, s, v, request::get_message_attachments);
+    message_responce m;
     try {
         auto j = nlohmann::json::parse(r);
-        message_responce m;
         m.read(j);
-        curl_header_guard hg(m_curl);
-        const std::vector<attachment_responce>& a = m.attachments();
-        std::vector<attachment_responce>::const_iterator i = a.begin();
-        while (i != a.end()) {
-            download_impl(i->url(), path, i->filename(), s);
-            ++i;
-        }
     } catch (...) {
-        throw invalid_message_id(id);
+        fail(s, invalid_message_id(id));
+    }
+    // download_impl reports its own errors.
+    const std::vector<attachment_responce>& a = m.attachments();
+    std::vector<attachment_responce>::const_iterator i = a.begin();
+    while (i != a.end()) {
+        download_impl(i->url().str(), path, i->filename().str(), s);
+        ++i;
     }
 }
 
@@ -367,12 +525,11 @@ void engine::download(std::string server,
         report_level s,
         validate_cert v)
 {
-    std::string r = messages_impl(server, key, l, f, s, v);
-    auto j = nlohmann::json::parse(r);
+    base::trace_span t("engine", "download_messages");
     messages_responce m;
-    m.read(r);
+    messages(server, key, l, f, m, s, v);
     for (unsigned i = 0; i < m.size(); ++i) {
-        download(server, path, key, m.id(i), s, v);
+        download(server, key, path, m.id(i), s, v);
     }
 }
 
@@ -384,22 +541,17 @@ std::string engine::file_request(std::string server,
         report_level s,
         validate_cert v)
 {
-    init_curl(key, s, v);
-    server += "/requests";
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
+    base::trace_span t("engine", "file_request");
+    init_session(key, s, v);
+    http_request q = make_request(http_method::post, server + "/requests");
     nlohmann::json j;
     j["request"]["recipient"] = user;
     j["request"]["subject"] = subject;
     j["request"]["message"] = message;
     j["request"]["send_email"] = true;
-    auto data = j.dump();
-    curl_easy_setopt(m_curl, CURLOPT_HTTPPOST, 0);
-    curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, data.c_str());
-    if (s >= report_level::normal) {
-        io::mout << "Sending file request to user '" << user << "'" << io::endl;
-    }
-    return process_file_request_responce(perform(), s);
+    q.body = j.dump();
+    events(s).request_started(request::file_request, user);
+    return process_file_request_responce(perform(q, s), s);
 }
 
 std::string engine::get_api_key(std::string server,
@@ -408,33 +560,27 @@ std::string engine::get_api_key(std::string server,
         report_level s,
         validate_cert v)
 {
-    if (m_curl == nullptr) {
-        m_curl = curl_easy_init();
-    }
-    if (m_curl == nullptr) {
-        throw curl_error("Failed to initialize CURL");
-    }
-    curl_easy_setopt(m_curl, CURLOPT_WRITEFUNCTION, &data_get);
-    curl_easy_setopt(m_curl, CURLOPT_WRITEDATA, 0);
-    if (v == validate_cert::not_validate) {
-        curl_easy_setopt(m_curl, CURLOPT_SSL_VERIFYPEER, false);
-    }
-    if (s == report_level::verbose) {
-        curl_easy_setopt(m_curl, CURLOPT_VERBOSE, 1L);
-    }
-    server += "/login";
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
+    base::trace_span t("engine", "get_api_key");
+    init_session("", s, v);
+    http_request q = make_request(http_method::post, server + "/login");
     nlohmann::json j;
     j["user"]["email"] = user;
     j["user"]["password"] = password;
-    curl_easy_setopt(m_curl, CURLOPT_HTTPPOST, 0);
-    auto data = j.dump();
-    curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, data.c_str());
-    if (s >= report_level::normal) {
-        io::mout << "Getting API key for user '" << user << "'" << io::endl;
-    }
-    return process_get_api_key_responce(perform(), s);
+    q.body = j.dump();
+    events(s).request_started(request::get_api_key, user);
+    return process_get_api_key_responce(perform(q, s), s);
+}
+
+void engine::preconnect(const std::string& server,
+        report_level s,
+        validate_cert v)
+{
+    http_request q;
+    q.method = http_method::head;
+    q.url = server;
+    q.validate = v;
+    q.verbose = s == report_level::verbose;
+    m_transport.preconnect(q);
 }
 
 std::string engine::filelink(std::string server,
@@ -444,9 +590,12 @@ std::string engine::filelink(std::string server,
             report_level s,
             validate_cert v)
 {
-    init_curl(key, s, v);
+    base::trace_span t("engine", "filelink");
+    init_session(key, s, v);
     std::string a = attach_impl(server, file, s);
-    return filelink_impl(server, expire, a, s);
+    std::string r = filelink_impl(server, expire, a, s);
+    forget(server, key, "links");
+    return r;
 }
 
 std::string engine::filelink_attachment(std::string server,
@@ -456,8 +605,11 @@ std::string engine::filelink_attachment(std::string server,
             report_level s,
             validate_cert v)
 {
-    init_curl(key, s, v);
-    return filelink_impl(server, expire, id, s);
+    base::trace_span t("engine", "filelink_attachment");
+    init_session(key, s, v);
+    std::string r = filelink_impl(server, expire, id, s);
+    forget(server, key, "links");
+    return r;
 }
 
 void engine::delete_filelink(std::string server,
@@ -466,20 +618,16 @@ void engine::delete_filelink(std::string server,
             report_level s,
             validate_cert v)
 {
-    init_curl(key, s, v);
-    server += "/link/";
-    server += id;
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
-    curl_easy_setopt(m_curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    if (s >= report_level::normal) {
-        io::mout << "Deleting filelink with id '" << id << "'" << io::endl;
-    }
-    std::string r = perform();
+    base::trace_span t("engine", "delete_filelink");
+    init_session(key, s, v);
+    forget(server, key, "links");
+    http_request q = make_request(http_method::delete_, server + "/link/" + id);
+    events(s).request_started(request::delete_filelink, id);
+    std::string r = perform(q, s);
     if (r.find_first_not_of(' ') != r.npos) {
-        throw request_error("delete_filelink", r);
+        fail(s, request_error("delete_filelink", r));
     }
-    io::mout << "Filelink deleted successfully." << io::endl;
+    events(s).request_completed(request::delete_filelink, id);
 }
 
 void engine::filelinks(std::string server,
@@ -487,20 +635,16 @@ void engine::filelinks(std::string server,
             const std::string& limit,
             output_format of,
             report_level s,
-            validate_cert v)
+            validate_cert v,
+            cache_use c)
 {
-    init_curl(key, s, v);
-    server += "/link";
-    if (!limit.empty()) {
-        server += "?limit=";
-        server += limit;
-    }
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
-    if (s >= report_level::normal) {
-        io::mout << "Getting filelinks from the server." << io::endl;
+    if (of == output_format::json || of == output_format::ndjson) {
+        listing_passthrough p("links", io::mout, of);
+        filelinks_impl(server, key, limit, p, s, v, c);
+        return;
     }
-    process_output_responce<filelinks_responce>(perform(), s, of);
+    filelinks_responce::printer p(io::mout, of);
+    filelinks_impl(server, key, limit, p, s, v, c);
 }
 
 void engine::delete_attachments(std::string server,
@@ -509,21 +653,21 @@ void engine::delete_attachments(std::string server,
             report_level s,
             validate_cert v)
 {
-    init_curl(key, s, v);
+    base::trace_span t("engine", "delete_attachments");
+    init_session(key, s, v);
+    // Listed messages have the attachments, they are all read again. It is
+    // not known which messages have them, details of all are removed.
+    forget(server, key, "messages");
+    if (m_metadata != nullptr) {
+        m_metadata->remove_messages(server, key);
+    }
     server += "/attachment/";
-    curl_easy_setopt(m_curl, CURLOPT_CUSTOMREQUEST, "DELETE");
-    curl_header_guard hg(m_curl);
     std::set<std::string>::const_iterator i = ids.begin();
     for (; i != ids.end(); ++i) {
-        std::string x = server + (*i);
-        curl_easy_setopt(m_curl, CURLOPT_URL, x.c_str());
-        if (s >= report_level::normal) {
-            io::mout << "Deleting attachment '" << *i << "'" << io::endl;
-        }
-        perform();
-        if (s >= report_level::normal) {
-            io::mout << "Deleted successfully." << io::endl;
-        }
+        http_request q = make_request(http_method::delete_, server + (*i));
+        events(s).request_started(request::delete_attachment, *i);
+        perform(q, s);
+        events(s).request_completed(request::delete_attachment, *i);
     }
 }
 
@@ -533,19 +677,19 @@ void engine::delete_attachments(std::string server,
             report_level s,
             validate_cert v)
 {
-    init_curl(key, s, v);
+    base::trace_span t("engine", "delete_message_attachments");
+    init_session(key, s, v);
+    forget(server, key, "messages");
+    if (m_metadata != nullptr) {
+        m_metadata->remove_message(server, key, id);
+    }
     server += "/message/";
     server += id;
     server += "/delete_attachments";
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
-    if (s >= report_level::normal) {
-        io::mout << "Deleting attachments of the message." << io::endl;
-    }
-    perform();
-    if (s >= report_level::normal) {
-        io::mout << "Deleted attachments successfully." << io::endl;
-    }
+    http_request q = make_request(http_method::get, server);
+    events(s).request_started(request::delete_message_attachments, id);
+    perform(q, s);
+    events(s).request_completed(request::delete_message_attachments, id);
 }
 
 namespace {
@@ -566,16 +710,29 @@ void engine::filedrop(std::string server,
         report_level s,
         validate_cert v)
 {
+    set_file_list l(fs);
+    filedrop(server, user, subject, message, l, s, v);
+}
+
+void engine::filedrop(std::string server,
+        const std::string& user,
+        const std::string& subject,
+        const std::string& message,
+        file_list& fs,
+        report_level s,
+        validate_cert v)
+{
+    base::trace_span t("engine", "filedrop");
     std::string key = get_filedrop_api_key(server, s, v);
-    init_curl(key, s, v);
-    strings::const_iterator i = fs.begin();
+    init_session(key, s, v);
     strings rs;
     std::string url = get_server_from_filedrop(server);
-    for (; i != fs.end(); ++i) {
-        std::string id = attach_impl(url, *i, s);
-        rs.insert(id);
+    std::string f;
+    while (fs.next(f)) {
+        rs.insert(attach_impl(url, f, s));
     }
-    curl_easy_setopt(m_curl, CURLOPT_USERPWD, "");
+    // Filedrop message is sent without authentication.
+    m_key.clear();
     filedrop_attachments_impl(server, key, user, subject, message, rs, s);
 }
 
@@ -587,6 +744,7 @@ void engine::filedrop_attachments(std::string server,
             report_level s,
             validate_cert v)
 {
+    base::trace_span t("engine", "filedrop_attachments");
     std::string key = get_filedrop_api_key(server, s, v);
     filedrop_attachments_impl(server, key, user, subject, message, fs, s);
 }
@@ -595,147 +753,124 @@ std::string engine::attach_impl(std::string server,
         const std::string& file,
         report_level s)
 {
-    server += "/attachments";
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_httppost* formpost = nullptr;
-    curl_httppost* lastptr = nullptr;
-    curl_formadd(&formpost,
-               &lastptr,
-               CURLFORM_COPYNAME, "Filedata",
-               CURLFORM_FILE, file.c_str(),
-               CURLFORM_END);
-    curl_form_guard fg(formpost);
-    curl_easy_setopt(m_curl, CURLOPT_HTTPPOST, formpost);
-    progress_guard pg(m_curl, s);
-    if (s >= report_level::normal) {
-        io::mout << "Uploading file '" << file << "'." << io::endl;
-    }
-    std::string r = perform();
-    pg.end();
-    process_attach_responce(r, s);
+    base::trace_span t("engine", "upload_file");
+    t.arg("file", file);
+    http_request q = make_request(http_method::post, server + "/attachments");
+    q.headers.clear();
+    q.form.push_back(form_field{"Filedata", file, true});
+    events(s).transfer_started(transfer::upload, file);
+    std::string r = perform(q, transfer::upload, s);
+    process_attach_responce(file, r, s);
     return r;
 }
 
 std::string engine::send_attachments_impl(std::string server,
-        const std::string& user,
+        const std::string& key,
+        const recipients& to,
         const std::string& subject,
         const std::string& message,
         const strings& fs,
         report_level s)
 {
-    server += "/message";
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
+    base::trace_span t("engine", "send_message");
+    http_request q = make_request(http_method::post, server + "/message");
     nlohmann::json j;
     j["message"]["subject"] = subject;
     j["message"]["message"] = message;
     j["message"]["send_email"] = "true";
     j["message"]["authorization"] = 3;
-    j["message"]["recipients"] = std::vector<std::string>{1, user};
+    j["message"]["recipients"] = to.to;
+    if (!to.cc.empty()) {
+        j["message"]["cc"] = to.cc;
+    }
+    if (!to.bcc.empty()) {
+        j["message"]["bcc"] = to.bcc;
+    }
     j["message"]["attachments"] = fs;
-    curl_easy_setopt(m_curl, CURLOPT_HTTPPOST, 0);
-    auto data = j.dump();
-    curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, data.c_str());
-    if (s >= report_level::normal) {
-        io::mout << "Sending message to user '" << user << "'" << io::endl;
+    q.body = j.dump();
+    events(s).request_started(request::send, to.names());
+    std::string id = process_send_responce(perform(q, s), s);
+    if (m_metadata != nullptr) {
+        m_metadata->expire_listing(server, key, "messages");
     }
-    return process_send_responce(perform(), s);
+    return id;
 }
 
 std::string engine::filelink_impl(std::string server, const std::string& expire,
             const std::string& id, report_level s)
 {
-    server += "/link";
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
+    http_request q = make_request(http_method::post, server + "/link");
     nlohmann::json j;
     j["link"]["attachment"] = id;
     if (!expire.empty()) {
         j["link"]["expires_at"] = expire;
     }
-    auto data = j.dump();
-    curl_easy_setopt(m_curl, CURLOPT_HTTPPOST, 0);
-    curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, data.c_str());
-    if (s >= report_level::normal) {
-        io::mout << "Creating filelink" << io::endl;
-    }
-    return process_create_filelink_responce(perform(), s);
+    q.body = j.dump();
+    events(s).request_started(request::create_filelink, id);
+    return process_create_filelink_responce(perform(q, s), s);
 }
 
-void engine::process_attach_chunk_responce(const std::string& r, report_level s) const
+void engine::process_attach_chunk_responce(const std::string& f,
+        const std::string& r, report_level s) const
 {
     if (r.empty() || r == " ") {
-        if (s >= report_level::normal) {
-            io::mout << "Current chunk uploaded successfully." << io::endl;
-        }
+        events(s).transfer_finished(transfer::upload_chunk, f, "");
         return;
     }
     if (r.size() == s_normal_id_size) {
-        if (s >= report_level::normal) {
-            io::mout << "All chunks of file uploaded successfully. ID: " << r << io::endl;
-        }
+        events(s).transfer_finished(transfer::upload_chunk, f, r);
         return;
     }
-    throw request_error("upload_chunk", r);
+    fail(s, request_error("upload_chunk", r));
 }
 
-void engine::process_attach_responce(const std::string& r, report_level s) const
+void engine::process_attach_responce(const std::string& f,
+        const std::string& r, report_level s) const
 {
     if (r.size() == s_normal_id_size) {
-        if (s >= report_level::normal) {
-            io::mout << "File uploaded successfully. ID: " << r << io::endl;
-        }
+        events(s).transfer_finished(transfer::upload, f, r);
         return;
     }
-    throw request_error("upload", r);
+    fail(s, request_error("upload", r));
 }
 
-std::string engine::process_send_responce(std::string r,
+std::string engine::process_send_responce(const std::string& r,
         report_level s) const
 {
-    /// @todo workaround for json parser as it does not recognize backslash.
-    std::replace(r.begin(), r.end(), '\\', '0');
-    auto j = nlohmann::json::parse(r);
-    try {
-        auto id = j["message"]["id"].get<std::string>();
-        if (s >= report_level::normal) {
-            io::mout << "Message sent successfully. ID: " << id << io::endl;
-        }
-        return id;
-    } catch (std::exception) {
+    std::string id;
+    if (!extract(io::json_extractor(r), "message.id", id, s) || id.empty()) {
+        fail(s, request_error("send", r));
     }
-    throw request_error("send", r);
-    return "";
+    events(s).request_completed(request::send, id);
+    return id;
 }
 
 template <typename T>
-void engine::process_output_responce(const std::string& r,
-        report_level s, output_format f) const
+std::string engine::process_output_responce(const std::string& r, output_format f) const
 {
     auto j = nlohmann::json::parse(r);
     T m;
     m.read(j);
-    io::mout << m.to_string(f);
+    return m.to_string(f);
 }
 
 std::string engine::message_impl(std::string server, const std::string& key,
-        std::string id, report_level s, validate_cert v, std::string log)
+        std::string id, report_level s, validate_cert v, request k)
 {
-    init_curl(key, s, v);
+    init_session(key, s, v);
     server += "/message/";
     server += id;
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
-    if (s >= report_level::normal) {
-        io::mout << log << io::endl;
-    }
-    return perform();
+    http_request q = make_request(http_method::get, server);
+    events(s).request_started(k, id);
+    return perform(q, s);
 }
 
-std::string engine::messages_impl(std::string server, const std::string& key, std::string l,
-        std::string f, report_level s, validate_cert v)
+template <typename D>
+void engine::messages_impl(std::string server, const std::string& key, std::string l,
+        std::string f, D& d, report_level s, validate_cert v)
 {
-    init_curl(key, s, v);
+    base::trace_span t("engine", "messages");
+    init_session(key, s, v);
     server += "/message";
     if (!l.empty()) {
         server += "?sent_in_the_last=";
@@ -744,12 +879,271 @@ std::string engine::messages_impl(std::string server, const std::string& key, st
         server += "?sent_after=";
         server += f;
     }
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
-    if (s >= report_level::normal) {
-        io::mout << "Getting messages from the server." << io::endl;
+    http_request q = make_request(http_method::get, server);
+    events(s).request_started(request::list_messages, "");
+    perform(q, d, "messages", s);
+}
+
+namespace {
+
+using items = std::vector<const metadata_cache::item*>;
+
+/// @brief Formats the time t in UTC by strftime format f.
+std::string utc_time(std::int64_t t, const char* f)
+{
+    std::time_t x = static_cast<std::time_t>(t);
+    std::tm m;
+    gmtime_r(&x, &m);
+    char b[32];
+    return std::string(b, std::strftime(b, sizeof(b), f, &m));
+}
+
+bool is_number(const std::string& v, std::size_t n)
+{
+    return !v.empty() && v.size() <= n
+        && v.find_first_not_of("0123456789") == std::string::npos;
+}
+
+/**
+ * @brief Gets the earliest creation time of the listed messages, in the
+ *        format of server, to filter the cached ones as server does.
+ * @param l Hours, to get messages from the last specified hours.
+ * @param f Date YYYYMMDD, to get messages from that date.
+ * @param[out] t Time, empty for all messages.
+ * @return false if the arguments are not valid, so server reports it.
+ */
+bool earliest_time(const std::string& l, const std::string& f, std::string& t)
+{
+    if (!l.empty()) {
+        if (!is_number(l, 6)) {
+            return false;
+        }
+        t = utc_time(now() - std::stoll(l) * 3600, "%Y-%m-%dT%H:%M:%S");
+    } else if (!f.empty()) {
+        if (!is_number(f, 8) || f.size() != 8) {
+            return false;
+        }
+        t = f.substr(0, 4) + "-" + f.substr(4, 2) + "-" + f.substr(6, 2);
+    }
+    return true;
+}
+
+/// @brief Reads the items of listing, written one per line.
+std::vector<metadata_cache::item> read_items(const std::string& d)
+{
+    std::vector<metadata_cache::item> is;
+    std::string::size_type b = 0;
+    for (std::string::size_type e = d.find('\n'); e != std::string::npos;
+            b = e + 1, e = d.find('\n', b)) {
+        metadata_cache::item i;
+        i.json.assign(d, b, e - b);
+        io::json_extractor x(i.json);
+        x.get("id", i.id);
+        x.get("created_at", i.created_at);
+        is.push_back(std::move(i));
+    }
+    return is;
+}
+
+/**
+ * @brief Replaces the cached items by the ones read again, by id, and
+ *        appends the new ones.
+ * @return false if the items are the same as cached.
+ */
+bool merge(std::vector<metadata_cache::item>& c, std::vector<metadata_cache::item>& n)
+{
+    std::unordered_map<std::string, std::size_t> index;
+    for (std::size_t i = 0; i < c.size(); ++i) {
+        index[c[i].id] = i;
+    }
+    bool changed = false;
+    for (auto& i : n) {
+        auto x = i.id.empty() ? index.end() : index.find(i.id);
+        if (x == index.end()) {
+            c.push_back(std::move(i));
+            changed = true;
+        } else if (c[x->second].json != i.json) {
+            c[x->second] = std::move(i);
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+/**
+ * @brief Removes the items expired before the day d, server does not list
+ *        them anymore.
+ * @param d Date as server writes it, YYYY-MM-DD.
+ * @return false if no item is removed.
+ */
+bool prune(std::vector<metadata_cache::item>& is, const std::string& d)
+{
+    auto e = std::remove_if(is.begin(), is.end(), [&d](const metadata_cache::item& i) {
+        std::string x;
+        io::json_extractor(i.json).get("expires_at", x);
+        return !x.empty() && x.compare(0, d.size(), d) < 0;
+    });
+    bool r = e != is.end();
+    is.erase(e, is.end());
+    return r;
+}
+
+/// @brief Returns the generation of changed listing, see
+///        metadata_cache::listing::generation.
+std::uint64_t next_generation(std::uint64_t g)
+{
+    auto t = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    return std::max(g + 1, static_cast<std::uint64_t>(t));
+}
+
+/// @brief Feeds the items to handler as the listing responce of server.
+void feed(const std::string& n, const items& is, responce_handler& h)
+{
+    std::string b = "{\"" + n + "\":[";
+    const char* s = "";
+    for (const auto* i : is) {
+        b += s;
+        b += i->json;
+        s = ",";
+        if (b.size() >= s_replay_block) {
+            h.data(b.data(), b.size());
+            b.clear();
+        }
+    }
+    b += "]}";
+    h.data(b.data(), b.size());
+}
+
+void replay(const std::string& n, const items& is, listing_passthrough& p)
+{
+    feed(n, is, p);
+    p.finish();
+}
+
+void replay(const std::string& n, const items& is, listing_decoder& d)
+{
+    json_stream_handler h(d);
+    feed(n, is, h);
+    h.finish();
+}
+
+}
+
+template <typename D>
+void engine::cached_messages(const std::string& server, const std::string& key,
+        const std::string& l, const std::string& f, D& d, report_level s,
+        validate_cert v, cache_use c)
+{
+    std::string e;
+    if (m_metadata == nullptr || !earliest_time(l, f, e)) {
+        messages_impl(server, key, l, f, d, s, v);
+        return;
+    }
+    metadata_cache::listing m;
+    sync_messages(server, key, m, s, v, c);
+    items is;
+    for (const auto& i : m.items) {
+        if (i.created_at >= e) {
+            is.push_back(&i);
+        }
+    }
+    replay("messages", is, d);
+}
+
+void engine::sync_messages(const std::string& server, const std::string& key,
+        metadata_cache::listing& m, report_level s, validate_cert v, cache_use c)
+{
+    base::trace_span t("engine", "sync_messages");
+    bool cached = m_metadata != nullptr && c == cache_use::cached
+        && m_metadata->find_listing(server, key, "messages", m);
+    std::int64_t synced = now();
+    bool expired = m_metadata != nullptr
+        && m_metadata->listing_expired(server, key, "messages");
+    if (cached && !expired && m.synced <= synced && synced - m.synced < s_messages_ttl) {
+        t.arg("read", "0");
+        return;
+    }
+    if (expired) {
+        // Marked again if a message is sent meanwhile.
+        m_metadata->renew_listing(server, key, "messages");
+    }
+    init_session(key, s, v);
+    std::string u = server + "/message";
+    if (cached) {
+        // Only the messages sent since the last listing are read.
+        u += "?sent_after=";
+        u += utc_time(m.synced - s_sync_overlap, "%Y%m%d");
+    }
+    events(s).request_started(request::list_messages, "");
+    std::vector<metadata_cache::item> n =
+        read_items(fetch_listing(make_request(http_method::get, u), "messages", "messages", s));
+    t.arg("read", std::to_string(n.size()));
+    bool changed = true;
+    if (cached) {
+        changed = merge(m.items, n);
+        changed = prune(m.items, utc_time(synced, "%Y-%m-%d")) || changed;
+    } else {
+        m.items = std::move(n);
+    }
+    if (changed) {
+        m.generation = next_generation(m.generation);
+    }
+    m.synced = synced;
+    if (m_metadata != nullptr) {
+        m_metadata->store_listing(server, key, "messages", m);
+    }
+}
+
+template <typename D>
+void engine::filelinks_impl(const std::string& server, const std::string& key,
+        const std::string& limit, D& d, report_level s, validate_cert v,
+        cache_use c)
+{
+    base::trace_span t("engine", "filelinks");
+    init_session(key, s, v);
+    std::string u = server + "/link";
+    if (m_metadata == nullptr || !(limit.empty() || is_number(limit, 9))) {
+        if (!limit.empty()) {
+            u += "?limit=";
+            u += limit;
+        }
+        http_request q = make_request(http_method::get, u);
+        events(s).request_started(request::list_filelinks, "");
+        perform(q, d, "filelinks", s);
+        return;
+    }
+    metadata_cache::listing m;
+    std::int64_t synced = now();
+    bool cached = c == cache_use::cached
+        && m_metadata->find_listing(server, key, "links", m)
+        && m.synced <= synced && synced - m.synced < s_links_ttl;
+    t.arg("cached", cached ? "1" : "0");
+    if (!cached) {
+        // The whole list is read, to answer any limit.
+        events(s).request_started(request::list_filelinks, "");
+        m.items = read_items(fetch_listing(make_request(http_method::get, u),
+                    "links", "filelinks", s));
+        m.synced = synced;
+        m_metadata->store_listing(server, key, "links", m);
+    }
+    std::size_t n = limit.empty() ? m.items.size() : std::stoul(limit);
+    items is;
+    for (std::size_t i = 0; i < m.items.size() && i < n; ++i) {
+        is.push_back(&m.items[i]);
+    }
+    replay("links", is, d);
+}
+
+void engine::forget(const std::string& server, const std::string& key,
+        const std::string& n)
+{
+    if (m_metadata != nullptr) {
+        m_metadata->remove_listing(server, key, n);
+        if (n == "messages") {
+            m_metadata->remove(server, key, s_message_columns);
+        }
     }
-    return perform();
 }
 
 void engine::download_impl(const std::string& url,
@@ -757,42 +1151,38 @@ void engine::download_impl(const std::string& url,
         std::string name,
         report_level s)
 {
-    if (s >= report_level::normal) {
-        io::mout << "Downloading file '" << name << "'" << io::endl;
-    }
+    base::trace_span t("engine", "download_file");
+    events(s).transfer_started(transfer::download, name);
     if (!path.empty()) {
         name = path + "/" + name;
     }
+    t.arg("file", name);
     FILE* fp = fopen(name.c_str(), "wb");
     if (fp == nullptr) {
-        throw file_error(name, strerror(errno));
+        fail(s, file_error(name, strerror(errno)));
     }
-    curl_file_guard fg(m_curl, fp, s);
-    curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
-    perform();
+    {
+        file_handler h(fp, name, events(s));
+        perform(make_request(http_method::get, url), h, s);
+    }
+    events(s).transfer_finished(transfer::download, name, "");
 }
 
 std::string engine::get_filedrop_api_key(const std::string& url, report_level s, validate_cert v)
 {
-    init_curl("", s, v);
-    curl_easy_setopt(m_curl, CURLOPT_URL, url.c_str());
-    curl_header_guard hg(m_curl);
-    if (s >= report_level::verbose) {
-        io::mout << "Getting filedrop API key" << io::endl;
-    }
-    std::string r = perform();
-    auto j = nlohmann::json::parse(r);
-    if (j.find("errors") != j.end()) {
-        auto e = j["errors"].get<std::vector<std::string>>()[0];
-        throw request_error("filedrop info", e);
-    }
-    std::string q = j["filedrop"]["api_key"].get<std::string>();
-    if (q.empty()) {
-        throw request_error("filedrop info", r);
-    }
-    if (s >= report_level::normal) {
-        io::mout << "Got filedrop API key: " << q << io::endl;
-    }
+    base::trace_span t("engine", "get_filedrop_api_key");
+    init_session("", s, v);
+    events(s, report_level::verbose).request_started(request::get_filedrop_api_key, url);
+    std::string r = perform(make_request(http_method::get, url), s);
+    io::json_extractor x(r);
+    std::string q;
+    if (extract(x, "errors.0", q, s)) {
+        fail(s, request_error("filedrop info", q));
+    }
+    if (!extract(x, "filedrop.api_key", q, s) || q.empty()) {
+        fail(s, request_error("filedrop info", r));
+    }
+    events(s).request_completed(request::get_filedrop_api_key, q);
     return q;
 }
 
@@ -800,83 +1190,156 @@ void engine::filedrop_attachments_impl(std::string server, const std::string& ke
         const std::string& user, const std::string& subject,
         const std::string& message, const strings& fs, report_level s)
 {
-    curl_easy_setopt(m_curl, CURLOPT_URL, server.c_str());
-    curl_header_guard hg(m_curl);
+    http_request q = make_request(http_method::post, server);
     nlohmann::json j;
     j["message"]["from"] = user;
     j["message"]["subject"] = subject;
     j["message"]["message"] = message;
     j["message"]["attachments"] = fs;
-    auto data = j.dump();
-    curl_easy_setopt(m_curl, CURLOPT_HTTPPOST, 0);
-    curl_easy_setopt(m_curl, CURLOPT_POSTFIELDS, data.c_str());
-    if (s >= report_level::normal) {
-        io::mout << "Sending message to filedrop" << io::endl;
-    }
-    process_filedrop_responce(perform(), s);
+    q.body = j.dump();
+    events(s).request_started(request::filedrop, user);
+    process_filedrop_responce(perform(q, s), s);
 }
 
 std::string engine::process_file_request_responce(const std::string& r, report_level s) const
 {
-    auto j = nlohmann::json::parse(r);
-    std::string q = j["request"]["url"].get<std::string>();
-    if (q.empty()) {
-        throw request_error("file_request", r);
-    }
-    if (s >= report_level::normal) {
-        io::mout << "Request sent successfully. URL: " << q << io::endl;
+    std::string q;
+    if (!extract(io::json_extractor(r), "request.url", q, s) || q.empty()) {
+        fail(s, request_error("file_request", r));
     }
+    events(s).request_completed(request::file_request, q);
     return q;
 }
 
 std::string engine::process_get_api_key_responce(const std::string& r, report_level s) const
 {
-    auto j = nlohmann::json::parse(r);
-    try {
-        auto r = j["user"]["api_key"].get<std::string>();
-        if (s >= report_level::normal) {
-            io::mout << r << io::endl;
-        }
-        return r;
-    } catch (std::exception) {
-        throw request_error("get_api_key", j["errors"][0].get<std::string>());
+    io::json_extractor x(r);
+    std::string q;
+    if (extract(x, "user.api_key", q, s)) {
+        events(s).request_completed(request::get_api_key, q);
+        return q;
+    }
+    if (extract(x, "errors.0", q, s)) {
+        fail(s, request_error("get_api_key", q));
     }
+    fail(s, request_error("get_api_key", r));
 }
 
 std::string engine::process_create_filelink_responce(const std::string& r, report_level s) const
 {
-    auto j = nlohmann::json::parse(r);
-    auto q = j["link"]["url"].get<std::string>();
-    if (s >= report_level::normal) {
-        io::mout << "Created filelink sucessfully. URL: " << q << io::endl;
+    std::string q;
+    if (!extract(io::json_extractor(r), "link.url", q, s) || q.empty()) {
+        fail(s, request_error("filelink", r));
     }
+    events(s).request_completed(request::create_filelink, q);
     return q;
 }
 
 void engine::process_filedrop_responce(const std::string& r, report_level s) const
 {
     if (r.empty()) {
-        throw request_error("filedrop", "Empty responce");
+        fail(s, request_error("filedrop", "Empty responce"));
     }
-    auto j = nlohmann::json::parse(r);
-    if (j.find("errors") != j.end()) {
-        auto e = j["errors"].get<std::vector<std::string>>()[0];
-        throw request_error("filedrop", e);
+    io::json_extractor x(r);
+    std::string q;
+    if (extract(x, "errors.0", q, s)) {
+        fail(s, request_error("filedrop", q));
     }
-    if (s >= report_level::normal) {
-        io::mout << j["message"]["status"].get<std::string>() << io::endl;
+    if (!extract(x, "message.status", q, s)) {
+        fail(s, request_error("filedrop", r));
     }
+    events(s).request_completed(request::filedrop, q);
 }
 
-std::string engine::perform()
+bool engine::extract(const io::json_extractor& r, const std::string& p,
+        std::string& v, report_level s) const
 {
-    CURLcode res = curl_easy_perform(m_curl);
-    if (res != CURLE_OK) {
-        throw curl_error(std::string(curl_easy_strerror(res)));
+    try {
+        return r.get(p, v);
+    } catch (const io::invalid_json& e) {
+        fail(s, e);
+    }
+}
+
+event_sink& engine::events(report_level s, report_level l) const
+{
+    if (s >= l) {
+        return m_events;
+    }
+    return s_null_events;
+}
+
+template <typename E>
+void engine::fail(report_level s, const E& e) const
+{
+    events(s).error(e);
+    throw e;
+}
+
+void engine::perform(const http_request& q, responce_handler& h, report_level s)
+{
+    base::trace_span t("http", method_name(q.method));
+    t.arg("url", q.url);
+    try {
+        m_transport.perform(q, h);
+    } catch (const base::exception& e) {
+        events(s).error(e);
+        throw;
+    }
+}
+
+std::string engine::perform(const http_request& q, report_level s)
+{
+    string_handler h(s_null_events, transfer::upload);
+    perform(q, h, s);
+    return std::move(h.str());
+}
+
+std::string engine::perform(const http_request& q, transfer t, report_level s)
+{
+    string_handler h(events(s), t);
+    perform(q, h, s);
+    return std::move(h.str());
+}
+
+void engine::perform(const http_request& q, listing_decoder& d, const std::string& r,
+        report_level s)
+{
+    json_stream_handler h(d);
+    perform(q, h, s);
+    try {
+        h.finish();
+    } catch (const base::exception& e) {
+        events(s).error(e);
+        throw;
+    }
+    if (!d.error().empty()) {
+        fail(s, request_error(r, d.error()));
+    }
+}
+
+std::string engine::fetch_listing(const http_request& q, const std::string& n,
+        const std::string& r, report_level s)
+{
+    std::ostringstream o;
+    listing_passthrough p(n, o, output_format::ndjson);
+    perform(q, p, r, s);
+    return o.str();
+}
+
+void engine::perform(const http_request& q, listing_passthrough& p, const std::string& r,
+        report_level s)
+{
+    perform(q, static_cast<responce_handler&>(p), s);
+    try {
+        p.finish();
+    } catch (const base::exception& e) {
+        events(s).error(e);
+        throw;
+    }
+    if (!p.error().empty()) {
+        fail(s, request_error(r, p.error()));
     }
-    std::string r = s_data;
-    s_data.clear();
-    return r;
 }
 
 }
@@ -1,14 +1,28 @@
 #pragma once
 
 #include "declarations.h"
-
-#include <curl/curl.h>
-
+#include "event_sink.h"
+#include "file_list.h"
+#include "listing_decoder.h"
+#include "listing_passthrough.h"
+#include "message_query.h"
+#include "metadata_cache.h"
+#include "recipients.h"
+#include "transport.h"
+
+#include <memory>
 #include <set>
 #include <string>
 
+namespace io {
+class json_extractor;
+}
+
 namespace lf {
 
+class dns_cache;
+class messages_responce;
+
 /**
  * @class engine
  * @brief API for liquidfiles.
@@ -20,12 +34,31 @@ namespace lf {
 class engine final
 {
 public:
-    /// @brief Constructor.
-    engine();
+    /**
+     * @brief Constructor.
+     * @param e Sink to report the progress of operations.
+     * @param c Cache of server addresses, must outlive engine, or null.
+     * @param m Cache of messages and filelinks, must outlive engine, or
+     *        null.
+     */
+    engine(event_sink& e, dns_cache* c = nullptr, metadata_cache* m = nullptr);
+
+    /**
+     * @brief Constructor.
+     * @param e Sink to report the progress of operations.
+     * @param t Transport to perform the requests, must outlive engine.
+     */
+    engine(event_sink& e, transport& t);
 
     /// @brief Destructor.
     ~engine();
 
+    /// @brief Returns the cache of messages and filelinks, or null.
+    metadata_cache* metadata() const
+    {
+        return m_metadata;
+    }
+
 private:
     engine(const engine&);
     engine& operator=(const engine&);
@@ -37,10 +70,11 @@ public:
 
 public:
     /**
-     * @brief Sends the file to specified user, by specified server.
+     * @brief Sends the file to specified users, by specified server, by
+     *        one message.
      * @param server Server URL.
      * @param key API Key of Liquidfiles.
-     * @param user User name or email.
+     * @param to Recipients of message.
      * @param subject Subject of composed email.
      * @param message Message body of email.
      * @param fs Files list to send.
@@ -50,7 +84,7 @@ public:
      */
     std::string send(std::string server,
             const std::string& key,
-            const std::string& user,
+            const recipients& to,
             const std::string& subject,
             const std::string& message,
             const strings& fs,
@@ -58,10 +92,25 @@ public:
             validate_cert v);
 
     /**
-     * @brief Sends the given attachments to given user.
+     * @brief Sends the files to specified users, uploading each file as
+     *        soon as it is read from the list.
+     * @param fs Files list to send.
+     * @see send.
+     */
+    std::string send(std::string server,
+            const std::string& key,
+            const recipients& to,
+            const std::string& subject,
+            const std::string& message,
+            file_list& fs,
+            report_level s,
+            validate_cert v);
+
+    /**
+     * @brief Sends the given attachments to given users.
      * @param server Server URL.
      * @param key API Key of Liquidfiles.
-     * @param user User name or email.
+     * @param to Recipients of message.
      * @param subject Subject of composed email.
      * @param message Message body of email.
      * @param fs Attachment IDs.
@@ -71,7 +120,7 @@ public:
      */
     std::string send_attachments(std::string server,
             const std::string& key,
-            const std::string& user,
+            const recipients& to,
             const std::string& subject,
             const std::string& message,
             const strings& fs,
@@ -93,6 +142,34 @@ public:
             report_level s,
             validate_cert v);
 
+    /**
+     * @brief Uploads the files to server, each as soon as it is read from
+     *        the list.
+     * @param fs Files list to send.
+     * @see attach.
+     */
+    void attach(std::string server,
+            const std::string& key,
+            file_list& fs,
+            report_level s,
+            validate_cert v);
+
+    /**
+     * @brief Uploads the file to server.
+     * @param server Server URL.
+     * @param key API Key of Liquidfiles.
+     * @param file File path to upload.
+     * @param s Silence flag.
+     * @param v Validate certificate flag for HTTP request.
+     * @return ID of attachment.
+     * @throw curl_error, request_error.
+     */
+    std::string upload(std::string server,
+            const std::string& key,
+            const std::string& file,
+            report_level s,
+            validate_cert v);
+
     /**
      * @brief Uploads given chunk of the whole file to server.
      * @param server Server URL.
@@ -116,6 +193,9 @@ public:
 
     /**
      * @brief Lists all the messages.
+     *
+     *        With the cache, only the messages sent since the last listing
+     *        are read from server, then the list is filtered locally.
      * @param server Server URL.
      * @param key API Key of Liquidfiles.
      * @param l Hours, to get messages from the last specified hours.
@@ -123,6 +203,7 @@ public:
      * @param s Silence flag.
      * @param v Validate certificate flag for HTTP request.
      * @param f Format of output (table or csv).
+     * @param c Whether the cached messages are used, or all are read again.
      * @throw curl_error.
      */
     void messages(std::string server,
@@ -131,8 +212,51 @@ public:
             const std::string& f,
             output_format of,
             report_level s,
+            validate_cert v,
+            cache_use c);
+
+    /**
+     * @brief Gets all the messages without printing them.
+     * @param server Server URL.
+     * @param key API Key of Liquidfiles.
+     * @param l Hours, to get messages from the last specified hours.
+     * @param f Date, to get messages from that date.
+     * @param m Responce to fill.
+     * @param s Silence flag.
+     * @param v Validate certificate flag for HTTP request.
+     * @throw curl_error.
+     */
+    void messages(std::string server,
+            const std::string& key,
+            const std::string& l,
+            const std::string& f,
+            messages_responce& m,
+            report_level s,
             validate_cert v);
 
+    /**
+     * @brief Queries the messages by the columns of their metadata, which
+     *        are kept in cache and built again when messages change. Fresh
+     *        columns are mapped and used with no synchronization.
+     * @param server Server URL.
+     * @param key API Key of Liquidfiles.
+     * @param f Filter of messages.
+     * @param g Grouping of messages, none to list them.
+     * @param of Format of output.
+     * @param s Silence flag.
+     * @param v Validate certificate flag for HTTP request.
+     * @param c Whether the cached messages are used, or all are read again.
+     * @throw curl_error, request_error, invalid_json, columns_error.
+     */
+    void query(std::string server,
+            const std::string& key,
+            const message_filter& f,
+            query_group g,
+            output_format of,
+            report_level s,
+            validate_cert v,
+            cache_use c);
+
     /**
      * @brief List the given message.
      * @param server Server URL.
@@ -141,6 +265,7 @@ public:
      * @param s Silence flag.
      * @param v Validate certificate flag for HTTP request.
      * @param f Format of output (table or csv).
+     * @param c Whether the cached message is used, or read again.
      * @throw curl_error, invalid_message_id.
      */
     void message(std::string server,
@@ -148,7 +273,8 @@ public:
             const std::string& id,
             output_format f,
             report_level s,
-            validate_cert v);
+            validate_cert v,
+            cache_use c);
 
     /**
      * @brief Downloads the files from the given urls.
@@ -284,11 +410,15 @@ public:
 
     /**
      * @brief Lists the filelinks.
+     *
+     *        With the cache, the list read in the last minutes is used,
+     *        unless filelinks were created or deleted since.
      * @param server Server URL.
      * @param key API Key of Liquidfiles.
      * @param limit Limit of list.
      * @param s Silence flag.
      * @param v Validate certificate flag for HTTP request.
+     * @param c Whether the cached filelinks are used, or read again.
      * @throw curl_error.
      */
     void filelinks(std::string server,
@@ -296,7 +426,8 @@ public:
             const std::string& limit,
             output_format of,
             report_level s,
-            validate_cert v);
+            validate_cert v,
+            cache_use c);
 
     /**
      * @brief Deletes the given attachments.
@@ -347,6 +478,20 @@ public:
             report_level s,
             validate_cert v);
 
+    /**
+     * @brief Sends the files by filedrop, uploading each file as soon as
+     *        it is read from the list.
+     * @param fs Files list to send.
+     * @see filedrop.
+     */
+    void filedrop(std::string server,
+            const std::string& user,
+            const std::string& subject,
+            const std::string& message,
+            file_list& fs,
+            report_level s,
+            validate_cert v);
+
     /**
      * @brief Sends the given attachments by filedrop
      * @param server Filedrop server URL.
@@ -365,21 +510,63 @@ public:
             const strings& fs,
             report_level s,
             validate_cert v);
+
+    /**
+     * @brief Starts connecting to the server in background (name lookup,
+     *        TCP and TLS handshakes), so the first request of the following
+     *        operation does not wait for it. Call before local preparation,
+     *        e.g. listing directories or reading the message file.
+     * @param server Server URL.
+     * @param s Silence flag.
+     * @param v Validate certificate flag for HTTP request, must be the
+     *        same as of the operation to reuse the connection.
+     */
+    void preconnect(const std::string& server,
+            report_level s,
+            validate_cert v);
     /// @}
 
 private:
     std::string attach_impl(std::string server, const std::string& file,
             report_level s);
-    std::string send_attachments_impl(std::string server, const std::string& user,
-            const std::string& subject, const std::string& message,
+    std::string send_attachments_impl(std::string server, const std::string& key,
+            const recipients& to, const std::string& subject, const std::string& message,
             const strings& fs, report_level s);
     std::string filelink_impl(std::string server, const std::string& expire,
             const std::string& id, report_level s);
-    void init_curl(std::string key, report_level s, validate_cert v);
+    void init_session(const std::string& key, report_level s, validate_cert v);
+    http_request make_request(http_method m, const std::string& url) const;
     std::string message_impl(std::string server, const std::string& key, std::string id,
-            report_level s, validate_cert v, std::string log);
-    std::string messages_impl(std::string server, const std::string& key, std::string l,
-            std::string f, report_level s, validate_cert v);
+            report_level s, validate_cert v, request k);
+    template <typename D>
+    void messages_impl(std::string server, const std::string& key, std::string l,
+            std::string f, D& d, report_level s, validate_cert v);
+    template <typename D>
+    void cached_messages(const std::string& server, const std::string& key,
+            const std::string& l, const std::string& f, D& d, report_level s,
+            validate_cert v, cache_use c);
+    template <typename D>
+    void filelinks_impl(const std::string& server, const std::string& key,
+            const std::string& limit, D& d, report_level s, validate_cert v,
+            cache_use c);
+    void forget(const std::string& server, const std::string& key,
+            const std::string& n);
+
+    /**
+     * @brief Reads the messages sent since the last listing into the cached
+     *        listing, or all of them. The cached listing is used as it is
+     *        while it is fresh and not marked out of date.
+     * @param server Server URL.
+     * @param key API Key of Liquidfiles.
+     * @param[out] m Listing.
+     * @param s Report level.
+     * @param v Validate certificate flag for HTTP request.
+     * @param c Whether the cached messages are used, or all are read again.
+     * @throw curl_error, request_error, invalid_json.
+     */
+    void sync_messages(const std::string& server, const std::string& key,
+            metadata_cache::listing& m, report_level s, validate_cert v,
+            cache_use c);
     void download_impl(const std::string& url, const std::string& path, std::string name, report_level s);
     std::string get_filedrop_api_key(const std::string& url, report_level s, validate_cert v);
     void filedrop_attachments_impl(std::string server, const std::string& key,
@@ -387,21 +574,98 @@ private:
             const std::string& message, const strings& fs, report_level s);
 
 private:
-    std::string process_send_responce(std::string r, report_level s) const;
-    void process_attach_responce(const std::string& r, report_level s) const;
-    void process_attach_chunk_responce(const std::string& r, report_level s) const;
+    std::string process_send_responce(const std::string& r, report_level s) const;
+    void process_attach_responce(const std::string& f, const std::string& r,
+            report_level s) const;
+    void process_attach_chunk_responce(const std::string& f, const std::string& r,
+            report_level s) const;
     std::string process_file_request_responce(const std::string& r, report_level s) const;
     std::string process_get_api_key_responce(const std::string& r, report_level s) const;
     std::string process_create_filelink_responce(const std::string& r, report_level s) const;
     void process_filedrop_responce(const std::string& r, report_level s) const;
 
     template <typename T>
-    void process_output_responce(const std::string& r, report_level s, output_format f) const;
+    std::string process_output_responce(const std::string& r, output_format f) const;
+
+    /**
+     * @brief Performs the request by transport, reports the errors.
+     * @param q Request.
+     * @param h Handler of the responce.
+     * @param s Report level.
+     * @throw curl_error or exception of handler.
+     */
+    void perform(const http_request& q, responce_handler& h, report_level s);
+
+    /// @brief Performs the request and returns the whole responce.
+    std::string perform(const http_request& q, report_level s);
+
+    /// @brief Performs the request reporting the progress of transfer t.
+    std::string perform(const http_request& q, transfer t, report_level s);
+
+    /**
+     * @brief Performs the request and decodes the responce while it
+     *        arrives, without storing it.
+     * @param q Request.
+     * @param d Decoder of the responce.
+     * @param r Name of request, for error reporting.
+     * @param s Report level.
+     * @throw curl_error, request_error, invalid_json.
+     */
+    void perform(const http_request& q, listing_decoder& d, const std::string& r,
+            report_level s);
+
+    /**
+     * @brief Performs the request and writes the items of responce while
+     *        it arrives.
+     * @param q Request.
+     * @param p Writer of the items.
+     * @param r Name of request, for error reporting.
+     * @param s Report level.
+     * @throw curl_error, request_error, invalid_json.
+     */
+    void perform(const http_request& q, listing_passthrough& p, const std::string& r,
+            report_level s);
+
+    /**
+     * @brief Performs the listing request and returns its items, one per
+     *        line, as they are sent by server.
+     * @param q Request.
+     * @param n Name of the list member of responce.
+     * @param r Name of request, for error reporting.
+     * @param s Report level.
+     * @throw curl_error, request_error, invalid_json.
+     */
+    std::string fetch_listing(const http_request& q, const std::string& n,
+            const std::string& r, report_level s);
+
+    /**
+     * @brief Extracts single field from the json responce.
+     * @param r Extractor of responce, built once for all its fields.
+     * @param p Path of the field, e.g. "message.id".
+     * @param[out] v Value of the field.
+     * @param s Report level.
+     * @return false if responce has no such field.
+     * @throw invalid_json.
+     */
+    bool extract(const io::json_extractor& r, const std::string& p, std::string& v,
+            report_level s) const;
+
+private:
+    /// @brief Returns the event sink if s is at least l, null sink otherwise.
+    event_sink& events(report_level s, report_level l = report_level::normal) const;
 
-    std::string perform();
+    /// @brief Reports the given error to the event sink and throws it.
+    template <typename E>
+    [[noreturn]] void fail(report_level s, const E& e) const;
 
 private:
-    CURL* m_curl;
+    std::unique_ptr<transport> m_default_transport;
+    transport& m_transport;
+    event_sink& m_events;
+    metadata_cache* m_metadata;
+    std::string m_key;
+    validate_cert m_validate;
+    bool m_verbose;
 };
 
 }
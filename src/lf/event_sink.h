@@ -0,0 +1,136 @@
+#pragma once
+
+#include <base/exception.h>
+
+#include <string>
+
+namespace lf {
+
+/// @brief Kinds of file transfers reported by engine.
+enum class transfer {
+    upload,
+    upload_chunk,
+    download
+};
+
+/// @brief Kinds of requests reported by engine.
+enum class request {
+    send,
+    filedrop,
+    file_request,
+    get_api_key,
+    get_filedrop_api_key,
+    create_filelink,
+    delete_filelink,
+    list_filelinks,
+    delete_attachment,
+    delete_message_attachments,
+    get_message,
+    get_message_attachments,
+    list_messages
+};
+
+/**
+ * @class event_sink
+ * @brief Receiver of the events emitted by engine.
+ *
+ *        engine does not format any status text itself, it reports what is
+ *        happening to the event sink, which decides what to do with it.
+ *        All string arguments are only valid during the call.
+ */
+class event_sink
+{
+public:
+    virtual ~event_sink() = default;
+
+public:
+    /**
+     * @brief Called before the transfer of file starts.
+     * @param t Kind of transfer.
+     * @param name File name or path.
+     */
+    virtual void transfer_started(transfer t, const std::string& name) = 0;
+
+    /**
+     * @brief Called periodically during the transfer.
+     * @param t Kind of transfer.
+     * @param now Count of bytes transfered.
+     * @param total Whole count of bytes, 0 if unknown.
+     */
+    virtual void transfer_progress(transfer t, double now, double total) = 0;
+
+    /**
+     * @brief Called after the transfer is successfully finished.
+     * @param t Kind of transfer.
+     * @param name File name or path.
+     * @param id Id of uploaded file, empty for downloads and
+     *        intermediate chunks.
+     */
+    virtual void transfer_finished(transfer t, const std::string& name,
+            const std::string& id) = 0;
+
+    /**
+     * @brief Called before the request is sent to server.
+     * @param r Kind of request.
+     * @param subject Subject of request (user, id, etc.), can be empty.
+     */
+    virtual void request_started(request r, const std::string& subject) = 0;
+
+    /**
+     * @brief Called after the request is successfully completed.
+     * @param r Kind of request.
+     * @param result Result of request (id, url, key, etc.), can be empty.
+     */
+    virtual void request_completed(request r, const std::string& result) = 0;
+
+    /**
+     * @brief Called before the engine throws the given error.
+     * @param e Error.
+     */
+    virtual void error(const base::exception& e) = 0;
+
+    /// @brief Whether transfer_progress events are needed.
+    virtual bool wants_progress() const = 0;
+};
+
+/**
+ * @class null_event_sink
+ * @brief Event sink which ignores everything.
+ *
+ *        When it is used, engine does not install progress callback,
+ *        so the transfers are not slowed down by reporting.
+ */
+class null_event_sink final : public event_sink
+{
+public:
+    void transfer_started(transfer, const std::string&) override
+    {
+    }
+
+    void transfer_progress(transfer, double, double) override
+    {
+    }
+
+    void transfer_finished(transfer, const std::string&, const std::string&) override
+    {
+    }
+
+    void request_started(request, const std::string&) override
+    {
+    }
+
+    void request_completed(request, const std::string&) override
+    {
+    }
+
+    void error(const base::exception&) override
+    {
+    }
+
+    bool wants_progress() const override
+    {
+        return false;
+    }
+};
+
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <base/exception.h>
+#include <base/lf_string.h>
 
+#include <cstddef>
 #include <string>
 
 namespace lf {
@@ -51,4 +53,22 @@ public:
     }
 };
 
+class columns_error final : public base::exception
+{
+public:
+    columns_error(std::size_t n)
+        : base::exception{"Can't build the columns of " + base::to_string(n) + " cached messages.", 5}
+    {
+    }
+};
+
+class messages_not_sent final : public base::exception
+{
+public:
+    messages_not_sent(std::size_t f, std::size_t n)
+        : base::exception{base::to_string(f) + " of " + base::to_string(n) + " messages are not sent.", 3}
+    {
+    }
+};
+
 }
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <set>
+#include <string>
+
+namespace lf {
+
+/**
+ * @class file_list
+ * @brief Source of files to upload, read one by one.
+ *
+ *        engine uploads each file as soon as it is read, so lists of any
+ *        size can be sent without holding them in memory.
+ */
+class file_list
+{
+public:
+    virtual ~file_list() = default;
+
+public:
+    /**
+     * @brief Reads the next file.
+     * @param[out] f Path of file.
+     * @return false if there are no more files.
+     */
+    virtual bool next(std::string& f) = 0;
+};
+
+/**
+ * @class set_file_list
+ * @brief List of files held in the set.
+ */
+class set_file_list final : public file_list
+{
+public:
+    /// @param s Files, must outlive the list.
+    set_file_list(const std::set<std::string>& s)
+        : m_current{s.begin()}
+        , m_end{s.end()}
+    {
+    }
+
+    bool next(std::string& f) override
+    {
+        if (m_current == m_end) {
+            return false;
+        }
+        f = *m_current++;
+        return true;
+    }
+
+private:
+    std::set<std::string>::const_iterator m_current;
+    std::set<std::string>::const_iterator m_end;
+};
+
+}
@@ -1,7 +1,7 @@
 #include "filelinks_responce.h"
 
-#include <io/csv_stream.h>
-#include <io/table_printer.h>
+#include <cstdlib>
+#include <sstream>
 
 namespace lf {
 
@@ -19,45 +19,65 @@ void filelinks_responce::read(const nlohmann::json& j)
     }
 }
 
-std::string filelinks_responce::to_string(output_format f) const
+void filelinks_responce::decoder::begin_item()
+{
+    m_responce.m_links.emplace_back();
+}
+
+void filelinks_responce::decoder::item_value(const std::string& k, const std::string& v)
+{
+    set_value(m_responce.m_links.back(), k, v);
+}
+
+void filelinks_responce::set_value(link_item& r, const std::string& k, const std::string& v)
 {
-    if (m_links.empty()) {
-        return std::string();
+    if (k == "id") {
+        r.id = v;
+    } else if (k == "filename") {
+        r.filename = v;
+    } else if (k == "url") {
+        r.url = v;
+    } else if (k == "expires_at") {
+        r.expire_time = v;
+    } else if (k == "size") {
+        r.size = std::atoi(v.c_str());
     }
+}
+
+std::string filelinks_responce::to_string(output_format f) const
+{
     std::stringstream m;
-    switch (f) {
-    case output_format::csv:
-        write_csv(m);
-        break;
-    case output_format::table:
-        write_table(m);
-    default:
-        break;
-    }
+    write(m, f);
     return m.str();
 }
 
-void filelinks_responce::write_csv(std::stringstream& m) const
+void filelinks_responce::write(std::ostream& o, output_format f) const
 {
-    io::csv_ostream cp(&m);
+    record_writer w(o, f);
     for (const auto& l : m_links) {
-        cp << l.id << l.filename << l.size << l.expire_time.substr(0, 10) << l.url;
+        w.write(l);
     }
+    w.finish();
 }
 
-void filelinks_responce::write_table(std::stringstream& m) const
+void filelinks_responce::printer::begin_item()
 {
-    io::table_printer tp(&m);
-    tp.add_column("ID", 24);
-    tp.add_column("Filename", 30);
-    tp.add_column("Size", 8);
-    tp.add_column("Expire Date", 12);
-    tp.add_column("URL", 60);
-    tp.print_header();
-    for (const auto& l : m_links) {
-        tp << l.id << l.filename << l.size << l.expire_time.substr(0, 10) << l.url;
-        tp.print_footer();
-    }
+    // Strings keep their memory for the next items.
+    m_row.id.clear();
+    m_row.filename.clear();
+    m_row.url.clear();
+    m_row.expire_time.clear();
+    m_row.size = 0;
+}
+
+void filelinks_responce::printer::item_value(const std::string& k, const std::string& v)
+{
+    set_value(m_row, k, v);
+}
+
+void filelinks_responce::printer::end_item()
+{
+    m_writer.write(m_row);
 }
 
 }
@@ -1,9 +1,12 @@
 #pragma once
 
 #include "declarations.h"
+#include "listing_decoder.h"
+#include "record_writer.h"
 
 #include <io/json.h>
 
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -23,22 +26,95 @@ public:
      */
     void read(const nlohmann::json& j);
 
-public:
     /**
-     * @brief Gets the string representation of responce.
-     * @param f Output format.
+     * @class decoder
+     * @brief Fills filelinks_responce from json stream.
      */
-    std::string to_string(output_format f) const;
+    class decoder final : public listing_decoder
+    {
+    public:
+        /// @brief Constructor.
+        /// @param f Responce to fill.
+        decoder(filelinks_responce& f)
+            : listing_decoder{"links"}
+            , m_responce{f}
+        {
+        }
+
+    private:
+        void begin_item() override;
+        void item_value(const std::string& k, const std::string& v) override;
+
+    private:
+        filelinks_responce& m_responce;
+    };
 
 private:
     struct link_item {
+        /// @brief Declares the fields of filelink.
+        template <typename W>
+        void fields(W& w) const
+        {
+            w.field("id", "ID", 24, id);
+            w.field("filename", "Filename", 30, filename);
+            w.field("size", "Size", 8, size);
+            w.date("expires_at", "Expire Date", 12, expire_time);
+            w.field("url", "URL", 60, url);
+        }
+
         std::string id;
         std::string filename;
         std::string url;
         std::string expire_time;
-        int size;
+        int size = 0;
+    };
+
+public:
+    /**
+     * @class printer
+     * @brief Writes filelinks from json stream, each one as soon as it is
+     *        decoded, without storing them.
+     */
+    class printer final : public listing_decoder
+    {
+    public:
+        /// @brief Constructor.
+        /// @param o Stream to write.
+        /// @param f Output format.
+        printer(std::ostream& o, output_format f)
+            : listing_decoder{"links"}
+            , m_writer{o, f}
+        {
+        }
+
+    private:
+        void begin_item() override;
+        void item_value(const std::string& k, const std::string& v) override;
+        void end_item() override;
+
+    private:
+        record_writer m_writer;
+        link_item m_row;
     };
 
+public:
+    /**
+     * @brief Gets the string representation of responce.
+     * @param f Output format.
+     */
+    std::string to_string(output_format f) const;
+
+    /**
+     * @brief Writes the responce to stream.
+     * @param o Stream.
+     * @param f Output format.
+     */
+    void write(std::ostream& o, output_format f) const;
+
+private:
+    /// @brief Sets the field of filelink by its name in json.
+    static void set_value(link_item& r, const std::string& k, const std::string& v);
+
 public:
     using size_type = std::vector<link_item>::size_type;
 
@@ -48,10 +124,6 @@ public:
         return m_links.size();
     }
 
-private:
-    void write_csv(std::stringstream&) const;
-    void write_table(std::stringstream&) const;
-
 private:
     std::vector<link_item> m_links;
 };
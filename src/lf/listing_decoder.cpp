@@ -0,0 +1,91 @@
+#include "listing_decoder.h"
+
+namespace lf {
+
+namespace {
+
+constexpr unsigned s_root_depth = 1;
+constexpr unsigned s_list_depth = 2;
+constexpr unsigned s_item_depth = 3;
+constexpr unsigned s_item_array_depth = 4;
+
+}
+
+listing_decoder::listing_decoder(const std::string& l)
+    : m_list{l}
+    , m_depth{0}
+    , m_in_list{false}
+    , m_in_errors{false}
+    , m_in_item_array{false}
+{
+}
+
+void listing_decoder::begin_object()
+{
+    if (m_in_list && m_depth == s_list_depth) {
+        begin_item();
+    }
+    ++m_depth;
+}
+
+void listing_decoder::end_object()
+{
+    end_container();
+    if (m_in_list && m_depth == s_list_depth) {
+        end_item();
+    }
+}
+
+void listing_decoder::begin_array()
+{
+    if (m_depth == s_root_depth) {
+        m_in_list = m_key == m_list;
+        m_in_errors = m_key == "errors";
+    } else if (m_depth == s_item_depth) {
+        m_in_item_array = true;
+    }
+    ++m_depth;
+}
+
+void listing_decoder::end_array()
+{
+    end_container();
+}
+
+void listing_decoder::key(const std::string& k)
+{
+    if (m_depth == s_root_depth) {
+        m_key = k;
+    } else if (m_depth == s_item_depth) {
+        m_item_key = k;
+    }
+}
+
+void listing_decoder::value(io::json_value_type t, const std::string& v)
+{
+    if (m_in_list) {
+        if (m_depth == s_item_depth ||
+                (m_depth == s_item_array_depth && m_in_item_array)) {
+            item_value(m_item_key, v);
+        }
+        return;
+    }
+    if (m_error.empty() && t == io::json_value_type::string &&
+            ((m_in_errors && m_depth == s_list_depth) ||
+             (m_depth == s_root_depth && m_key == "errors"))) {
+        m_error = v;
+    }
+}
+
+void listing_decoder::end_container()
+{
+    --m_depth;
+    if (m_depth == s_root_depth) {
+        m_in_list = false;
+        m_in_errors = false;
+    } else if (m_depth == s_item_depth) {
+        m_in_item_array = false;
+    }
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <io/json_reader.h>
+
+#include <string>
+
+namespace lf {
+
+/**
+ * @class listing_decoder
+ * @brief Base class for decoding listing responces from json stream.
+ *
+ *        Listing responces have the form {"<list>": [{item}, ...]}.
+ *        listing_decoder tracks the position in the document and passes
+ *        the scalar fields of items (and elements of their array fields)
+ *        to the derived class, so items can be filled directly, without
+ *        building json document tree.
+ *        If the server responds by {"errors": [...]}, the first error is
+ *        stored and can be retrieved by error().
+ */
+class listing_decoder : public io::json_handler
+{
+public:
+    /// @brief Constructor.
+    /// @param l Name of the list member of root object.
+    listing_decoder(const std::string& l);
+
+public:
+    /// @brief Returns the error reported by server, empty if there is no.
+    const std::string& error() const
+    {
+        return m_error;
+    }
+
+protected:
+    /// @brief Called when the new item of list begins.
+    virtual void begin_item() = 0;
+
+    /**
+     * @brief Called for scalar fields of current item and for elements of
+     *        its array fields.
+     * @param k Name of the field.
+     * @param v Value of the field.
+     */
+    virtual void item_value(const std::string& k, const std::string& v) = 0;
+
+    /// @brief Called when the current item ends.
+    virtual void end_item()
+    {
+    }
+
+public:
+    void begin_object() override;
+    void end_object() override;
+    void begin_array() override;
+    void end_array() override;
+    void key(const std::string& k) override;
+    void value(io::json_value_type t, const std::string& v) override;
+
+private:
+    void end_container();
+
+private:
+    std::string m_list;
+    std::string m_key;
+    std::string m_item_key;
+    std::string m_error;
+    unsigned m_depth;
+    bool m_in_list;
+    bool m_in_errors;
+    bool m_in_item_array;
+};
+
+}
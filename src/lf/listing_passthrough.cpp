@@ -0,0 +1,65 @@
+#include "listing_passthrough.h"
+
+#include <io/exceptions.h>
+#include <io/json.h>
+
+namespace lf {
+
+listing_passthrough::listing_passthrough(const std::string& l, std::ostream& o,
+        output_format f)
+    : m_slicer{l, *this}
+    , m_output(o)
+    , m_array{f == output_format::json}
+    , m_empty{true}
+{
+}
+
+void listing_passthrough::data(const char* d, std::size_t n)
+{
+    m_slicer.feed(d, n);
+}
+
+void listing_passthrough::finish()
+{
+    m_slicer.finish();
+    if (!m_slicer.errors().empty()) {
+        nlohmann::json j;
+        try {
+            j = nlohmann::json::parse(m_slicer.errors());
+        } catch (const std::exception& e) {
+            throw io::invalid_json(e.what());
+        }
+        if (j.is_array() && !j.empty()) {
+            j = j[0];
+        }
+        if (j.is_string()) {
+            m_error = j.get<std::string>();
+            return;
+        }
+    }
+    if (m_array) {
+        m_output << (m_empty ? "[]\n" : "]\n");
+    }
+}
+
+void listing_passthrough::begin_element()
+{
+    if (m_array) {
+        m_output.put(m_empty ? '[' : ',');
+    }
+    m_empty = false;
+}
+
+void listing_passthrough::element_data(const char* d, std::size_t n)
+{
+    m_output.write(d, n);
+}
+
+void listing_passthrough::end_element()
+{
+    if (!m_array) {
+        m_output.put('\n');
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "declarations.h"
+#include "transport.h"
+
+#include <io/json_slicer.h>
+
+#include <ostream>
+#include <string>
+
+namespace lf {
+
+/**
+ * @class listing_passthrough
+ * @brief Writes the items of listing responce in json, as they are sent
+ *        by server.
+ *
+ *        Items are sliced from the responce while it arrives and written
+ *        to the stream with no decoding: as json array for
+ *        output_format::json, one item per line for output_format::ndjson.
+ *        If the server responds by {"errors": [...]}, the first error can
+ *        be retrieved by error() after finish().
+ */
+class listing_passthrough final : public responce_handler
+                                , private io::json_slice_handler
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param l Name of the list member of root object.
+     * @param o Stream to write.
+     * @param f Output format, json or ndjson.
+     */
+    listing_passthrough(const std::string& l, std::ostream& o, output_format f);
+
+public:
+    void data(const char* d, std::size_t n) override;
+
+    /**
+     * @brief Checks that the whole responce is read, closes the array.
+     * @throw io::invalid_json.
+     */
+    void finish();
+
+    /// @brief Returns the error reported by server, empty if there is no.
+    const std::string& error() const
+    {
+        return m_error;
+    }
+
+private:
+    void begin_element() override;
+    void element_data(const char* d, std::size_t n) override;
+    void end_element() override;
+
+private:
+    io::json_slicer m_slicer;
+    std::ostream& m_output;
+    std::string m_error;
+    bool m_array;
+    bool m_empty;
+};
+
+}
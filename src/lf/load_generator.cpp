@@ -0,0 +1,315 @@
+#include "load_generator.h"
+#include "engine.h"
+#include "event_sink.h"
+#include "exceptions.h"
+#include "messages_responce.h"
+
+#include <io/csv_stream.h>
+#include <io/table_printer.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lf {
+
+namespace {
+
+/// Latencies above one hour are recorded as one hour.
+constexpr std::uint64_t s_highest_latency = 3600ull * 1000 * 1000;
+
+const char* const s_subject = "liquidfiles bench";
+
+std::string format(const char* f, double v)
+{
+    char b[32];
+    std::snprintf(b, sizeof(b), f, v);
+    return b;
+}
+
+std::string milliseconds(std::uint64_t us)
+{
+    return format("%.2f", us / 1000.0);
+}
+
+/**
+ * @class temporary_directory
+ * @brief Directory for downloaded files, removed with its content.
+ */
+class temporary_directory final
+{
+public:
+    temporary_directory()
+    {
+        char p[] = "/tmp/liquidfiles_load_XXXXXX";
+        if (mkdtemp(p) == nullptr) {
+            throw file_error(p, std::strerror(errno));
+        }
+        m_path = p;
+    }
+
+    ~temporary_directory()
+    {
+        DIR* d = opendir(m_path.c_str());
+        if (d != nullptr) {
+            while (dirent* e = readdir(d)) {
+                if (std::strcmp(e->d_name, ".") != 0 && std::strcmp(e->d_name, "..") != 0) {
+                    unlink((m_path + "/" + e->d_name).c_str());
+                }
+            }
+            closedir(d);
+        }
+        rmdir(m_path.c_str());
+    }
+
+    temporary_directory(const temporary_directory&) = delete;
+    temporary_directory& operator=(const temporary_directory&) = delete;
+
+public:
+    const std::string& path() const
+    {
+        return m_path;
+    }
+
+private:
+    std::string m_path;
+};
+
+}
+
+std::string operation_name(operation o)
+{
+    switch (o) {
+    case operation::attach:
+        return "attach";
+    case operation::send:
+        return "send";
+    case operation::messages:
+        return "messages";
+    case operation::download:
+        return "download";
+    default:
+        break;
+    }
+    return "";
+}
+
+load_report::operation_stats::operation_stats()
+    : latency{s_highest_latency}
+    , errors{0}
+    , bytes{0}
+{
+}
+
+load_report::load_report(const std::map<operation, operation_stats>& s,
+        std::chrono::steady_clock::duration e)
+    : m_stats{s}
+    , m_seconds{std::chrono::duration<double>(e).count()}
+{
+    for (const auto& i : m_stats) {
+        m_total.latency.merge(i.second.latency);
+        m_total.errors += i.second.errors;
+        m_total.bytes += i.second.bytes;
+    }
+}
+
+std::string load_report::to_string(output_format f) const
+{
+    std::stringstream m;
+    switch (f) {
+    case output_format::csv:
+        write_csv(m);
+        break;
+    case output_format::table:
+        write_table(m);
+    default:
+        break;
+    }
+    return m.str();
+}
+
+std::string load_report::errors() const
+{
+    std::string r;
+    for (const auto& i : m_stats) {
+        if (!i.second.first_error.empty()) {
+            r += operation_name(i.first) + ": " + i.second.first_error + "\n";
+        }
+    }
+    return r;
+}
+
+load_report::row load_report::make_row(const std::string& n,
+        const operation_stats& s) const
+{
+    const base::hdr_histogram& h = s.latency;
+    double t = m_seconds > 0 ? m_seconds : 1;
+    row r;
+    r.name = n;
+    r.requests = std::to_string(h.count());
+    r.errors = std::to_string(s.errors);
+    r.rate = format("%.1f", h.count() / t);
+    r.throughput = format("%.2f", s.bytes / t / (1024 * 1024));
+    r.p50 = milliseconds(h.value_at_percentile(50));
+    r.p90 = milliseconds(h.value_at_percentile(90));
+    r.p99 = milliseconds(h.value_at_percentile(99));
+    r.p999 = milliseconds(h.value_at_percentile(99.9));
+    r.max = milliseconds(h.max());
+    return r;
+}
+
+void load_report::write_csv(std::stringstream& m) const
+{
+    io::csv_ostream cp(&m);
+    for (const auto& i : m_stats) {
+        row r = make_row(operation_name(i.first), i.second);
+        cp << r.name << r.requests << r.errors << r.rate << r.throughput
+            << r.p50 << r.p90 << r.p99 << r.p999 << r.max;
+        cp.end_row();
+    }
+}
+
+void load_report::write_table(std::stringstream& m) const
+{
+    io::table_printer tp(&m);
+    tp.add_column("Operation", 10);
+    tp.add_column("Requests", 9);
+    tp.add_column("Errors", 7);
+    tp.add_column("Req/s", 9);
+    tp.add_column("MB/s", 8);
+    tp.add_column("p50 ms", 9);
+    tp.add_column("p90 ms", 9);
+    tp.add_column("p99 ms", 9);
+    tp.add_column("p99.9 ms", 9);
+    tp.add_column("Max ms", 9);
+    tp.print_header();
+    for (const auto& i : m_stats) {
+        row r = make_row(operation_name(i.first), i.second);
+        tp << r.name << r.requests << r.errors << r.rate << r.throughput
+            << r.p50 << r.p90 << r.p99 << r.p999 << r.max;
+    }
+    if (m_stats.size() > 1) {
+        row r = make_row("total", m_total);
+        tp << r.name << r.requests << r.errors << r.rate << r.throughput
+            << r.p50 << r.p90 << r.p99 << r.p999 << r.max;
+    }
+    tp.print_footer();
+}
+
+load_generator::load_generator(const load_options& o)
+    : m_options{o}
+    , m_file_size{0}
+{
+    for (const auto& i : m_options.mix) {
+        if (i.second != 0) {
+            m_stats[i.first];
+        }
+    }
+}
+
+load_report load_generator::run()
+{
+    if (!m_options.file.empty()) {
+        struct stat b;
+        if (stat(m_options.file.c_str(), &b) != 0) {
+            throw file_error(m_options.file, std::strerror(errno));
+        }
+        m_file_size = b.st_size;
+    }
+    std::string id;
+    if (m_stats.count(operation::download) != 0) {
+        null_event_sink es;
+        engine e(es);
+        id = e.send(m_options.server, m_options.key, m_options.recipient, s_subject,
+                "", {m_options.file}, report_level::silent, m_options.validate);
+    }
+    std::vector<std::unique_ptr<temporary_directory>> ds;
+    for (unsigned i = 0; i < m_options.workers && !id.empty(); ++i) {
+        ds.emplace_back(new temporary_directory());
+    }
+    auto start = std::chrono::steady_clock::now();
+    m_deadline = start + m_options.duration;
+    std::vector<std::thread> ws;
+    for (unsigned i = 0; i < m_options.workers; ++i) {
+        ws.emplace_back(&load_generator::work, this, i, id,
+                ds.empty() ? std::string() : ds[i]->path());
+    }
+    for (auto& w : ws) {
+        w.join();
+    }
+    return load_report(m_stats, std::chrono::steady_clock::now() - start);
+}
+
+void load_generator::work(unsigned i, const std::string& id, const std::string& p)
+{
+    std::vector<operation> ops;
+    std::vector<unsigned> weights;
+    for (const auto& o : m_options.mix) {
+        if (o.second != 0) {
+            ops.push_back(o.first);
+            weights.push_back(o.second);
+        }
+    }
+    std::mt19937 g(i);
+    std::discrete_distribution<std::size_t> d(weights.begin(), weights.end());
+    null_event_sink es;
+    engine e(es);
+    const load_options& o = m_options;
+    const report_level s = report_level::silent;
+    while (std::chrono::steady_clock::now() < m_deadline) {
+        operation op = ops[d(g)];
+        std::string error;
+        std::uint64_t bytes = 0;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            switch (op) {
+            case operation::attach:
+                e.attach(o.server, o.key, {o.file}, s, o.validate);
+                bytes = m_file_size;
+                break;
+            case operation::send:
+                e.send(o.server, o.key, o.recipient, s_subject, "", {o.file}, s, o.validate);
+                bytes = m_file_size;
+                break;
+            case operation::messages: {
+                messages_responce m;
+                e.messages(o.server, o.key, "", "", m, s, o.validate);
+                break;
+            }
+            case operation::download:
+                e.download(o.server, o.key, p, id, s, o.validate);
+                bytes = m_file_size;
+                break;
+            }
+        } catch (const base::exception& x) {
+            error = x.message;
+        } catch (const std::exception& x) {
+            error = x.what();
+        }
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        std::lock_guard<std::mutex> l(m_mutex);
+        load_report::operation_stats& r = m_stats[op];
+        r.latency.record(us);
+        if (error.empty()) {
+            r.bytes += bytes;
+        } else {
+            if (r.errors == 0) {
+                r.first_error = error;
+            }
+            ++r.errors;
+        }
+    }
+}
+
+}
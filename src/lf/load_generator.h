@@ -0,0 +1,172 @@
+#pragma once
+
+#include "declarations.h"
+
+#include <base/hdr_histogram.h>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace lf {
+
+/// @brief Operations, which load_generator performs against the server.
+enum class operation {
+    attach,
+    send,
+    messages,
+    download
+};
+
+/// @brief Returns the name of operation.
+std::string operation_name(operation o);
+
+/**
+ * @struct load_options
+ * @brief Parameters of load generation.
+ */
+struct load_options
+{
+    /// @brief Server URL.
+    std::string server;
+
+    /// @brief API Key of Liquidfiles.
+    std::string key;
+
+    /// @brief Validate certificate flag for HTTP requests.
+    validate_cert validate = validate_cert::validate;
+
+    /// @brief File to upload by attach and send operations.
+    std::string file;
+
+    /// @brief Recipient of messages composed by send and download operations.
+    std::string recipient;
+
+    /// @brief Count of concurrent workers.
+    unsigned workers = 4;
+
+    /// @brief Duration of load.
+    std::chrono::seconds duration{10};
+
+    /// @brief Relative weights of operations, zero weights are skipped.
+    std::map<operation, unsigned> mix;
+};
+
+/**
+ * @class load_report
+ * @brief Throughput and latency percentiles of operations, measured by
+ *        load_generator.
+ */
+class load_report final
+{
+public:
+    /**
+     * @struct operation_stats
+     * @brief Measurements of single operation.
+     */
+    struct operation_stats
+    {
+        operation_stats();
+
+        /// @brief Latencies of finished requests, in microseconds.
+        base::hdr_histogram latency;
+
+        /// @brief Count of failed requests.
+        std::uint64_t errors;
+
+        /// @brief Count of transferred file bytes.
+        std::uint64_t bytes;
+
+        /// @brief Message of first failure.
+        std::string first_error;
+    };
+
+public:
+    /**
+     * @brief Constructor.
+     * @param s Measurements of operations.
+     * @param e Elapsed time of load.
+     */
+    load_report(const std::map<operation, operation_stats>& s,
+            std::chrono::steady_clock::duration e);
+
+public:
+    /**
+     * @brief Gets the string representation of report.
+     * @param f Output format.
+     */
+    std::string to_string(output_format f) const;
+
+    /// @brief Returns the messages of first failures of operations.
+    std::string errors() const;
+
+    /// @brief Returns the measurements of operations.
+    const std::map<operation, operation_stats>& stats() const
+    {
+        return m_stats;
+    }
+
+private:
+    struct row
+    {
+        std::string name;
+        std::string requests;
+        std::string errors;
+        std::string rate;
+        std::string throughput;
+        std::string p50;
+        std::string p90;
+        std::string p99;
+        std::string p999;
+        std::string max;
+    };
+
+    row make_row(const std::string& n, const operation_stats& s) const;
+    void write_csv(std::stringstream&) const;
+    void write_table(std::stringstream&) const;
+
+private:
+    std::map<operation, operation_stats> m_stats;
+    operation_stats m_total;
+    double m_seconds;
+};
+
+/**
+ * @class load_generator
+ * @brief Drives concurrent workers performing the configured mix of
+ *        operations against the server.
+ *
+ *        Each worker owns its engine and connection, picks operations
+ *        randomly by their weights and records the latency of each
+ *        request, until the duration expires.
+ */
+class load_generator final
+{
+public:
+    /// @brief Constructor.
+    /// @param o Parameters of load.
+    load_generator(const load_options& o);
+
+public:
+    /**
+     * @brief Runs the load and returns the measurements.
+     * @throw curl_error, request_error, file_error if the message for
+     *        download operation can not be prepared.
+     */
+    load_report run();
+
+private:
+    void work(unsigned i, const std::string& id, const std::string& p);
+
+private:
+    load_options m_options;
+    std::uint64_t m_file_size;
+    std::chrono::steady_clock::time_point m_deadline;
+    std::mutex m_mutex;
+    std::map<operation, load_report::operation_stats> m_stats;
+};
+
+}
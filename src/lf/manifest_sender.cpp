@@ -0,0 +1,127 @@
+#include "manifest_sender.h"
+#include "engine.h"
+#include "event_sink.h"
+#include "metadata_cache.h"
+
+#include <base/exception.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <thread>
+
+namespace lf {
+
+namespace {
+
+/**
+ * @struct upload
+ * @brief File of manifest, uploaded once.
+ */
+struct upload
+{
+    std::string file;
+    std::string id;
+    std::string error;
+};
+
+/// @brief Calls f, returns the message of its exception on one line, empty
+///        if it succeeds.
+template <typename F>
+std::string error_of(F f)
+{
+    std::string m;
+    try {
+        f();
+        return m;
+    } catch (const base::exception& e) {
+        m = e.message;
+    } catch (const std::exception& e) {
+        m = e.what();
+    }
+    std::replace(m.begin(), m.end(), '\n', ' ');
+    return m;
+}
+
+}
+
+manifest_sender::manifest_sender(const manifest_options& o)
+    : m_options{o}
+{
+}
+
+template <typename F>
+void manifest_sender::for_each(std::size_t n, F f)
+{
+    std::atomic<std::size_t> next{0};
+    auto work = [&] {
+        null_event_sink es;
+        engine e(es);
+        for (std::size_t i = next++; i < n; i = next++) {
+            f(e, i);
+        }
+    };
+    std::size_t c = std::min<std::size_t>(std::max(m_options.workers, 1u), n);
+    std::vector<std::thread> ws;
+    for (std::size_t i = 0; i < c; ++i) {
+        ws.emplace_back(work);
+    }
+    for (auto& w : ws) {
+        w.join();
+    }
+}
+
+std::vector<manifest_result> manifest_sender::run(const std::vector<manifest_entry>& es)
+{
+    const manifest_options& o = m_options;
+    const report_level s = report_level::silent;
+    std::vector<upload> us;
+    // Indexes of the uploads of every message.
+    std::vector<std::vector<std::size_t>> fs(es.size());
+    std::map<std::string, std::size_t> index;
+    for (std::size_t i = 0; i < es.size(); ++i) {
+        for (const auto& f : es[i].files) {
+            auto r = index.insert(std::make_pair(f, us.size()));
+            if (r.second) {
+                us.push_back(upload{f, "", ""});
+            }
+            fs[i].push_back(r.first->second);
+        }
+    }
+    for_each(us.size(), [&](engine& e, std::size_t i) {
+        upload& u = us[i];
+        u.error = error_of([&] {
+            u.id = e.upload(o.server, o.key, u.file, s, o.validate);
+        });
+    });
+    std::vector<manifest_result> rs(es.size());
+    for_each(es.size(), [&](engine& e, std::size_t i) {
+        const manifest_entry& m = es[i];
+        manifest_result& r = rs[i];
+        r.record = m.record;
+        r.recipient = m.to.names();
+        engine::strings ids(m.attachments.begin(), m.attachments.end());
+        for (std::size_t f : fs[i]) {
+            if (!us[f].error.empty()) {
+                r.error = "Can't upload '" + us[f].file + "'. " + us[f].error;
+                return;
+            }
+            ids.insert(us[f].id);
+        }
+        r.error = error_of([&] {
+            r.id = e.send_attachments(o.server, o.key, m.to, m.subject,
+                    m.message, ids, s, o.validate);
+        });
+    });
+    // Engines of workers have no cache, it is marked once by all messages.
+    bool sent = std::any_of(rs.begin(), rs.end(), [](const manifest_result& r) {
+        return !r.id.empty();
+    });
+    if (sent && o.metadata != nullptr) {
+        o.metadata->expire_listing(o.server, o.key, "messages");
+    }
+    return rs;
+}
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "declarations.h"
+#include "recipients.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace lf {
+
+class engine;
+class metadata_cache;
+
+/**
+ * @struct manifest_entry
+ * @brief Message of manifest, with the files to send by it.
+ */
+struct manifest_entry
+{
+    /// @brief Number of record in manifest, starting from 1.
+    unsigned record;
+
+    /// @brief Recipients of message.
+    recipients to;
+
+    /// @brief Subject of composed email.
+    std::string subject;
+
+    /// @brief Message body of email.
+    std::string message;
+
+    /// @brief Paths of files to send.
+    std::vector<std::string> files;
+
+    /// @brief IDs of uploaded files to send.
+    std::vector<std::string> attachments;
+};
+
+/**
+ * @struct manifest_result
+ * @brief Result of sending the message of manifest.
+ */
+struct manifest_result
+{
+    /// @brief Number of record in manifest.
+    unsigned record;
+
+    /// @brief Main recipients, separated by commas.
+    std::string recipient;
+
+    /// @brief ID of sent message, empty if it is not sent.
+    std::string id;
+
+    /// @brief Error of upload or send, empty if the message is sent.
+    std::string error;
+
+    template <typename W>
+    void fields(W& w) const
+    {
+        w.field("record", "Record", 8, record);
+        w.field("recipient", "To", 30, recipient);
+        w.field("id", "Message ID", 24, id);
+        w.field("error", "Error", 60, error);
+    }
+};
+
+/**
+ * @struct manifest_options
+ * @brief Parameters of sending the manifest.
+ */
+struct manifest_options
+{
+    /// @brief Server URL.
+    std::string server;
+
+    /// @brief API Key of Liquidfiles.
+    std::string key;
+
+    /// @brief Validate certificate flag for HTTP requests.
+    validate_cert validate = validate_cert::validate;
+
+    /// @brief Count of concurrent workers.
+    unsigned workers = 4;
+
+    /// @brief Cache of messages, marked out of date when messages are
+    ///        sent, or null.
+    metadata_cache* metadata = nullptr;
+};
+
+/**
+ * @class manifest_sender
+ * @brief Sends the messages of manifest, each with its own recipients,
+ *        subject, message and files.
+ *
+ *        Files are uploaded once however many messages send them, then
+ *        the messages are sent with the IDs of attachments. Both uploads
+ *        and messages are shared between concurrent workers, each worker
+ *        owns its engine and connection.
+ */
+class manifest_sender final
+{
+public:
+    /// @brief Constructor.
+    /// @param o Parameters of sending.
+    manifest_sender(const manifest_options& o);
+
+public:
+    /**
+     * @brief Sends the messages.
+     * @param es Messages of manifest.
+     * @return Results in the order of messages. Messages whose file is not
+     *         uploaded are not sent.
+     */
+    std::vector<manifest_result> run(const std::vector<manifest_entry>& es);
+
+private:
+    /// @brief Calls f(e, i) for every i below n by the workers, e is the
+    ///        engine of worker.
+    template <typename F>
+    void for_each(std::size_t n, F f);
+
+private:
+    manifest_options m_options;
+};
+
+}
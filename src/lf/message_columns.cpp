@@ -0,0 +1,378 @@
+#include "message_columns.h"
+
+#include <base/lf_string.h>
+#include <io/json_extractor.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace lf {
+
+namespace {
+
+const char s_magic[4] = {'L', 'F', 'M', 'C'};
+
+const std::uint32_t s_version = 2;
+
+enum column : std::size_t {
+    created_column,
+    bytes_column,
+    attachments_column,
+    senders_column,
+    recipient_offsets_column,
+    recipients_column,
+    id_offsets_column,
+    ids_column,
+    subject_offsets_column,
+    subjects_column,
+    address_offsets_column,
+    address_chars_column,
+    column_count
+};
+
+/**
+ * @struct header
+ * @brief Beginning of the data of columns.
+ */
+struct header
+{
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t messages;
+    std::int64_t synced;
+    std::uint64_t generation;
+    std::uint64_t addresses;
+
+    /// @brief Offsets of columns from the beginning of data, the last one
+    ///        is the end of data.
+    std::uint64_t columns[column_count + 1];
+};
+
+/// @brief Appends n values as column c, padded to 8 bytes.
+template <typename T>
+void append_column(std::string& d, header& h, column c, const T* v, std::size_t n)
+{
+    h.columns[c] = d.size();
+    d.append(reinterpret_cast<const char*>(v), n * sizeof(T));
+    d.append((8 - d.size() % 8) % 8, '\0');
+}
+
+/// @brief Appends the strings as offsets column o and characters column c.
+void append_strings(std::string& d, header& h, column o, column c,
+        const std::vector<std::string>& ss)
+{
+    std::vector<std::uint32_t> offsets(1, 0);
+    std::string chars;
+    for (const auto& s : ss) {
+        chars += s;
+        offsets.push_back(static_cast<std::uint32_t>(chars.size()));
+    }
+    append_column(d, h, o, offsets.data(), offsets.size());
+    append_column(d, h, c, chars.data(), chars.size());
+}
+
+/// @brief Returns the days since epoch of the date of Gregorian calendar.
+std::int64_t days_from_civil(std::int64_t y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<std::int64_t>(doe) - 719468;
+}
+
+/// @brief Dictionary of addresses, indexed in the order of appearance.
+class address_index final
+{
+public:
+    std::uint32_t add(const std::string& a)
+    {
+        auto r = m_index.insert(std::make_pair(a, static_cast<std::uint32_t>(m_addresses.size())));
+        if (r.second) {
+            m_addresses.push_back(a);
+        }
+        return r.first->second;
+    }
+
+    /// @brief Sorts the addresses, returns the new indexes by the old ones.
+    std::vector<std::uint32_t> sort()
+    {
+        std::vector<std::uint32_t> order(m_addresses.size());
+        for (std::uint32_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [this](std::uint32_t x, std::uint32_t y) {
+            return m_addresses[x] < m_addresses[y];
+        });
+        std::vector<std::uint32_t> r(order.size());
+        std::vector<std::string> s(order.size());
+        for (std::uint32_t i = 0; i < order.size(); ++i) {
+            r[order[i]] = i;
+            s[i] = std::move(m_addresses[order[i]]);
+        }
+        m_addresses = std::move(s);
+        return r;
+    }
+
+    const std::vector<std::string>& addresses() const
+    {
+        return m_addresses;
+    }
+
+private:
+    std::unordered_map<std::string, std::uint32_t> m_index;
+    std::vector<std::string> m_addresses;
+};
+
+/// @brief Checks that offsets are not decreasing and within the size of
+///        characters.
+bool valid_offsets(const std::uint32_t* o, std::size_t n, std::uint64_t s)
+{
+    if (o[0] != 0 || o[n] > s) {
+        return false;
+    }
+    bool v = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        v &= o[i] <= o[i + 1];
+    }
+    return v;
+}
+
+/// @brief Checks that the indexes of addresses are within dictionary.
+bool valid_addresses(const std::uint32_t* a, std::size_t n, std::uint64_t s)
+{
+    bool v = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        v &= a[i] < s;
+    }
+    return v;
+}
+
+}
+
+std::string message_columns::build(const metadata_cache::listing& l)
+{
+    std::size_t n = l.items.size();
+    std::vector<std::int64_t> created(n);
+    std::vector<std::uint64_t> bytes(n);
+    std::vector<std::uint32_t> attachments(n);
+    std::vector<std::uint32_t> senders(n);
+    std::vector<std::uint32_t> recipient_offsets(1, 0);
+    std::vector<std::uint32_t> recipients;
+    std::vector<std::string> ids(n);
+    std::vector<std::string> subjects(n);
+    address_index index;
+    std::string v;
+    for (std::size_t i = 0; i < n; ++i) {
+        const metadata_cache::item& m = l.items[i];
+        io::json_extractor x(m.json);
+        ids[i] = m.id;
+        created[i] = parse_time(m.created_at);
+        x.get("subject", subjects[i]);
+        v.clear();
+        x.get("sender", v);
+        senders[i] = index.add(v);
+        for (unsigned k = 0; x.get("recipients." + std::to_string(k), v); ++k) {
+            recipients.push_back(index.add(v));
+        }
+        recipient_offsets.push_back(static_cast<std::uint32_t>(recipients.size()));
+        for (unsigned k = 0; x.has("attachments." + std::to_string(k)); ++k) {
+            std::uint64_t s = 0;
+            if (x.get("attachments." + std::to_string(k) + ".size", v)) {
+                base::parse_integer(v.data(), v.data() + v.size(), s);
+            }
+            bytes[i] += s;
+            ++attachments[i];
+        }
+    }
+    std::vector<std::uint32_t> r = index.sort();
+    for (auto& a : senders) {
+        a = r[a];
+    }
+    for (auto& a : recipients) {
+        a = r[a];
+    }
+    header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, s_magic, sizeof(h.magic));
+    h.version = s_version;
+    h.messages = n;
+    h.synced = l.synced;
+    h.generation = l.generation;
+    h.addresses = index.addresses().size();
+    std::string d(sizeof(h), '\0');
+    append_column(d, h, created_column, created.data(), n);
+    append_column(d, h, bytes_column, bytes.data(), n);
+    append_column(d, h, attachments_column, attachments.data(), n);
+    append_column(d, h, senders_column, senders.data(), n);
+    append_column(d, h, recipient_offsets_column, recipient_offsets.data(), n + 1);
+    append_column(d, h, recipients_column, recipients.data(), recipients.size());
+    append_strings(d, h, id_offsets_column, ids_column, ids);
+    append_strings(d, h, subject_offsets_column, subjects_column, subjects);
+    append_strings(d, h, address_offsets_column, address_chars_column, index.addresses());
+    h.columns[column_count] = d.size();
+    std::memcpy(&d[0], &h, sizeof(h));
+    return d;
+}
+
+void message_columns::set_synced(std::string& d, std::int64_t t)
+{
+    if (d.size() >= sizeof(header)) {
+        std::memcpy(&d[offsetof(header, synced)], &t, sizeof(t));
+    }
+}
+
+std::int64_t message_columns::parse_time(const std::string& s)
+{
+    int y = 0;
+    unsigned mo = 0;
+    unsigned d = 0;
+    unsigned h = 0;
+    unsigned mi = 0;
+    unsigned se = 0;
+    int n = 0;
+    if (std::sscanf(s.c_str(), "%4d-%2u-%2uT%2u:%2u:%2u%n", &y, &mo, &d, &h, &mi, &se, &n) != 6
+            || mo < 1 || mo > 12) {
+        return 0;
+    }
+    std::int64_t t = days_from_civil(y, mo, d) * 86400 + h * 3600 + mi * 60 + se;
+    std::size_t p = static_cast<std::size_t>(n);
+    while (p < s.size() && (s[p] == '.' || (s[p] >= '0' && s[p] <= '9'))) {
+        ++p;
+    }
+    unsigned zh = 0;
+    unsigned zm = 0;
+    if (p < s.size() && (s[p] == '+' || s[p] == '-')
+            && std::sscanf(s.c_str() + p + 1, "%2u:%2u", &zh, &zm) == 2) {
+        std::int64_t z = (zh * 60 + zm) * 60;
+        t += s[p] == '+' ? -z : z;
+    }
+    return t;
+}
+
+message_columns::message_columns()
+    : m_created{nullptr}
+    , m_bytes{nullptr}
+    , m_attachments{nullptr}
+    , m_senders{nullptr}
+    , m_recipient_offsets{nullptr}
+    , m_recipients{nullptr}
+    , m_id_offsets{nullptr}
+    , m_ids{nullptr}
+    , m_subject_offsets{nullptr}
+    , m_subjects{nullptr}
+    , m_address_offsets{nullptr}
+    , m_address_chars{nullptr}
+    , m_size{0}
+    , m_addresses{0}
+    , m_synced{0}
+    , m_generation{0}
+{
+}
+
+bool message_columns::open(const char* d, std::size_t n)
+{
+    *this = message_columns();
+    header h;
+    if (d == nullptr || n < sizeof(h) || reinterpret_cast<std::uintptr_t>(d) % 8 != 0) {
+        return false;
+    }
+    std::memcpy(&h, d, sizeof(h));
+    if (std::memcmp(h.magic, s_magic, sizeof(h.magic)) != 0 || h.version != s_version
+            || h.columns[column_count] > n || h.messages > n || h.addresses > n) {
+        return false;
+    }
+    for (std::size_t c = 0; c < column_count; ++c) {
+        if (h.columns[c] < sizeof(h) || h.columns[c] % 8 != 0
+                || h.columns[c] > h.columns[c + 1]) {
+            return false;
+        }
+    }
+    auto size = [&h](column c) {
+        return h.columns[c + 1] - h.columns[c];
+    };
+    std::uint64_t m = h.messages;
+    std::uint64_t a = h.addresses;
+    if (size(created_column) < m * 8 || size(bytes_column) < m * 8
+            || size(attachments_column) < m * 4 || size(senders_column) < m * 4
+            || size(recipient_offsets_column) < (m + 1) * 4
+            || size(id_offsets_column) < (m + 1) * 4
+            || size(subject_offsets_column) < (m + 1) * 4
+            || size(address_offsets_column) < (a + 1) * 4) {
+        return false;
+    }
+    auto ints = [d, &h](column c) {
+        return reinterpret_cast<const std::uint32_t*>(d + h.columns[c]);
+    };
+    const std::uint32_t* ro = ints(recipient_offsets_column);
+    const std::uint32_t* is = ints(id_offsets_column);
+    const std::uint32_t* so = ints(subject_offsets_column);
+    const std::uint32_t* ao = ints(address_offsets_column);
+    if (!valid_offsets(ro, m, size(recipients_column) / 4)
+            || !valid_offsets(is, m, size(ids_column))
+            || !valid_offsets(so, m, size(subjects_column))
+            || !valid_offsets(ao, a, size(address_chars_column))
+            || !valid_addresses(ints(senders_column), m, a)
+            || !valid_addresses(ints(recipients_column), ro[m], a)) {
+        return false;
+    }
+    m_created = reinterpret_cast<const std::int64_t*>(d + h.columns[created_column]);
+    m_bytes = reinterpret_cast<const std::uint64_t*>(d + h.columns[bytes_column]);
+    m_attachments = ints(attachments_column);
+    m_senders = ints(senders_column);
+    m_recipient_offsets = ro;
+    m_recipients = ints(recipients_column);
+    m_id_offsets = is;
+    m_ids = d + h.columns[ids_column];
+    m_subject_offsets = so;
+    m_subjects = d + h.columns[subjects_column];
+    m_address_offsets = ao;
+    m_address_chars = d + h.columns[address_chars_column];
+    m_size = m;
+    m_addresses = a;
+    m_synced = h.synced;
+    m_generation = h.generation;
+    return true;
+}
+
+base::string_ref message_columns::id(std::size_t i) const
+{
+    return base::string_ref(m_ids + m_id_offsets[i], m_id_offsets[i + 1] - m_id_offsets[i]);
+}
+
+base::string_ref message_columns::subject(std::size_t i) const
+{
+    return base::string_ref(m_subjects + m_subject_offsets[i],
+            m_subject_offsets[i + 1] - m_subject_offsets[i]);
+}
+
+base::string_ref message_columns::address(std::uint32_t a) const
+{
+    return base::string_ref(m_address_chars + m_address_offsets[a],
+            m_address_offsets[a + 1] - m_address_offsets[a]);
+}
+
+std::uint32_t message_columns::find_address(const std::string& a) const
+{
+    // Addresses are sorted as std::string compares them.
+    std::uint32_t b = 0;
+    std::uint32_t e = static_cast<std::uint32_t>(m_addresses);
+    while (b < e) {
+        std::uint32_t m = b + (e - b) / 2;
+        base::string_ref x = address(m);
+        int c = std::char_traits<char>::compare(x.data(), a.data(), std::min(x.size(), a.size()));
+        if (c < 0 || (c == 0 && x.size() < a.size())) {
+            b = m + 1;
+        } else {
+            e = m;
+        }
+    }
+    return b < m_addresses && address(b) == base::string_ref(a.data(), a.size()) ? b : s_none;
+}
+
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "metadata_cache.h"
+
+#include <base/arena.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace lf {
+
+/**
+ * @class message_columns
+ * @brief Metadata of messages and their attachments stored by columns, in
+ *        one buffer which is written to file and mapped back as it is.
+ *
+ *        Creation times are seconds since epoch, sizes of attachments are
+ *        summed per message, senders and recipients are indexes in the
+ *        sorted dictionary of addresses. Strings are kept as offsets into
+ *        their characters. Numbers are in the byte order of machine, the
+ *        file is a local cache and is rebuilt if it does not open.
+ */
+class message_columns final
+{
+public:
+    /// @brief Index of address which is not in dictionary.
+    static const std::uint32_t s_none = 0xffffffff;
+
+    /**
+     * @brief Builds the columns of the cached messages.
+     * @param l Listing of messages.
+     * @return Data of columns, to store and open.
+     */
+    static std::string build(const metadata_cache::listing& l);
+
+    /// @brief Replaces the time of synchronization in data of columns, when
+    ///        the listing is synchronized with no changes.
+    static void set_synced(std::string& d, std::int64_t t);
+
+    /**
+     * @brief Parses the time as server writes it, e.g.
+     *        "2017-10-13T10:21:53.000Z", or with offset from UTC.
+     * @return Seconds since epoch, 0 if the time can't be parsed.
+     */
+    static std::int64_t parse_time(const std::string& s);
+
+public:
+    /// @brief Constructs empty columns.
+    message_columns();
+
+public:
+    /**
+     * @brief Opens the columns in data, checking their structure.
+     * @param d Data, aligned by 8 bytes, must outlive the columns.
+     * @param n Size of data.
+     * @return false if data are not valid columns of this version.
+     */
+    bool open(const char* d, std::size_t n);
+
+    /// @brief Returns the count of messages.
+    std::size_t size() const
+    {
+        return m_size;
+    }
+
+    /// @brief Returns the time of synchronization of the listing the
+    ///        columns are built from.
+    std::int64_t synced() const
+    {
+        return m_synced;
+    }
+
+    /// @brief Returns the generation of the listing the columns are built
+    ///        from.
+    std::uint64_t generation() const
+    {
+        return m_generation;
+    }
+
+    /// @brief Creation times of messages.
+    const std::int64_t* created() const
+    {
+        return m_created;
+    }
+
+    /// @brief Total sizes of the attachments of messages.
+    const std::uint64_t* bytes() const
+    {
+        return m_bytes;
+    }
+
+    /// @brief Counts of the attachments of messages.
+    const std::uint32_t* attachments() const
+    {
+        return m_attachments;
+    }
+
+    /// @brief Addresses of senders.
+    const std::uint32_t* senders() const
+    {
+        return m_senders;
+    }
+
+    /// @brief Returns the first recipient address of message i.
+    const std::uint32_t* recipients_begin(std::size_t i) const
+    {
+        return m_recipients + m_recipient_offsets[i];
+    }
+
+    /// @brief Returns the end of recipient addresses of message i.
+    const std::uint32_t* recipients_end(std::size_t i) const
+    {
+        return m_recipients + m_recipient_offsets[i + 1];
+    }
+
+    /// @brief Returns ID of message i.
+    base::string_ref id(std::size_t i) const;
+
+    /// @brief Returns subject of message i.
+    base::string_ref subject(std::size_t i) const;
+
+    /// @brief Returns the count of addresses in dictionary.
+    std::size_t addresses() const
+    {
+        return m_addresses;
+    }
+
+    /// @brief Returns the address by index.
+    base::string_ref address(std::uint32_t a) const;
+
+    /// @brief Finds the index of address, s_none if there is no such one.
+    std::uint32_t find_address(const std::string& a) const;
+
+private:
+    const std::int64_t* m_created;
+    const std::uint64_t* m_bytes;
+    const std::uint32_t* m_attachments;
+    const std::uint32_t* m_senders;
+    const std::uint32_t* m_recipient_offsets;
+    const std::uint32_t* m_recipients;
+    const std::uint32_t* m_id_offsets;
+    const char* m_ids;
+    const std::uint32_t* m_subject_offsets;
+    const char* m_subjects;
+    const std::uint32_t* m_address_offsets;
+    const char* m_address_chars;
+    std::size_t m_size;
+    std::size_t m_addresses;
+    std::int64_t m_synced;
+    std::uint64_t m_generation;
+};
+
+}
@@ -0,0 +1,192 @@
+#include "message_query.h"
+
+#include <algorithm>
+#include <ctime>
+#include <map>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace lf {
+
+namespace {
+
+constexpr std::int64_t s_day = 24 * 60 * 60;
+
+std::string utc_time(std::int64_t t, const char* f)
+{
+    std::time_t x = static_cast<std::time_t>(t);
+    std::tm m;
+    gmtime_r(&x, &m);
+    char b[32];
+    return std::string(b, std::strftime(b, sizeof(b), f, &m));
+}
+
+char lower(char c)
+{
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+/// @brief Clears the mask of messages whose address is not a.
+void match_address(const std::uint32_t* as, std::size_t n, std::uint32_t a, std::uint8_t* m)
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    // 16 addresses are compared at once, the results are packed to bytes
+    // of mask.
+    const __m128i x = _mm_set1_epi32(static_cast<int>(a));
+    const __m128i one = _mm_set1_epi8(1);
+    for (; i + 16 <= n; i += 16) {
+        const __m128i* p = reinterpret_cast<const __m128i*>(as + i);
+        __m128i e = _mm_packs_epi16(
+                _mm_packs_epi32(_mm_cmpeq_epi32(_mm_loadu_si128(p), x),
+                    _mm_cmpeq_epi32(_mm_loadu_si128(p + 1), x)),
+                _mm_packs_epi32(_mm_cmpeq_epi32(_mm_loadu_si128(p + 2), x),
+                    _mm_cmpeq_epi32(_mm_loadu_si128(p + 3), x)));
+        __m128i* q = reinterpret_cast<__m128i*>(m + i);
+        _mm_storeu_si128(q, _mm_and_si128(_mm_loadu_si128(q), _mm_and_si128(e, one)));
+    }
+#endif
+    for (; i < n; ++i) {
+        m[i] &= as[i] == a;
+    }
+}
+
+/// @brief Appends the indexes of the set bytes of mask.
+void collect(const std::uint8_t* m, std::size_t n, std::vector<std::uint32_t>& r)
+{
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    // Blocks of 16 unselected messages are skipped by one comparison.
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m + i));
+        unsigned b = ~_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero)) & 0xffff;
+        while (b != 0) {
+            r.push_back(static_cast<std::uint32_t>(i + __builtin_ctz(b)));
+            b &= b - 1;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (m[i] != 0) {
+            r.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+}
+
+/// @brief Checks whether s contains the lower case text t, ignoring case.
+bool contains(const base::string_ref& s, const std::string& t)
+{
+    return std::search(s.begin(), s.end(), t.begin(), t.end(), [](char x, char y) {
+        return lower(x) == y;
+    }) != s.end();
+}
+
+}
+
+message_query::message_query(const message_columns& c)
+    : m_columns(c)
+{
+}
+
+std::vector<std::uint32_t> message_query::select(const message_filter& f) const
+{
+    const message_columns& c = m_columns;
+    const std::uint32_t none = message_columns::s_none;
+    std::size_t n = c.size();
+    std::vector<std::uint32_t> r;
+    std::uint32_t sender = f.sender.empty() ? none : c.find_address(f.sender);
+    std::uint32_t recipient = f.recipient.empty() ? none : c.find_address(f.recipient);
+    if ((!f.sender.empty() && sender == none) || (!f.recipient.empty() && recipient == none)) {
+        return r;
+    }
+    std::vector<std::uint8_t> mask(n, 1);
+    std::uint8_t* m = mask.data();
+    // Loops of whole columns have no branches, so they are vectorized.
+    if (f.created_after != std::numeric_limits<std::int64_t>::min()) {
+        const std::int64_t* t = c.created();
+        const std::int64_t a = f.created_after;
+        for (std::size_t i = 0; i < n; ++i) {
+            m[i] &= t[i] >= a;
+        }
+    }
+    if (f.larger_than >= 0) {
+        const std::uint64_t* b = c.bytes();
+        const std::uint64_t l = static_cast<std::uint64_t>(f.larger_than);
+        for (std::size_t i = 0; i < n; ++i) {
+            m[i] &= b[i] > l;
+        }
+    }
+    if (sender != none) {
+        match_address(c.senders(), n, sender, m);
+    }
+    collect(m, n, r);
+    if (recipient == none && f.subject.empty()) {
+        return r;
+    }
+    std::string t(f.subject);
+    std::transform(t.begin(), t.end(), t.begin(), lower);
+    auto x = std::remove_if(r.begin(), r.end(), [&](std::uint32_t i) {
+        if (recipient != none && std::find(c.recipients_begin(i), c.recipients_end(i),
+                    recipient) == c.recipients_end(i)) {
+            return true;
+        }
+        return !t.empty() && !contains(c.subject(i), t);
+    });
+    r.erase(x, r.end());
+    return r;
+}
+
+message_row message_query::row(std::uint32_t i) const
+{
+    const message_columns& c = m_columns;
+    message_row r;
+    r.id = c.id(i);
+    r.sender = c.address(c.senders()[i]);
+    for (const std::uint32_t* a = c.recipients_begin(i); a != c.recipients_end(i); ++a) {
+        r.recipients.push_back(c.address(*a));
+    }
+    r.created_at = utc_time(c.created()[i], "%Y-%m-%dT%H:%M:%SZ");
+    r.attachments = c.attachments()[i];
+    r.bytes = c.bytes()[i];
+    r.subject = c.subject(i);
+    return r;
+}
+
+std::vector<group_row> message_query::group(const std::vector<std::uint32_t>& s,
+        query_group g) const
+{
+    const message_columns& c = m_columns;
+    std::vector<group_row> r;
+    if (g == query_group::sender) {
+        // Addresses are sorted, so are the groups.
+        std::vector<std::uint64_t> messages(c.addresses());
+        std::vector<std::uint64_t> bytes(c.addresses());
+        for (std::uint32_t i : s) {
+            ++messages[c.senders()[i]];
+            bytes[c.senders()[i]] += c.bytes()[i];
+        }
+        for (std::uint32_t a = 0; a < messages.size(); ++a) {
+            if (messages[a] != 0) {
+                r.push_back(group_row{"sender", "Sender", c.address(a).str(), messages[a], bytes[a]});
+            }
+        }
+    } else if (g == query_group::day) {
+        std::map<std::int64_t, std::pair<std::uint64_t, std::uint64_t>> days;
+        for (std::uint32_t i : s) {
+            std::int64_t t = c.created()[i];
+            auto& d = days[(t >= 0 ? t : t - s_day + 1) / s_day];
+            ++d.first;
+            d.second += c.bytes()[i];
+        }
+        for (const auto& d : days) {
+            r.push_back(group_row{"day", "Day", utc_time(d.first * s_day, "%Y-%m-%d"),
+                    d.second.first, d.second.second});
+        }
+    }
+    return r;
+}
+
+}
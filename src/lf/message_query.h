@@ -0,0 +1,132 @@
+#pragma once
+
+#include "message_columns.h"
+
+#include <base/arena.h>
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace lf {
+
+/**
+ * @struct message_filter
+ * @brief Conditions the queried messages meet, all of them.
+ */
+struct message_filter
+{
+    /// @brief Address of sender, any if empty.
+    std::string sender;
+
+    /// @brief Address of one of recipients, any if empty.
+    std::string recipient;
+
+    /// @brief Text the subject contains, ignoring case, any if empty.
+    std::string subject;
+
+    /// @brief Earliest creation time, in seconds since epoch.
+    std::int64_t created_after = std::numeric_limits<std::int64_t>::min();
+
+    /// @brief Total size of attachments the messages exceed, any if
+    ///        negative.
+    std::int64_t larger_than = -1;
+};
+
+enum class query_group {
+    none,
+    sender,
+    day
+};
+
+/**
+ * @struct message_row
+ * @brief Message selected by query.
+ */
+struct message_row
+{
+    base::string_ref id;
+    base::string_ref sender;
+    std::vector<base::string_ref> recipients;
+    std::string created_at;
+    std::uint32_t attachments;
+    std::uint64_t bytes;
+    base::string_ref subject;
+
+    template <typename W>
+    void fields(W& w) const
+    {
+        w.field("id", "ID", 24, id);
+        w.field("sender", "From", 30, sender);
+        w.list("recipients", "To", 30, recipients);
+        w.date("created_at", "Create Date", 12, created_at);
+        w.field("attachments", "Files", 6, attachments);
+        w.field("bytes", "Bytes", 14, bytes);
+        w.field("subject", "Subject", 40, subject);
+    }
+};
+
+/**
+ * @struct group_row
+ * @brief Count and total size of the selected messages of sender or day.
+ */
+struct group_row
+{
+    /// @brief Name of key in json, "sender" or "day".
+    const char* name;
+
+    /// @brief Title of key column.
+    const char* title;
+
+    std::string key;
+    std::uint64_t messages;
+    std::uint64_t bytes;
+
+    template <typename W>
+    void fields(W& w) const
+    {
+        w.field(name, title, 30, key);
+        w.field("messages", "Messages", 10, messages);
+        w.field("bytes", "Bytes", 16, bytes);
+    }
+};
+
+/**
+ * @class message_query
+ * @brief Evaluates filters and aggregates over the columns of messages.
+ *
+ *        Filters of numbers and addresses are scans of whole columns,
+ *        which narrow the mask of selected messages with no branches per
+ *        message; only the messages still selected are looked at by the
+ *        filters of recipients and subject.
+ */
+class message_query final
+{
+public:
+    /// @brief Constructor.
+    /// @param c Columns, must outlive the query.
+    explicit message_query(const message_columns& c);
+
+public:
+    /// @brief Returns the indexes of messages matching the filter, in the
+    ///        order of columns.
+    std::vector<std::uint32_t> select(const message_filter& f) const;
+
+    /// @brief Returns the message by index.
+    message_row row(std::uint32_t i) const;
+
+    /**
+     * @brief Counts the selected messages and sums their sizes by sender
+     *        or by day of creation, in UTC.
+     * @param s Indexes of selected messages.
+     * @param g Grouping, sender or day.
+     * @return Groups sorted by sender or day.
+     */
+    std::vector<group_row> group(const std::vector<std::uint32_t>& s, query_group g) const;
+
+private:
+    const message_columns& m_columns;
+};
+
+}
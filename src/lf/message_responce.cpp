@@ -1,32 +1,53 @@
 #include "message_responce.h"
 
-#include <io/csv_stream.h>
-#include <io/table_printer.h>
+#include <io/record_writers.h>
 
 #include <cstdlib>
 #include <sstream>
 
 namespace lf {
 
+namespace {
+
+void read_addresses(const nlohmann::json& j, base::arena& a, base::arena_strings& r)
+{
+    for (const auto& x : j) {
+        r.push_back(a.intern(x.get_ref<const std::string&>()));
+    }
+}
+
+}
+
+message_responce::message_responce()
+    : m_recipients{m_arena}
+    , m_ccs{m_arena}
+    , m_bccs{m_arena}
+    , m_authorization{0}
+{
+}
+
 void message_responce::read(const nlohmann::json& j)
 {
-    m_id = j["message"]["id"].get<std::string>();
-    m_sender = j["message"]["sender"].get<std::string>();
-    m_creation_time = j["message"]["created_at"].get<std::string>();
-    m_expire_time = j["message"]["expires_at"].get<std::string>();
-    m_authorization = j["message"]["authorization"].get<int>();
-    m_authorization_description = j["message"]["authorization_description"].get<std::string>();
-    m_subject = j["message"]["subject"].get<std::string>();
-    m_message = j["message"]["message"].get<std::string>();
-    m_recipients = j["message"]["recipients"].get<std::vector<std::string>>();
-    m_ccs = j["message"]["ccs"].get<std::vector<std::string>>();
-    if (j["message"].find("bccs") != j["message"].end()) {
-        m_bccs = j["message"]["bccs"].get<std::vector<std::string>>();
+    const nlohmann::json& m = j["message"];
+    m_id = m_arena.copy(m["id"].get_ref<const std::string&>());
+    m_sender = m_arena.intern(m["sender"].get_ref<const std::string&>());
+    m_creation_time = m_arena.copy(m["created_at"].get_ref<const std::string&>());
+    m_expire_time = m_arena.copy(m["expires_at"].get_ref<const std::string&>());
+    m_authorization = m["authorization"].get<int>();
+    m_authorization_description = m_arena.copy(
+            m["authorization_description"].get_ref<const std::string&>());
+    m_subject = m_arena.copy(m["subject"].get_ref<const std::string&>());
+    m_message = m_arena.copy(m["message"].get_ref<const std::string&>());
+    read_addresses(m["recipients"], m_arena, m_recipients);
+    read_addresses(m["ccs"], m_arena, m_ccs);
+    if (m.find("bccs") != m.end()) {
+        read_addresses(m["bccs"], m_arena, m_bccs);
     }
-    auto as = j["message"]["attachments"].get<std::vector<nlohmann::json>>();
+    const nlohmann::json& as = m["attachments"];
+    m_attachments.reserve(as.size());
     for (const auto& a : as) {
         m_attachments.emplace_back();
-        m_attachments.back().read(a);
+        m_attachments.back().read(a, m_arena);
     }
 }
 
@@ -35,102 +56,27 @@ std::string message_responce::to_string(output_format f) const
     std::stringstream m;
     switch (f) {
     case output_format::table:
-        write_table(m);
+    {
+        io::text_writer w;
+        w.write(*this);
+        m << w.str();
         break;
+    }
     case output_format::csv:
-        write_csv(m);
-    default:
+    {
+        io::csv_writer w(m);
+        w.write(*this);
         break;
     }
-    return m.str();
-}
-
-void message_responce::write_table(std::stringstream& m) const
-{
-    m << "ID: " << m_id << "\n";
-    m << "From: " << m_sender << "\n";
-    std::vector<std::string>::const_iterator i;
-    if (!m_recipients.empty()) {
-        m << "To: ";
-        i = m_recipients.begin();
-        m << *i++;
-        while (i != m_recipients.end()) {
-            m << ", " << *i++;
-        }
-        m << "\n";
-    }
-    if (!m_ccs.empty()) {
-        m << "CC: ";
-        i = m_ccs.begin();
-        m << *i++;
-        while (i != m_ccs.end()) {
-            m << ", " << *i++;
-        }
-        m << "\n";
-    }
-    if (!m_bccs.empty()) {
-        m << "BCC: ";
-        i = m_bccs.begin();
-        m << *i++;
-        while (i != m_bccs.end()) {
-            m << ", " << *i++;
-        }
-        m << "\n";
-    }
-    m << "Created At: " << m_creation_time << "\n";
-    m << "Expires At: " << m_expire_time << "\n";
-    m << "Authorization: " << m_authorization_description << "\n";
-    m << "Subject: " << m_subject << "\n";
-    m << "Message: " << m_message << "\n";
-    if (!m_attachments.empty()) {
-        m << "Attachments:\n";
-        io::table_printer tp(&m);
-        tp.add_column("N", 4);
-        tp.add_column("Attachment", 140);
-        tp.print_header();
-        std::vector<attachment_responce>::const_iterator j = m_attachments.begin();
-        int x = 1;
-        while (j != m_attachments.end()) {
-            tp << x++;
-            std::stringstream ss((j++)->to_string(output_format::table));
-            std::string s;
-            std::getline(ss, s);
-            tp << s;
-            while (std::getline(ss, s)) {
-                tp << " " << s;
-            }
-            tp.print_footer();
-        }
-    }
-}
-
-void message_responce::write_csv(std::stringstream& m) const
-{
-    io::csv_ostream cp(&m);
-    cp << m_id << m_sender;
-    std::vector<std::string>::const_iterator i;
-    i = m_recipients.begin();
-    cp << m_recipients.size();
-    while (i != m_recipients.end()) {
-        cp << *i++;
-    }
-    cp << m_ccs.size();
-    i = m_ccs.begin();
-    while (i != m_ccs.end()) {
-        cp << *i++;
-    }
-    i = m_bccs.begin();
-    cp << m_bccs.size();
-    while (i != m_bccs.end()) {
-        cp << *i++;
+    case output_format::json:
+    case output_format::ndjson:
+    {
+        io::json_writer w(m, true);
+        w.write(*this);
+        break;
     }
-    cp << m_creation_time << m_expire_time << m_authorization_description
-        << m_subject << m_message;
-    cp << m_attachments.size();
-    std::vector<attachment_responce>::const_iterator j = m_attachments.begin();
-    while (j != m_attachments.end()) {
-        m << ',' << (j++)->to_string(output_format::csv);
     }
+    return m.str();
 }
 
 }
@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 
+#include <base/arena.h>
 #include <io/json.h>
 
 namespace lf {
@@ -14,9 +15,17 @@ namespace lf {
  * @class message_responce
  * @brief Class for handling message responce from server and printing
  *        it for user.
+ *
+ *        Strings of message and its attachments are kept in the arena of
+ *        responce, addresses are interned.
  */
 class message_responce final
 {
+public:
+    message_responce();
+    message_responce(const message_responce&) = delete;
+    message_responce& operator=(const message_responce&) = delete;
+
 public:
     /**
      * @brief Generates message_responce from json object.
@@ -31,45 +40,62 @@ public:
      */
     std::string to_string(output_format f) const;
 
+    /// @brief Declares the fields of message.
+    template <typename W>
+    void fields(W& w) const
+    {
+        w.field("id", "ID", 24, m_id);
+        w.field("sender", "From", 30, m_sender);
+        w.list("recipients", "To", 30, m_recipients);
+        w.list("ccs", "CC", 30, m_ccs);
+        w.list("bccs", "BCC", 30, m_bccs);
+        w.date("created_at", "Created At", 24, m_creation_time);
+        w.date("expires_at", "Expires At", 24, m_expire_time);
+        w.field("authorization_description", "Authorization", 30, m_authorization_description);
+        w.field("subject", "Subject", 40, m_subject);
+        w.field("message", "Message", 60, m_message);
+        w.records("attachments", "Attachments", "Attachment", m_attachments);
+    }
+
 public:
     /// @brief Access to ID.
-    const std::string& id() const
+    const base::string_ref& id() const
     {
         return m_id;
     }
 
     /// @brief Access to sender.
-    const std::string& sender() const
+    const base::string_ref& sender() const
     {
         return m_sender;
     }
 
     /// @brief Access to recipients.
-    const std::vector<std::string>& recipients() const
+    const base::arena_strings& recipients() const
     {
         return m_recipients;
     }
 
     /// @brief Access to ccs.
-    const std::vector<std::string>& ccs() const
+    const base::arena_strings& ccs() const
     {
         return m_ccs;
     }
 
     /// @brief Access to bccs.
-    const std::vector<std::string>& bccs() const
+    const base::arena_strings& bccs() const
     {
         return m_bccs;
     }
 
     /// @brief Access to creation time.
-    const std::string& creation_time() const
+    const base::string_ref& creation_time() const
     {
         return m_creation_time;
     }
 
     /// @brief Access to expire time.
-    const std::string& expire_time() const
+    const base::string_ref& expire_time() const
     {
         return m_expire_time;
     }
@@ -81,19 +107,19 @@ public:
     }
 
     /// @brief Access to authorization description.
-    const std::string& authorization_description() const
+    const base::string_ref& authorization_description() const
     {
         return m_authorization_description;
     }
 
     /// @brief Access to subject.
-    const std::string& subject() const
+    const base::string_ref& subject() const
     {
         return m_subject;
     }
 
     /// @brief Access to message.
-    const std::string& message() const
+    const base::string_ref& message() const
     {
         return m_message;
     }
@@ -105,20 +131,17 @@ public:
     }
 
 private:
-    void write_table(std::stringstream&) const;
-    void write_csv(std::stringstream&) const;
-
-private:
-    std::string m_id;
-    std::string m_sender;
-    std::vector<std::string> m_recipients;
-    std::vector<std::string> m_ccs;
-    std::vector<std::string> m_bccs;
-    std::string m_creation_time;
-    std::string m_expire_time;
-    std::string m_authorization_description;
-    std::string m_subject;
-    std::string m_message;
+    base::arena m_arena;
+    base::string_ref m_id;
+    base::string_ref m_sender;
+    base::arena_strings m_recipients;
+    base::arena_strings m_ccs;
+    base::arena_strings m_bccs;
+    base::string_ref m_creation_time;
+    base::string_ref m_expire_time;
+    base::string_ref m_authorization_description;
+    base::string_ref m_subject;
+    base::string_ref m_message;
     std::vector<attachment_responce> m_attachments;
     int m_authorization;
 };
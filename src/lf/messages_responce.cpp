@@ -1,7 +1,7 @@
 #include "messages_responce.h"
 
-#include <io/csv_stream.h>
-#include <io/table_printer.h>
+#include <cstdlib>
+#include <sstream>
 
 namespace lf {
 
@@ -9,74 +9,100 @@ void messages_responce::read(const nlohmann::json& j)
 {
     auto ms = j["messages"].get<std::vector<nlohmann::json>>();
     for (const auto& mm : ms) {
-        m_messages.emplace_back();
+        m_messages.emplace_back(m_arena);
         message_item& r = m_messages.back();
-        r.m_id = mm["id"].get<std::string>();
-        r.m_sender = mm["sender"].get<std::string>();
-        r.m_recipients = mm["recipients"].get<std::vector<std::string>>();
-        r.m_creation_time = mm["created_at"].get<std::string>();
-        r.m_expire_time = mm["expires_at"].get<std::string>();
+        r.m_id = m_arena.copy(mm["id"].get_ref<const std::string&>());
+        r.m_sender = m_arena.intern(mm["sender"].get_ref<const std::string&>());
+        for (const auto& x : mm["recipients"]) {
+            r.m_recipients.push_back(m_arena.intern(x.get_ref<const std::string&>()));
+        }
+        r.m_creation_time = m_arena.copy(mm["created_at"].get_ref<const std::string&>());
+        r.m_expire_time = m_arena.intern(mm["expires_at"].get_ref<const std::string&>());
         r.m_authorization = mm["authorization"].get<int>();
-        r.m_authorization_description = mm["authorization_description"].get<std::string>();
-        r.m_subject = mm["subject"].get<std::string>();
+        r.m_authorization_description = m_arena.intern(
+                mm["authorization_description"].get_ref<const std::string&>());
+        r.m_subject = m_arena.copy(mm["subject"].get_ref<const std::string&>());
     }
 }
 
-std::string messages_responce::to_string(output_format f) const
+void messages_responce::decoder::begin_item()
+{
+    m_responce.m_messages.emplace_back(m_responce.m_arena);
+}
+
+void messages_responce::decoder::item_value(const std::string& k, const std::string& v)
 {
-    if (m_messages.empty()) {
-        return std::string();
+    message_item& r = m_responce.m_messages.back();
+    base::arena& a = m_responce.m_arena;
+    if (k == "id") {
+        r.m_id = a.copy(v);
+    } else if (k == "sender") {
+        r.m_sender = a.intern(v);
+    } else if (k == "recipients") {
+        r.m_recipients.push_back(a.intern(v));
+    } else if (k == "created_at") {
+        r.m_creation_time = a.copy(v);
+    } else if (k == "expires_at") {
+        r.m_expire_time = a.intern(v);
+    } else if (k == "authorization") {
+        r.m_authorization = std::atoi(v.c_str());
+    } else if (k == "authorization_description") {
+        r.m_authorization_description = a.intern(v);
+    } else if (k == "subject") {
+        r.m_subject = a.copy(v);
     }
+}
+
+std::string messages_responce::to_string(output_format f) const
+{
     std::stringstream m;
-    switch (f) {
-    case output_format::csv:
-        write_csv(m);
-        break;
-    case output_format::table:
-        write_table(m);
-    default:
-        break;
-    }
+    write(m, f);
     return m.str();
 }
 
-void messages_responce::write_csv(std::stringstream& m) const
+void messages_responce::write(std::ostream& o, output_format f) const
 {
-    io::csv_ostream cp(&m);
+    record_writer w(o, f);
     for (const auto& i : m_messages) {
-        cp << i.m_id << i.m_sender;
-        cp << i.m_recipients.size();
-        for (const auto& x : i.m_recipients) {
-            cp << x;
-        }
-        cp << i.m_creation_time << i.m_expire_time << i.m_authorization << i.m_subject;
+        w.write(i);
     }
+    w.finish();
 }
 
-void messages_responce::write_table(std::stringstream& m) const
+void messages_responce::printer::begin_item()
 {
-    io::table_printer tp(&m);
-    tp.add_column("ID", 24);
-    tp.add_column("From", 30);
-    tp.add_column("To", 30);
-    tp.add_column("Create Date", 12);
-    tp.add_column("Expire Date", 12);
-    tp.add_column("Auth", 5);
-    tp.add_column("Subject", 40);
-    tp.print_header();
-    for (const auto& i : m_messages) {
-        unsigned x = 0;
-        tp << i.m_id << i.m_sender;
-        if (x < i.m_recipients.size()) {
-            tp << i.m_recipients[x++];
-        }
-        tp << i.m_creation_time.substr(0, 10) << i.m_expire_time.substr(0, 10) << i.m_authorization <<
-            i.m_subject;
-        while (x < i.m_recipients.size()) {
-            tp << " " << " " << i.m_recipients[x++] << " " << " " << " " << " ";
-        }
-        tp.print_footer();
+    // Strings keep their memory for the next items.
+    m_row.m_id.clear();
+    m_row.m_sender.clear();
+    m_row.m_recipients.clear();
+    m_row.m_creation_time.clear();
+    m_row.m_expire_time.clear();
+    m_row.m_subject.clear();
+    m_row.m_authorization = 0;
+}
+
+void messages_responce::printer::item_value(const std::string& k, const std::string& v)
+{
+    if (k == "id") {
+        m_row.m_id = v;
+    } else if (k == "sender") {
+        m_row.m_sender = v;
+    } else if (k == "recipients") {
+        m_row.m_recipients.push_back(v);
+    } else if (k == "created_at") {
+        m_row.m_creation_time = v;
+    } else if (k == "expires_at") {
+        m_row.m_expire_time = v;
+    } else if (k == "authorization") {
+        m_row.m_authorization = std::atoi(v.c_str());
+    } else if (k == "subject") {
+        m_row.m_subject = v;
     }
 }
 
+void messages_responce::printer::end_item()
+{
+    m_writer.write(m_row);
+}
+
 }
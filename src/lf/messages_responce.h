@@ -1,9 +1,13 @@
 #pragma once
 
 #include "declarations.h"
+#include "listing_decoder.h"
+#include "record_writer.h"
 
+#include <base/arena.h>
 #include <io/json.h>
 
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -13,9 +17,17 @@ namespace lf {
  * @class messages_responce
  * @brief Class for handling messages responce from server and printing
  *        it for user.
+ *
+ *        Strings of messages are kept in the arena of responce, addresses
+ *        and other repeating fields are interned.
  */
 class messages_responce final
 {
+public:
+    messages_responce() = default;
+    messages_responce(const messages_responce&) = delete;
+    messages_responce& operator=(const messages_responce&) = delete;
+
 public:
     /**
      * @brief Generates messages_responce from json object.
@@ -23,6 +35,88 @@ public:
      */
     void read(const nlohmann::json& s);
 
+    /**
+     * @class decoder
+     * @brief Fills messages_responce from json stream.
+     */
+    class decoder final : public listing_decoder
+    {
+    public:
+        /// @brief Constructor.
+        /// @param m Responce to fill.
+        decoder(messages_responce& m)
+            : listing_decoder{"messages"}
+            , m_responce{m}
+        {
+        }
+
+    private:
+        void begin_item() override;
+        void item_value(const std::string& k, const std::string& v) override;
+
+    private:
+        messages_responce& m_responce;
+    };
+
+private:
+    /// @brief Declares the fields of message, M is message_item or
+    ///        printer::row.
+    template <typename M, typename W>
+    static void fields(const M& m, W& w)
+    {
+        w.field("id", "ID", 24, m.m_id);
+        w.field("sender", "From", 30, m.m_sender);
+        w.list("recipients", "To", 30, m.m_recipients);
+        w.date("created_at", "Create Date", 12, m.m_creation_time);
+        w.date("expires_at", "Expire Date", 12, m.m_expire_time);
+        w.field("authorization", "Auth", 5, m.m_authorization);
+        w.field("subject", "Subject", 40, m.m_subject);
+    }
+
+public:
+    /**
+     * @class printer
+     * @brief Writes messages from json stream, each one as soon as it is
+     *        decoded, without storing them.
+     */
+    class printer final : public listing_decoder
+    {
+    public:
+        /// @brief Constructor.
+        /// @param o Stream to write.
+        /// @param f Output format.
+        printer(std::ostream& o, output_format f)
+            : listing_decoder{"messages"}
+            , m_writer{o, f}
+        {
+        }
+
+    private:
+        void begin_item() override;
+        void item_value(const std::string& k, const std::string& v) override;
+        void end_item() override;
+
+    private:
+        struct row {
+            template <typename W>
+            void fields(W& w) const
+            {
+                messages_responce::fields(*this, w);
+            }
+
+            std::string m_id;
+            std::string m_sender;
+            std::vector<std::string> m_recipients;
+            std::string m_creation_time;
+            std::string m_expire_time;
+            std::string m_subject;
+            int m_authorization = 0;
+        };
+
+        record_writer m_writer;
+        row m_row;
+    };
+
 public:
     /**
      * @brief Gets the string representation of responce.
@@ -30,16 +124,34 @@ public:
      */
     std::string to_string(output_format f) const;
 
+    /**
+     * @brief Writes the responce to stream.
+     * @param o Stream.
+     * @param f Output format.
+     */
+    void write(std::ostream& o, output_format f) const;
+
 private:
     struct message_item {
-        std::string m_id;
-        std::string m_sender;
-        std::vector<std::string> m_recipients;
-        std::string m_creation_time;
-        std::string m_expire_time;
-        std::string m_authorization_description;
-        std::string m_subject;
-        int m_authorization;
+        message_item(base::arena& a)
+            : m_recipients{a}
+        {
+        }
+
+        template <typename W>
+        void fields(W& w) const
+        {
+            messages_responce::fields(*this, w);
+        }
+
+        base::string_ref m_id;
+        base::string_ref m_sender;
+        base::arena_strings m_recipients;
+        base::string_ref m_creation_time;
+        base::string_ref m_expire_time;
+        base::string_ref m_authorization_description;
+        base::string_ref m_subject;
+        int m_authorization = 0;
     };
 
 public:
@@ -57,14 +169,11 @@ public:
      */
     std::string id(size_type i)
     {
-        return m_messages[i].m_id;
+        return m_messages[i].m_id.str();
     }
 
 private:
-    void write_csv(std::stringstream&) const;
-    void write_table(std::stringstream&) const;
-
-private:
+    base::arena m_arena;
     std::vector<message_item> m_messages;
 };
 
@@ -0,0 +1,273 @@
+#include "metadata_cache.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace lf {
+
+namespace {
+
+/// @brief Written instead of empty fields, so the line keeps its columns.
+const char* const s_empty_field = "-";
+
+/// @brief Suffix of the file marking the listing as out of date.
+const char* const s_expired_suffix = ".expired";
+
+/// @brief Prefix of the files of message details.
+const char* const s_message_prefix = "message.";
+
+/// @brief Returns the name of directory of server and API key, FNV-1a hash
+///        of both.
+std::string account_name(const std::string& server, const std::string& key)
+{
+    std::uint64_t h = 14695981039346656037ULL;
+    auto add = [&h](const std::string& s) {
+        for (unsigned char c : s) {
+            h = (h ^ c) * 1099511628211ULL;
+        }
+    };
+    add(server);
+    add("\n");
+    add(key);
+    char b[17];
+    std::snprintf(b, sizeof(b), "%016llx", static_cast<unsigned long long>(h));
+    return b;
+}
+
+/// @brief Checks that id can be the part of file name.
+bool valid_id(const std::string& id)
+{
+    if (id.empty()) {
+        return false;
+    }
+    for (char c : id) {
+        bool a = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+            || (c >= 'A' && c <= 'Z') || c == '-' || c == '_';
+        if (!a) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief Checks that the field can be written as column of line.
+bool valid_field(const std::string& f)
+{
+    return f.find_first_of(" \n") == std::string::npos;
+}
+
+const std::string& field_or_empty(const std::string& f)
+{
+    static const std::string e = s_empty_field;
+    return f.empty() ? e : f;
+}
+
+bool read_file(const std::string& f, std::string& d)
+{
+    std::ifstream s(f.c_str(), std::ios::binary);
+    if (!s) {
+        return false;
+    }
+    std::ostringstream o;
+    o << s.rdbuf();
+    d = o.str();
+    return true;
+}
+
+}
+
+metadata_cache::metadata_cache(const std::string& d)
+    : m_directory{d}
+{
+}
+
+bool metadata_cache::find_listing(const std::string& server, const std::string& key,
+        const std::string& n, listing& l) const
+{
+    std::string d;
+    std::string p = path(server, key, n);
+    if (p.empty() || !read_file(p, d)) {
+        return false;
+    }
+    std::istringstream s(d);
+    int version = 0;
+    s >> version >> l.synced >> l.generation;
+    if (!s || version != m_serial_version) {
+        return false;
+    }
+    l.items.clear();
+    std::string::size_type b = d.find('\n');
+    while (b != std::string::npos && b + 1 < d.size()) {
+        ++b;
+        std::string::size_type e = d.find('\n', b);
+        if (e == std::string::npos) {
+            // The last line is written by the end of every item.
+            return false;
+        }
+        std::string::size_type i = d.find(' ', b);
+        std::string::size_type c = i == std::string::npos ? i : d.find(' ', i + 1);
+        if (c == std::string::npos || c >= e) {
+            return false;
+        }
+        item t;
+        t.id.assign(d, b, i - b);
+        t.created_at.assign(d, i + 1, c - i - 1);
+        t.json.assign(d, c + 1, e - c - 1);
+        if (t.id == s_empty_field) {
+            t.id.clear();
+        }
+        if (t.created_at == s_empty_field) {
+            t.created_at.clear();
+        }
+        l.items.push_back(std::move(t));
+        b = e;
+    }
+    return true;
+}
+
+void metadata_cache::store_listing(const std::string& server, const std::string& key,
+        const std::string& n, const listing& l)
+{
+    std::string d = std::to_string(m_serial_version) + ' ' + std::to_string(l.synced)
+        + ' ' + std::to_string(l.generation) + '\n';
+    for (const auto& i : l.items) {
+        if (!valid_field(i.id) || !valid_field(i.created_at)
+                || i.json.find('\n') != std::string::npos) {
+            // Not sliced from server responce, the listing is not kept.
+            remove_listing(server, key, n);
+            return;
+        }
+        d += field_or_empty(i.id);
+        d += ' ';
+        d += field_or_empty(i.created_at);
+        d += ' ';
+        d += i.json;
+        d += '\n';
+    }
+    store(server, key, n, d);
+}
+
+void metadata_cache::remove_listing(const std::string& server, const std::string& key,
+        const std::string& n)
+{
+    remove(server, key, n);
+}
+
+void metadata_cache::expire_listing(const std::string& server, const std::string& key,
+        const std::string& n)
+{
+    store(server, key, n + s_expired_suffix, "");
+}
+
+bool metadata_cache::listing_expired(const std::string& server, const std::string& key,
+        const std::string& n) const
+{
+    std::string p = path(server, key, n + s_expired_suffix);
+    struct stat st;
+    return !p.empty() && stat(p.c_str(), &st) == 0;
+}
+
+void metadata_cache::renew_listing(const std::string& server, const std::string& key,
+        const std::string& n)
+{
+    remove(server, key, n + s_expired_suffix);
+}
+
+bool metadata_cache::find_message(const std::string& server, const std::string& key,
+        const std::string& id, std::string& r) const
+{
+    if (!valid_id(id)) {
+        return false;
+    }
+    std::string p = path(server, key, s_message_prefix + id);
+    return !p.empty() && read_file(p, r) && !r.empty();
+}
+
+void metadata_cache::store_message(const std::string& server, const std::string& key,
+        const std::string& id, const std::string& r)
+{
+    if (valid_id(id)) {
+        store(server, key, s_message_prefix + id, r);
+    }
+}
+
+void metadata_cache::remove_message(const std::string& server, const std::string& key,
+        const std::string& id)
+{
+    if (valid_id(id)) {
+        remove(server, key, s_message_prefix + id);
+    }
+}
+
+void metadata_cache::remove_messages(const std::string& server, const std::string& key)
+{
+    std::string p = path(server, key, "");
+    DIR* d = p.empty() ? nullptr : opendir(p.c_str());
+    if (d == nullptr) {
+        return;
+    }
+    const std::string x = s_message_prefix;
+    while (dirent* e = readdir(d)) {
+        if (std::string(e->d_name).compare(0, x.size(), x) == 0) {
+            std::remove((p + e->d_name).c_str());
+        }
+    }
+    closedir(d);
+}
+
+std::string metadata_cache::path(const std::string& server, const std::string& key,
+        const std::string& n) const
+{
+    if (m_directory.empty()) {
+        return std::string();
+    }
+    return m_directory + account_name(server, key) + "/" + n;
+}
+
+void metadata_cache::store(const std::string& server, const std::string& key,
+        const std::string& n, const std::string& d)
+{
+    std::string p = path(server, key, n);
+    if (p.empty()) {
+        return;
+    }
+    std::string tmp = p + "." + std::to_string(getpid());
+    {
+        std::ofstream f(tmp.c_str(), std::ios::binary);
+        if (!f) {
+            // Creates the missing directories, from the user directory
+            // down to the one of account.
+            std::string::size_type s = m_directory.rfind('/', m_directory.size() - 2);
+            if (s == std::string::npos) {
+                s = m_directory.size() - 1;
+            }
+            for (; s != std::string::npos; s = p.find('/', s + 1)) {
+                mkdir(p.substr(0, s).c_str(), S_IRWXU);
+            }
+            f.open(tmp.c_str(), std::ios::binary);
+        }
+        f.write(d.data(), d.size());
+        if (!f) {
+            std::remove(tmp.c_str());
+            return;
+        }
+    }
+    if (std::rename(tmp.c_str(), p.c_str()) != 0) {
+        std::remove(tmp.c_str());
+    }
+}
+
+void metadata_cache::remove(const std::string& server, const std::string& key,
+        const std::string& n)
+{
+    std::string p = path(server, key, n);
+    if (!p.empty()) {
+        std::remove(p.c_str());
+    }
+}
+
+}
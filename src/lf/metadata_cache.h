@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lf {
+
+/**
+ * @class metadata_cache
+ * @brief Listings of messages and filelinks and details of messages,
+ *        kept in files between invocations.
+ *
+ *        Every server and API key has its own directory, named by the hash
+ *        of both. Listings are kept with the time they were synchronized
+ *        and their generation, each item as the json element sent by
+ *        server, on one line. Message
+ *        details are kept in a file per message, as the whole responce.
+ *
+ *        Files are replaced by rename, so concurrent invocations never read
+ *        them half written. Unreadable or old version files are ignored.
+ */
+class metadata_cache final
+{
+public:
+    /**
+     * @struct item
+     * @brief Element of listing.
+     */
+    struct item
+    {
+        /// @brief ID of message or filelink.
+        std::string id;
+
+        /// @brief Time of creation, as sent by server.
+        std::string created_at;
+
+        /// @brief Json element, as sent by server.
+        std::string json;
+    };
+
+    /**
+     * @struct listing
+     * @brief Cached listing.
+     */
+    struct listing
+    {
+        /// @brief Time of the last synchronization with server, in seconds
+        ///        since epoch.
+        std::int64_t synced = 0;
+
+        /// @brief Increases when items change, what is built from them
+        ///        keeps it to tell whether it is current. It is the time of
+        ///        change in microseconds, so it also differs after the
+        ///        listing is removed and read again.
+        std::uint64_t generation = 0;
+
+        /// @brief Elements, in the order of server.
+        std::vector<item> items;
+    };
+
+public:
+    /// @brief Constructor.
+    /// @param d Directory of cache, ending with '/', cache is not kept if
+    ///        empty.
+    metadata_cache(const std::string& d);
+
+    metadata_cache(const metadata_cache&) = delete;
+    metadata_cache& operator=(const metadata_cache&) = delete;
+
+public:
+    /**
+     * @brief Reads the cached listing.
+     * @param server Server URL.
+     * @param key API Key of Liquidfiles.
+     * @param n Name of listing, "messages" or "links".
+     * @param[out] l Listing.
+     * @return false if the listing is not cached.
+     */
+    bool find_listing(const std::string& server, const std::string& key,
+            const std::string& n, listing& l) const;
+
+    /// @brief Replaces the cached listing.
+    void store_listing(const std::string& server, const std::string& key,
+            const std::string& n, const listing& l);
+
+    /// @brief Removes the listing, so the next one is read from server.
+    void remove_listing(const std::string& server, const std::string& key,
+            const std::string& n);
+
+    /// @brief Marks the listing as out of date, e.g. when a message is sent,
+    ///        so it is synchronized when used next time.
+    void expire_listing(const std::string& server, const std::string& key,
+            const std::string& n);
+
+    /// @brief Checks whether the listing is marked by expire_listing.
+    bool listing_expired(const std::string& server, const std::string& key,
+            const std::string& n) const;
+
+    /// @brief Removes the mark of expire_listing, before the listing is
+    ///        synchronized.
+    void renew_listing(const std::string& server, const std::string& key,
+            const std::string& n);
+
+    /**
+     * @brief Reads the cached details of message.
+     * @param server Server URL.
+     * @param key API Key of Liquidfiles.
+     * @param id Message id.
+     * @param[out] r Responce of server.
+     * @return false if the message is not cached.
+     */
+    bool find_message(const std::string& server, const std::string& key,
+            const std::string& id, std::string& r) const;
+
+    /// @brief Stores the details of message.
+    void store_message(const std::string& server, const std::string& key,
+            const std::string& id, const std::string& r);
+
+    /// @brief Removes the details of message, e.g. when its attachments
+    ///        are deleted.
+    void remove_message(const std::string& server, const std::string& key,
+            const std::string& id);
+
+    /// @brief Removes the details of all messages of server and API key.
+    void remove_messages(const std::string& server, const std::string& key);
+
+    /**
+     * @brief Returns the path of file of server and API key.
+     * @param server Server URL.
+     * @param key API Key of Liquidfiles.
+     * @param n Name of file.
+     * @return Path, empty if cache is not kept.
+     */
+    std::string path(const std::string& server, const std::string& key,
+            const std::string& n) const;
+
+    /// @brief Replaces the file of server and API key by data d.
+    void store(const std::string& server, const std::string& key,
+            const std::string& n, const std::string& d);
+
+    /// @brief Removes the file of server and API key.
+    void remove(const std::string& server, const std::string& key,
+            const std::string& n);
+
+public:
+    static const int m_serial_version = 2;
+
+private:
+    std::string m_directory;
+};
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace lf {
+
+/**
+ * @struct recipients
+ * @brief Users to whom the message is sent, by their names or emails.
+ */
+struct recipients
+{
+    recipients() = default;
+
+    /// @brief Recipients of message to single user.
+    recipients(const std::string& u)
+        : to{u}
+    {
+    }
+
+    /// @brief Returns the main recipients separated by commas.
+    std::string names() const
+    {
+        std::string r;
+        for (const auto& u : to) {
+            if (!r.empty()) {
+                r += ", ";
+            }
+            r += u;
+        }
+        return r;
+    }
+
+    /// @brief Main recipients.
+    std::vector<std::string> to;
+
+    /// @brief Recipients of copies.
+    std::vector<std::string> cc;
+
+    /// @brief Recipients of hidden copies.
+    std::vector<std::string> bcc;
+};
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "declarations.h"
+
+#include <io/record_writers.h>
+
+#include <ostream>
+
+namespace lf {
+
+/**
+ * @class record_writer
+ * @brief Writes records of listing in the output format, record by
+ *        record. Records declare their fields as io/record_writers.h
+ *        describes.
+ */
+class record_writer final
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param o Stream to write.
+     * @param f Output format.
+     */
+    record_writer(std::ostream& o, output_format f)
+        : m_format{f}
+        , m_table{o}
+        , m_csv{o}
+        , m_json{o, f == output_format::ndjson}
+    {
+    }
+
+public:
+    /// @brief Writes the record.
+    template <typename R>
+    void write(const R& r)
+    {
+        switch (m_format) {
+        case output_format::table:
+            m_table.write(r);
+            break;
+        case output_format::csv:
+            m_csv.write(r);
+            break;
+        case output_format::json:
+        case output_format::ndjson:
+            m_json.write(r);
+            break;
+        }
+    }
+
+    /// @brief Ends the listing, after the last record.
+    void finish()
+    {
+        if (m_format == output_format::json || m_format == output_format::ndjson) {
+            m_json.finish();
+        }
+    }
+
+private:
+    output_format m_format;
+    io::table_writer m_table;
+    io::csv_writer m_csv;
+    io::json_writer m_json;
+};
+
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include "declarations.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace lf {
+
+/// @brief HTTP methods used by engine.
+enum class http_method {
+    get,
+    post,
+    delete_,
+    head
+};
+
+/**
+ * @struct form_field
+ * @brief Field of multipart/form-data request body.
+ */
+struct form_field
+{
+    /// @brief Name of field.
+    std::string name;
+
+    /// @brief Value of field, or path of file to upload if is_file.
+    std::string value;
+
+    /// @brief Whether the content of field is read from file.
+    bool is_file;
+};
+
+/**
+ * @struct http_request
+ * @brief Description of single request, independent of transport.
+ */
+struct http_request
+{
+    /// @brief Method, post requests have either body or form.
+    http_method method = http_method::get;
+
+    /// @brief Full URL.
+    std::string url;
+
+    /// @brief User of basic authentication, no authentication if empty.
+    std::string user;
+
+    /// @brief Password of basic authentication.
+    std::string password;
+
+    /// @brief Additional headers, e.g. "Content-Type: application/json".
+    std::vector<std::string> headers;
+
+    /// @brief Body of post request.
+    std::string body;
+
+    /// @brief Fields of multipart post request, used instead of body.
+    std::vector<form_field> form;
+
+    /// @brief Validate certificate flag.
+    validate_cert validate = validate_cert::validate;
+
+    /// @brief Whether the transport should log the exchange to stderr.
+    bool verbose = false;
+};
+
+/**
+ * @class responce_handler
+ * @brief Receiver of streamed responce.
+ */
+class responce_handler
+{
+public:
+    virtual ~responce_handler() = default;
+
+public:
+    /**
+     * @brief Called with every piece of responce body as it arrives.
+     *
+     *        Exception thrown from here aborts the transfer and is thrown
+     *        from transport::perform.
+     */
+    virtual void data(const char* d, std::size_t n) = 0;
+
+    /**
+     * @brief Called periodically during the transfer, if wants_progress.
+     * @param now Count of bytes transfered.
+     * @param total Whole count of bytes, 0 if unknown.
+     */
+    virtual void progress(double /*now*/, double /*total*/)
+    {
+    }
+
+    /// @brief Whether progress calls are needed.
+    virtual bool wants_progress() const
+    {
+        return false;
+    }
+};
+
+/**
+ * @class transport
+ * @brief Performs HTTP requests for engine.
+ *
+ *        engine describes requests and handles responces, transport
+ *        decides how to do the exchange with server, so other backends
+ *        (concurrent, replaying recorded responces, injecting faults) can
+ *        be used instead of the default curl_transport.
+ */
+class transport
+{
+public:
+    virtual ~transport() = default;
+
+public:
+    /**
+     * @brief Performs the request and streams the responce body to the
+     *        handler, returns after the whole responce is received.
+     * @param r Request.
+     * @param h Handler of responce.
+     * @throw curl_error if the exchange fails, or exception of handler.
+     */
+    virtual void perform(const http_request& r, responce_handler& h) = 0;
+
+    /**
+     * @brief Starts opening the connection to the server of request in
+     *        background, the next perform uses it. Errors are ignored, the
+     *        next perform reports them. Does nothing by default.
+     * @param r Request which opens the connection.
+     */
+    virtual void preconnect(const http_request& /*r*/)
+    {
+    }
+};
+
+}
@@ -1,9 +1,15 @@
+#include <base/exception.h>
+#include <base/filesystem.h>
+#include <base/trace.h>
 #include <cmd/command_processor.h>
-#include <io/messenger.h>
+#include <io/output.h>
+#include <lf/console_event_sink.h>
+#include <lf/dns_cache.h>
 #include <lf/engine.h>
-#include <ui/credentials.h>
+#include <lf/metadata_cache.h>
 #include <ui/attach_command.h>
 #include <ui/attach_chunk_command.h>
+#include <ui/bench_command.h>
 #include <ui/delete_attachments_command.h>
 #include <ui/delete_filelink_command.h>
 #include <ui/download_command.h>
@@ -14,28 +20,118 @@
 #include <ui/get_api_key_command.h>
 #include <ui/help_command.h>
 #include <ui/messages_command.h>
+#include <ui/query_command.h>
 #include <ui/send_command.h>
+#include <ui/send_manifest_command.h>
 
+#include <cstdio>
+#include <cstring>
+#include <iterator>
 #include <string>
+#include <vector>
+
+namespace {
+
+const std::string s_trace_option = "--trace=";
+
+/**
+ * @brief Removes --trace=<file> option, which is accepted by all commands,
+ *        from arguments.
+ * @return Name of trace file, empty if tracing is not requested.
+ */
+std::string take_trace_option(std::vector<std::string>& args)
+{
+    std::string f;
+    std::vector<std::string>::iterator i = args.begin();
+    while (i != args.end()) {
+        if (i->compare(0, s_trace_option.size(), s_trace_option) == 0) {
+            f = i->substr(s_trace_option.size());
+            i = args.erase(i);
+        } else {
+            ++i;
+        }
+    }
+    return f;
+}
+
+/// @brief Returns the directory of utility in user directory, empty if it is
+///        unknown.
+const std::string& user_directory()
+{
+    static std::string d = base::filesystem::user_directory();
+    return d;
+}
+
+/// @brief Returns the cache of messages and filelinks, created on first use.
+lf::metadata_cache& metadata()
+{
+    const std::string& d = user_directory();
+    static lf::metadata_cache mc(d.empty() ? d : d + "metadata/");
+    return mc;
+}
+
+/// @brief Returns the engine shared by commands, created on first use.
+lf::engine& engine()
+{
+    static lf::console_event_sink es(io::mout);
+    const std::string& d = user_directory();
+    static lf::dns_cache dc(d.empty() ? d : d + "dns_cache");
+    static lf::engine e(es, &dc, &metadata());
+    return e;
+}
+
+template <typename C>
+cmd::command* create(cmd::command_processor&)
+{
+    return new C(engine());
+}
+
+cmd::command* create_bench(cmd::command_processor&)
+{
+    return new ui::bench_command();
+}
+
+cmd::command* create_send_manifest(cmd::command_processor&)
+{
+    return new ui::send_manifest_command(&metadata());
+}
+
+cmd::command* create_help(cmd::command_processor& p)
+{
+    return new ui::help_command(p);
+}
+
+// Only the invoked command is created, so the startup does not grow with
+// the count of commands.
+const cmd::command_entry s_commands[] = {
+    {"attach", &create<ui::attach_command>},
+    {"attach_chunk", &create<ui::attach_chunk_command>},
+    {"bench", &create_bench},
+    {"delete_attachments", &create<ui::delete_attachments_command>},
+    {"delete_filelink", &create<ui::delete_filelink_command>},
+    {"download", &create<ui::download_command>},
+    {"file_request", &create<ui::file_request_command>},
+    {"filedrop", &create<ui::filedrop_command>},
+    {"filelink", &create<ui::filelink_command>},
+    {"filelinks", &create<ui::filelinks_command>},
+    {"get_api_key", &create<ui::get_api_key_command>},
+    {"help", &create_help},
+    {"messages", &create<ui::messages_command>},
+    {"query", &create<ui::query_command>},
+    {"send", &create<ui::send_command>},
+    {"send_manifest", &create_send_manifest}
+};
+
+}
 
 int main(int argc, char** argv)
 {
-    lf::engine e;
+    if (argc == 2 && std::strcmp(argv[1], "--version") == 0) {
+        std::fputs("liquidfiles " PACKAGE_VERSION "\n", stdout);
+        return 0;
+    }
     cmd::command_processor p(io::mout);
-    ui::credentials::init();
-    p.register_command(new ui::attach_command(e));
-    p.register_command(new ui::attach_chunk_command(e));
-    p.register_command(new ui::delete_attachments_command(e));
-    p.register_command(new ui::delete_filelink_command(e));
-    p.register_command(new ui::download_command(e));
-    p.register_command(new ui::file_request_command(e));
-    p.register_command(new ui::filedrop_command(e));
-    p.register_command(new ui::filelink_command(e));
-    p.register_command(new ui::filelinks_command(e));
-    p.register_command(new ui::get_api_key_command(e));
-    p.register_command(new ui::help_command(p));
-    p.register_command(new ui::messages_command(e));
-    p.register_command(new ui::send_command(e));
+    p.register_commands(std::begin(s_commands), std::end(s_commands));
 
     if (argc == 1) {
         p.execute("help");
@@ -47,5 +143,22 @@ int main(int argc, char** argv)
     for (int i = 2; i < argc; ++i) {
         args.push_back(argv[i]);
     }
-    return p.execute(c, args);
+    std::string trace_file = take_trace_option(args);
+    if (trace_file.empty()) {
+        return p.execute(c, std::move(args));
+    }
+    base::trace::start();
+    int r = 0;
+    {
+        base::trace_span t("command", "execute");
+        t.arg("command", c);
+        r = p.execute(c, std::move(args));
+    }
+    try {
+        base::trace::write(trace_file);
+    } catch (const base::exception& e) {
+        io::mout << "Error: " << e.message << io::endl;
+        return r == 0 ? e.code : r;
+    }
+    return r;
 }
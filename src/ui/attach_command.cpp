@@ -1,6 +1,7 @@
 #include "attach_command.h"
 #include "credentials.h"
 #include "common_arguments.h"
+#include "files_from.h"
 
 #include <cmd/exceptions.h>
 #include <lf/declarations.h>
@@ -15,6 +16,7 @@ attach_command::attach_command(lf::engine& e)
 {
     arguments.push_back(credentials::get_arguments());
     arguments.push_back(s_report_level_arg);
+    arguments.push_back(s_files_from_arg);
     arguments.push_back(m_files_argument);
 }
 
@@ -22,8 +24,22 @@ void attach_command::execute(const cmd::arguments& args)
 {
     credentials c = credentials::manage(args);
     lf::report_level rl = s_report_level_arg.value(args);
+    std::string list = s_files_from_arg.value(args);
     std::set<std::string> unnamed_args = m_files_argument.value(args);
-    m_engine.attach(c.server(), c.api_key(), unnamed_args, rl, c.validate_flag());
+    if (list.empty()) {
+        if (unnamed_args.empty()) {
+            throw cmd::missing_argument(m_files_argument.type_string());
+        }
+        m_engine.attach(c.server(), c.api_key(), unnamed_args, rl, c.validate_flag());
+        return;
+    }
+    if (list == files_from::s_standard_input) {
+        m_engine.preconnect(c.server(), rl, c.validate_flag());
+    }
+    lf::set_file_list u(unnamed_args);
+    files_from l(list);
+    joined_files fs(u, l);
+    m_engine.attach(c.server(), c.api_key(), fs, rl, c.validate_flag());
 }
 
 }
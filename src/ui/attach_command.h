@@ -25,7 +25,7 @@ public:
 
 private:
     lf::engine& m_engine;
-    cmd::argument_definition<std::string, cmd::argument_name_type::unnamed, true> m_files_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::unnamed, false> m_files_argument;
 };
 
 }
@@ -0,0 +1,120 @@
+#include "bench_command.h"
+#include "common_arguments.h"
+#include "credentials.h"
+
+#include <cmd/exceptions.h>
+#include <io/output.h>
+#include <lf/declarations.h>
+#include <lf/load_generator.h>
+
+#include <cstdlib>
+
+namespace ui {
+
+namespace {
+
+lf::operation parse_operation(const std::string& n)
+{
+    for (lf::operation o : {lf::operation::attach, lf::operation::send,
+            lf::operation::messages, lf::operation::download}) {
+        if (lf::operation_name(o) == n) {
+            return o;
+        }
+    }
+    throw cmd::invalid_argument_value("--mix", "attach, send, messages, download");
+}
+
+std::map<lf::operation, unsigned> parse_mix(const std::string& m)
+{
+    std::map<lf::operation, unsigned> r;
+    std::string::size_type b = 0;
+    while (b < m.size()) {
+        std::string::size_type e = m.find(',', b);
+        if (e == std::string::npos) {
+            e = m.size();
+        }
+        std::string i = m.substr(b, e - b);
+        std::string::size_type c = i.find(':');
+        unsigned w = 1;
+        if (c != std::string::npos) {
+            char* end = nullptr;
+            long v = std::strtol(i.c_str() + c + 1, &end, 10);
+            if (*end != '\0' || end == i.c_str() + c + 1 || v < 0) {
+                throw cmd::invalid_arguments("Invalid weight in '--mix': " + i);
+            }
+            w = static_cast<unsigned>(v);
+            i.erase(c);
+        }
+        r[parse_operation(i)] += w;
+        b = e + 1;
+    }
+    return r;
+}
+
+}
+
+bench_command::bench_command()
+    : cmd::command{"bench", "Generates load on the server and reports throughput and latency percentiles."}
+    , m_workers_argument{"workers", "<count>", "Count of concurrent workers.", 4}
+    , m_duration_argument{"duration", "<seconds>", "Duration of load.", 10}
+    , m_mix_argument{"mix", "<op:weight,...>", "Operations with their relative weights, "
+            "operations are attach, send, messages and download.", "messages:1"}
+    , m_file_argument{"file", "<path>", "File to upload by attach and send, and to download. Required by attach, send and download."}
+    , m_to_argument{"to", "<username>", "User name or email, to send file by send and download. Required by send and download."}
+{
+    arguments.push_back(credentials::get_arguments());
+    arguments.push_back(s_output_format_arg);
+    arguments.push_back(m_workers_argument);
+    arguments.push_back(m_duration_argument);
+    arguments.push_back(m_mix_argument);
+    arguments.push_back(m_file_argument);
+    arguments.push_back(m_to_argument);
+}
+
+void bench_command::execute(const cmd::arguments& args)
+{
+    credentials c = credentials::manage(args);
+    lf::output_format of = s_output_format_arg.value(args);
+    if (of != lf::output_format::table && of != lf::output_format::csv) {
+        throw cmd::invalid_arguments("Only table and csv values of '--output_format' are supported by bench.");
+    }
+    lf::load_options o;
+    o.server = c.server();
+    o.key = c.api_key();
+    o.validate = c.validate_flag();
+    o.file = m_file_argument.value(args);
+    o.recipient = m_to_argument.value(args);
+    int w = m_workers_argument.value(args);
+    int d = m_duration_argument.value(args);
+    if (w <= 0) {
+        throw cmd::invalid_arguments(m_workers_argument.name() + " must be positive.");
+    }
+    if (d <= 0) {
+        throw cmd::invalid_arguments(m_duration_argument.name() + " must be positive.");
+    }
+    o.workers = w;
+    o.duration = std::chrono::seconds(d);
+    o.mix = parse_mix(m_mix_argument.value(args));
+    bool any = false;
+    for (const auto& i : o.mix) {
+        if (i.second == 0) {
+            continue;
+        }
+        any = true;
+        if (i.first != lf::operation::messages && o.file.empty()) {
+            throw cmd::missing_argument(m_file_argument.name());
+        }
+        if ((i.first == lf::operation::send || i.first == lf::operation::download)
+                && o.recipient.empty()) {
+            throw cmd::missing_argument(m_to_argument.name());
+        }
+    }
+    if (!any) {
+        throw cmd::invalid_arguments("At least one operation in '--mix' must have positive weight.");
+    }
+    lf::load_report r = lf::load_generator(o).run();
+    io::mout << r.to_string(of);
+    io::mout << r.errors();
+}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cmd/command.h>
+
+namespace ui {
+
+/**
+ * @class bench_command.
+ * @brief Class for 'bench' command.
+ */
+class bench_command final : public cmd::command
+{
+public:
+    /// @brief Constructor.
+    bench_command();
+
+public:
+    /// @brief Executes command by given arguments.
+    void execute(const cmd::arguments& args) override;
+
+private:
+    cmd::argument_definition<int, cmd::argument_name_type::named, false> m_workers_argument;
+    cmd::argument_definition<int, cmd::argument_name_type::named, false> m_duration_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_mix_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_file_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_to_argument;
+};
+
+}
@@ -11,4 +11,13 @@ cmd::argument_definition<lf::output_format, cmd::argument_name_type::named, fals
 cmd::argument_definition<bool, cmd::argument_name_type::boolean, false>  s_attachment_argument
     ("r", "If specified, it means that unnamed arguments are attachment IDs,"
      " otherwise they are file paths.");
+
+cmd::argument_definition<std::string, cmd::argument_name_type::named, false> s_files_from_arg
+    ("files_from", "<file>", "Reads the list of files to upload from given file, '-' reads it from\n"
+     "\t    standard input. Paths are separated by newlines, or by NUL characters if\n"
+     "\t    the list contains any. Files are uploaded while the list is read.", "");
+
+cmd::argument_definition<bool, cmd::argument_name_type::boolean, false> s_refresh_arg
+    ("refresh", "If specified, reads the whole list or the message from server again, instead\n"
+     "\t    of the cached one in '~/.liquidfiles/metadata'.");
 }
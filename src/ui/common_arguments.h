@@ -49,9 +49,13 @@ inline lf::output_format string_to_val(const std::string& v)
         return lf::output_format::csv;
     } else if (v == "table") {
         return lf::output_format::table;
+    } else if (v == "json") {
+        return lf::output_format::json;
+    } else if (v == "ndjson") {
+        return lf::output_format::ndjson;
     }
     throw cmd::invalid_argument_value("--output_format",
-            "table, csv");
+            "table, csv, json, ndjson");
 }
 
 template <>
@@ -62,6 +66,10 @@ inline std::string val_to_string(const lf::output_format& v)
             return "table";
         case lf::output_format::csv :
             return "csv";
+        case lf::output_format::json :
+            return "json";
+        case lf::output_format::ndjson :
+            return "ndjson";
         default :
             throw 1;
     }
@@ -71,7 +79,7 @@ inline std::string val_to_string(const lf::output_format& v)
 template <>
 inline std::string possible_values<lf::output_format>()
 {
-    return "Valid values: table, csv.";
+    return "Valid values: table, csv, json, ndjson.";
 }
 
 }
@@ -81,5 +89,7 @@ namespace ui {
 extern cmd::argument_definition<lf::report_level, cmd::argument_name_type::named, false> s_report_level_arg;
 extern cmd::argument_definition<lf::output_format, cmd::argument_name_type::named, false> s_output_format_arg;
 extern cmd::argument_definition<bool, cmd::argument_name_type::boolean, false> s_attachment_argument;
+extern cmd::argument_definition<std::string, cmd::argument_name_type::named, false> s_files_from_arg;
+extern cmd::argument_definition<bool, cmd::argument_name_type::boolean, false> s_refresh_arg;
 
 }
@@ -1,14 +1,12 @@
 #include "credentials.h"
 
+#include <base/filesystem.h>
 #include <cmd/arguments.h>
 #include <cmd/exceptions.h>
-#include <io/messenger.h>
+#include <io/output.h>
 
-#include <cstdlib>
-#include <errno.h>
 #include <fstream>
 #include <set>
-#include <sys/stat.h>
 
 namespace ui {
 
@@ -30,19 +28,11 @@ cmd::argument_definition<bool, cmd::argument_name_type::boolean, false>
 
 cmd::argument_definition_container credentials::m_arguments;
 
-namespace {
-
-std::string get_directory_path()
-{
-    std::string h = std::getenv("HOME");
-    h += "/.liquidfiles/";
-    return h;
-}
-
-}
-
 void credentials::init()
 {
+    if (!m_arguments.empty()) {
+        return;
+    }
     m_arguments.push_back(m_server_arg);
     m_arguments.push_back(m_api_key_arg);
     m_arguments.push_back(m_validate_cert_arg);
@@ -51,8 +41,11 @@ void credentials::init()
 
 void credentials::load(credentials& c)
 {
-    std::string d = get_directory_path();
-    d += "/credentials";
+    std::string d = base::filesystem::user_directory();
+    if (d.empty()) {
+        return;
+    }
+    d += "credentials";
     std::ifstream f(d.c_str());
     int version = 0;
     f >> version;
@@ -72,17 +65,11 @@ void credentials::load(credentials& c)
 
 void credentials::save(const credentials& c)
 {
-    std::string d = get_directory_path();
-    struct stat sb;
-    int x = stat(d.c_str(), &sb);
-    if (x != 0 && errno == ENOTDIR) {
+    if (!base::filesystem::create_user_directory()) {
         io::mout << "Warning: could not save credentials." << io::endl;
         return;
     }
-    if (x != 0) {
-        mkdir(d.c_str(), S_IRWXU);
-    }
-    d += "/credentials";
+    std::string d = base::filesystem::user_directory() + "credentials";
     std::ofstream f(d.c_str());
     f << m_serial_version << std::endl;
     f << c.m_server << std::endl;
@@ -41,21 +41,20 @@ public:
     static const int m_serial_version = 1;
 
 public:
-    static void init();
-
     static const cmd::argument_definition_container& get_arguments()
     {
+        init();
         return m_arguments;
     }
 
     static std::string usage()
     {
-        return m_arguments.usage();
+        return get_arguments().usage();
     }
 
     static std::string arg_descriptions()
     {
-        return m_arguments.full_description();
+        return get_arguments().full_description();
     }
 
 public:
@@ -99,6 +98,11 @@ public:
     {
     }
 
+private:
+    /// @brief Fills the arguments on first use, so commands which don't
+    ///        need credentials don't pay for them.
+    static void init();
+
 private:
     std::string m_server;
     std::string m_api_key;
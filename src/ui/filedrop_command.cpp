@@ -1,6 +1,7 @@
 #include "filedrop_command.h"
 #include "credentials.h"
 #include "common_arguments.h"
+#include "files_from.h"
 
 #include <cmd/exceptions.h>
 #include <lf/declarations.h>
@@ -25,6 +26,7 @@ filedrop_command::filedrop_command(lf::engine& e)
     arguments.push_back(m_subject_argument);
     arguments.push_back(m_message_argument);
     arguments.push_back(s_attachment_argument);
+    arguments.push_back(s_files_from_arg);
     arguments.push_back(m_files_argument);
 }
 
@@ -36,12 +38,28 @@ void filedrop_command::execute(const cmd::arguments& args)
     std::string user = m_from_argument.value(args);
     std::string subject = m_subject_argument.value(args);
     std::string message = m_message_argument.value(args);
+    std::string list = s_files_from_arg.value(args);
     std::set<std::string> unnamed_args = m_files_argument.value(args);
+    if (list.empty() && unnamed_args.empty()) {
+        throw cmd::missing_argument(m_files_argument.type_string());
+    }
+    if (list == files_from::s_standard_input) {
+        m_engine.preconnect(server, rl, k);
+    }
     bool r = s_attachment_argument.value(args);
     if (r) {
+        if (!list.empty()) {
+            // Attachment IDs are all sent in one message.
+            files_from(list).read_all(unnamed_args);
+        }
         m_engine.filedrop_attachments(server, user, subject, message, unnamed_args, rl, k);
-    } else {
+    } else if (list.empty()) {
         m_engine.filedrop(server, user, subject, message, unnamed_args, rl, k);
+    } else {
+        lf::set_file_list u(unnamed_args);
+        files_from l(list);
+        joined_files fs(u, l);
+        m_engine.filedrop(server, user, subject, message, fs, rl, k);
     }
 }
 
@@ -31,7 +31,7 @@ private:
     cmd::argument_definition<std::string, cmd::argument_name_type::named, true> m_from_argument;
     cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_message_argument;
     cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_subject_argument;
-    cmd::argument_definition<std::string, cmd::argument_name_type::unnamed, true> m_files_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::unnamed, false> m_files_argument;
 };
 
 }
@@ -16,6 +16,7 @@ filelinks_command::filelinks_command(lf::engine& e)
     arguments.push_back(credentials::get_arguments());
     arguments.push_back(s_report_level_arg);
     arguments.push_back(s_output_format_arg);
+    arguments.push_back(s_refresh_arg);
     arguments.push_back(m_limit_argument);
 }
 
@@ -25,7 +26,8 @@ void filelinks_command::execute(const cmd::arguments& args)
     lf::report_level rl = s_report_level_arg.value(args);
     lf::output_format of = s_output_format_arg.value(args);
     std::string limit = m_limit_argument.value(args);
-    m_engine.filelinks(c.server(), c.api_key(), limit, of, rl, c.validate_flag());
+    lf::cache_use cu = s_refresh_arg.value(args) ? lf::cache_use::refresh : lf::cache_use::cached;
+    m_engine.filelinks(c.server(), c.api_key(), limit, of, rl, c.validate_flag(), cu);
 }
 
 }
@@ -0,0 +1,147 @@
+#include "files_from.h"
+
+#include <base/exceptions.h>
+#include <base/filesystem.h>
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace ui {
+
+namespace {
+
+constexpr std::size_t s_block_size = 64 * 1024;
+
+}
+
+const std::string files_from::s_standard_input = "-";
+
+files_from::files_from(const std::string& n)
+    : m_name{n}
+    , m_file{nullptr}
+    , m_buffer(s_block_size)
+    , m_begin{0}
+    , m_end{0}
+    , m_delimiter{'\n'}
+    , m_detected{false}
+    , m_eof{false}
+{
+    if (n == s_standard_input) {
+        m_file = stdin;
+        m_name = "standard input";
+    } else {
+        m_file = std::fopen(n.c_str(), "rb");
+        if (m_file == nullptr) {
+            throw base::invalid_file_name(n);
+        }
+    }
+}
+
+files_from::~files_from()
+{
+    if (m_file != nullptr && m_file != stdin) {
+        std::fclose(m_file);
+    }
+}
+
+bool files_from::fill()
+{
+    if (m_eof) {
+        return false;
+    }
+    // Keep the incomplete path at the beginning, grow the buffer only for
+    // paths longer than it.
+    std::size_t rest = m_end - m_begin;
+    if (m_begin != 0) {
+        std::memmove(m_buffer.data(), m_buffer.data() + m_begin, rest);
+    } else if (rest == m_buffer.size()) {
+        m_buffer.resize(m_buffer.size() * 2);
+    }
+    m_begin = 0;
+    m_end = rest;
+    // Reads what is available, not the whole block, so the first paths of a
+    // slow writer are taken as soon as they are written.
+    ssize_t n = 0;
+    do {
+        n = ::read(fileno(m_file), m_buffer.data() + m_end, m_buffer.size() - m_end);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        throw base::invalid_file_name(m_name);
+    }
+    if (n == 0) {
+        m_eof = true;
+        return false;
+    }
+    m_end += static_cast<std::size_t>(n);
+    // Delimiter is known by the first complete path.
+    if (!m_detected) {
+        if (std::memchr(m_buffer.data(), '\0', m_end) != nullptr) {
+            m_delimiter = '\0';
+            m_detected = true;
+        } else if (std::memchr(m_buffer.data(), '\n', m_end) != nullptr) {
+            m_detected = true;
+        }
+    }
+    return true;
+}
+
+bool files_from::next(std::string& f)
+{
+    while (true) {
+        const char* b = m_buffer.data() + m_begin;
+        const char* d = static_cast<const char*>(std::memchr(b, m_delimiter, m_end - m_begin));
+        std::size_t n = 0;
+        if (d != nullptr) {
+            n = d - b;
+            m_begin += n + 1;
+        } else if (!fill()) {
+            // Last path may have no delimiter.
+            n = m_end - m_begin;
+            b = m_buffer.data() + m_begin;
+            m_begin = m_end;
+            if (n == 0) {
+                return false;
+            }
+        } else {
+            continue;
+        }
+        if (m_delimiter == '\n' && n != 0 && b[n - 1] == '\r') {
+            --n;
+        }
+        if (n != 0) {
+            f.assign(b, n);
+            return true;
+        }
+    }
+}
+
+void files_from::read_all(std::set<std::string>& s)
+{
+    std::string f;
+    while (next(f)) {
+        s.insert(f);
+    }
+}
+
+directory_files::directory_files(lf::file_list& d)
+    : m_directories{d}
+    , m_current{m_files.end()}
+{
+}
+
+bool directory_files::next(std::string& f)
+{
+    std::string d;
+    while (m_current == m_files.end()) {
+        if (!m_directories.next(d)) {
+            return false;
+        }
+        m_files = base::filesystem::get_all_files(std::set<std::string>{d});
+        m_current = m_files.begin();
+    }
+    f = *m_current++;
+    return true;
+}
+
+}
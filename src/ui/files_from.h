@@ -0,0 +1,114 @@
+#pragma once
+
+#include <lf/file_list.h>
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ui {
+
+/**
+ * @class files_from
+ * @brief List of files read from file, or from standard input if the name
+ *        is "-".
+ *
+ *        Commands pre-connect to the server when the list comes from
+ *        standard input, the program writing it (e.g. 'find') may take
+ *        long until the first path.
+ *
+ *        Paths are separated by newlines, or by NUL characters if the
+ *        list contains any (e.g. output of 'find -print0'). The list is
+ *        read by blocks while files are taken, so memory does not depend
+ *        on its size.
+ */
+class files_from final : public lf::file_list
+{
+public:
+    /**
+     * @brief Constructor.
+     * @param n Name of file with the list, "-" for standard input.
+     * @throw invalid_file_name.
+     */
+    files_from(const std::string& n);
+
+    /// @brief Destructor.
+    ~files_from();
+
+    files_from(const files_from&) = delete;
+    files_from& operator=(const files_from&) = delete;
+
+public:
+    /// @throw invalid_file_name if the list can't be read.
+    bool next(std::string& f) override;
+
+public:
+    /// @brief Reads the whole rest of list into the set.
+    void read_all(std::set<std::string>& s);
+
+public:
+    /// @brief Name of standard input.
+    static const std::string s_standard_input;
+
+private:
+    bool fill();
+
+private:
+    std::string m_name;
+    std::FILE* m_file;
+    std::vector<char> m_buffer;
+    std::size_t m_begin;
+    std::size_t m_end;
+    char m_delimiter;
+    bool m_detected;
+    bool m_eof;
+};
+
+/**
+ * @class directory_files
+ * @brief List of files in the directories of other list.
+ *
+ *        Each directory is listed when the previous one is consumed.
+ */
+class directory_files final : public lf::file_list
+{
+public:
+    /// @param d List of directories, must outlive this list.
+    directory_files(lf::file_list& d);
+
+public:
+    bool next(std::string& f) override;
+
+private:
+    lf::file_list& m_directories;
+    std::set<std::string> m_files;
+    std::set<std::string>::const_iterator m_current;
+};
+
+/**
+ * @class joined_files
+ * @brief List of files of the first list, then of the second one.
+ */
+class joined_files final : public lf::file_list
+{
+public:
+    /// @param a, b Lists, must outlive this list.
+    joined_files(lf::file_list& a, lf::file_list& b)
+        : m_first{a}
+        , m_second{b}
+    {
+    }
+
+public:
+    bool next(std::string& f) override
+    {
+        return m_first.next(f) || m_second.next(f);
+    }
+
+private:
+    lf::file_list& m_first;
+    lf::file_list& m_second;
+};
+
+}
@@ -2,7 +2,7 @@
 
 #include <cmd/command_processor.h>
 #include <cmd/exceptions.h>
-#include <io/messenger.h>
+#include <io/output.h>
 
 namespace ui {
 
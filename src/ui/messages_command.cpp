@@ -18,6 +18,7 @@ messages_command::messages_command(lf::engine& e)
     arguments.push_back(credentials::get_arguments());
     arguments.push_back(s_report_level_arg);
     arguments.push_back(s_output_format_arg);
+    arguments.push_back(s_refresh_arg);
     arguments.push_back(m_message_id_argument);
     arguments.push_back(m_sent_in_last_argument);
     arguments.push_back(m_sent_after_argument);
@@ -31,10 +32,11 @@ void messages_command::execute(const cmd::arguments& args)
     std::string id = m_message_id_argument.value(args);
     lf::report_level rl = s_report_level_arg.value(args);
     lf::output_format of = s_output_format_arg.value(args);
+    lf::cache_use cu = s_refresh_arg.value(args) ? lf::cache_use::refresh : lf::cache_use::cached;
     if (id == "") {
-        m_engine.messages(c.server(), c.api_key(), l, f, of, rl, c.validate_flag());
+        m_engine.messages(c.server(), c.api_key(), l, f, of, rl, c.validate_flag(), cu);
     } else {
-        m_engine.message(c.server(), c.api_key(), id, of, rl, c.validate_flag());
+        m_engine.message(c.server(), c.api_key(), id, of, rl, c.validate_flag(), cu);
     }
 }
 
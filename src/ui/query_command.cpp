@@ -0,0 +1,126 @@
+#include "query_command.h"
+#include "common_arguments.h"
+#include "credentials.h"
+
+#include <base/lf_string.h>
+#include <cmd/exceptions.h>
+#include <lf/declarations.h>
+#include <lf/engine.h>
+
+#include <ctime>
+
+namespace cmd {
+
+template <>
+inline lf::query_group string_to_val(const std::string& v)
+{
+    if (v == "none") {
+        return lf::query_group::none;
+    } else if (v == "sender") {
+        return lf::query_group::sender;
+    } else if (v == "day") {
+        return lf::query_group::day;
+    }
+    throw cmd::invalid_argument_value("--group_by", "none, sender, day");
+}
+
+template <>
+inline std::string val_to_string(const lf::query_group& v)
+{
+    switch (v) {
+        case lf::query_group::sender:
+            return "sender";
+        case lf::query_group::day:
+            return "day";
+        case lf::query_group::none:
+        default:
+            return "none";
+    }
+}
+
+template <>
+inline std::string possible_values<lf::query_group>()
+{
+    return "Valid values: none, sender, day.";
+}
+
+}
+
+namespace ui {
+
+namespace {
+
+/**
+ * @brief Parses the count given by argument.
+ * @param n Name of argument, for error reporting.
+ * @param v Value of argument.
+ * @throw invalid_arguments if the value is not a number.
+ */
+std::int64_t parse_count(const std::string& n, const std::string& v)
+{
+    std::int64_t r = 0;
+    const char* e = v.data() + v.size();
+    if (v.empty() || v[0] == '-' || base::parse_integer(v.data(), e, r) != e) {
+        throw cmd::invalid_arguments(n + " must be a number.");
+    }
+    return r;
+}
+
+}
+
+query_command::query_command(lf::engine& e)
+    : cmd::command{"query", "Queries the messages kept in cache, lists or counts them."}
+    , m_engine{e}
+    , m_from_argument{"from", "<email>", "Show messages sent by the specified user."}
+    , m_to_argument{"to", "<email>", "Show messages sent to the specified user."}
+    , m_subject_argument{"subject", "<text>", "Show messages whose subject contains the text, ignoring case."}
+    , m_larger_than_argument{"larger_than", "<bytes>", "Show messages whose attachments are larger in total."}
+    , m_sent_in_last_argument{"sent_in_the_last", "<HOURS>", "Show messages sent in the last specified hours."}
+    , m_sent_after_argument{"sent_after", "YYYYMMDD", "Show messages sent after specified date."}
+    , m_group_by_argument{"group_by", "<group>", "Counts the messages and sums the sizes of their attachments by\n"
+        "\t    sender or by day (UTC), instead of listing them.", lf::query_group::none}
+{
+    arguments.push_back(credentials::get_arguments());
+    arguments.push_back(s_report_level_arg);
+    arguments.push_back(s_output_format_arg);
+    arguments.push_back(s_refresh_arg);
+    arguments.push_back(m_from_argument);
+    arguments.push_back(m_to_argument);
+    arguments.push_back(m_subject_argument);
+    arguments.push_back(m_larger_than_argument);
+    arguments.push_back(m_sent_in_last_argument);
+    arguments.push_back(m_sent_after_argument);
+    arguments.push_back(m_group_by_argument);
+}
+
+void query_command::execute(const cmd::arguments& args)
+{
+    credentials c = credentials::manage(args);
+    lf::message_filter f;
+    f.sender = m_from_argument.value(args);
+    f.recipient = m_to_argument.value(args);
+    f.subject = m_subject_argument.value(args);
+    std::string v = m_larger_than_argument.value(args);
+    if (!v.empty()) {
+        f.larger_than = parse_count(m_larger_than_argument.name(), v);
+    }
+    v = m_sent_in_last_argument.value(args);
+    std::string a = m_sent_after_argument.value(args);
+    if (!v.empty()) {
+        std::int64_t h = parse_count(m_sent_in_last_argument.name(), v);
+        f.created_after = static_cast<std::int64_t>(std::time(nullptr)) - h * 3600;
+    } else if (!a.empty()) {
+        if (a.size() != 8 || a.find_first_not_of("0123456789") != std::string::npos) {
+            throw cmd::invalid_arguments(m_sent_after_argument.name() + " must be date YYYYMMDD.");
+        }
+        f.created_after = lf::message_columns::parse_time(
+                a.substr(0, 4) + "-" + a.substr(4, 2) + "-" + a.substr(6, 2) + "T00:00:00Z");
+    }
+    lf::report_level rl = s_report_level_arg.value(args);
+    lf::output_format of = s_output_format_arg.value(args);
+    lf::cache_use cu = s_refresh_arg.value(args) ? lf::cache_use::refresh : lf::cache_use::cached;
+    m_engine.query(c.server(), c.api_key(), f, m_group_by_argument.value(args), of, rl,
+            c.validate_flag(), cu);
+}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cmd/command.h>
+#include <lf/message_query.h>
+
+namespace lf {
+class engine;
+}
+
+namespace ui {
+
+/**
+ * @class query_command.
+ * @brief Class for 'query' command.
+ */
+class query_command final : public cmd::command
+{
+public:
+    /// @brief Constructor.
+    /// @param e Engine.
+    query_command(lf::engine& e);
+
+public:
+    /// @brief Executes command by given arguments.
+    void execute(const cmd::arguments& args) override;
+
+private:
+    lf::engine& m_engine;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_from_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_to_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_subject_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_larger_than_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_sent_in_last_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_sent_after_argument;
+    cmd::argument_definition<lf::query_group, cmd::argument_name_type::named, false> m_group_by_argument;
+};
+
+}
@@ -1,18 +1,30 @@
 #include "send_command.h"
 #include "credentials.h"
 #include "common_arguments.h"
+#include "files_from.h"
 
 #include <cmd/exceptions.h>
+#include <cmd/utility.h>
 #include <base/filesystem.h>
+#include <io/output.h>
 #include <lf/declarations.h>
 #include <lf/engine.h>
+#include <lf/exceptions.h>
+#include <lf/manifest_sender.h>
+
+#include <vector>
 
 namespace ui {
 
 send_command::send_command(lf::engine& e)
-    : cmd::command{"send", "Sends the file(s) to specified user."}
+    : cmd::command{"send", "Sends the file(s) to specified users."}
     , m_engine{e}
-    , m_to_argument{"to", "<username>", "User name or email, to send file."}
+    , m_to_argument{"to", "<usernames>", "User names or emails separated by commas, to send file."}
+    , m_cc_argument{"cc", "<usernames>", "User names or emails separated by commas, to send copy.", ""}
+    , m_bcc_argument{"bcc", "<usernames>", "User names or emails separated by commas, to send hidden copy.", ""}
+    , m_each_argument{"e", "If specified, sends separate message to each user of '--to', with the same copies."
+            " Files are uploaded once and the messages are sent concurrently."}
+    , m_workers_argument{"workers", "<count>", "Count of concurrent uploads and messages with '-e'.", 4}
     , m_file_type_argument{"file_type", "<type>", "Type of unnamed arguments.", file_type::names}
     , m_message_argument{"message", "<string>", "Message text of composed email.", ""}
     , m_message_file_argument{"message_file", "<string>", "Message text of composed email.", ""}
@@ -22,17 +34,33 @@ send_command::send_command(lf::engine& e)
     arguments.push_back(credentials::get_arguments());
     arguments.push_back(s_report_level_arg);
     arguments.push_back(m_to_argument);
+    arguments.push_back(m_cc_argument);
+    arguments.push_back(m_bcc_argument);
+    arguments.push_back(m_each_argument);
+    arguments.push_back(m_workers_argument);
     arguments.push_back(m_file_type_argument);
     arguments.push_back(m_message_argument);
     arguments.push_back(m_message_file_argument);
     arguments.push_back(m_subject_argument);
+    arguments.push_back(s_files_from_arg);
     arguments.push_back(m_files_argument);
 }
 
 void send_command::execute(const cmd::arguments& args)
 {
     credentials c = credentials::manage(args);
-    std::string user = m_to_argument.value(args);
+    lf::recipients r;
+    cmd::utility::split(r.to, m_to_argument.value(args), ", ");
+    cmd::utility::split(r.cc, m_cc_argument.value(args), ", ");
+    cmd::utility::split(r.bcc, m_bcc_argument.value(args), ", ");
+    if (r.to.empty()) {
+        throw cmd::missing_argument(m_to_argument.name());
+    }
+    bool each = m_each_argument.value(args);
+    int w = m_workers_argument.value(args);
+    if (w <= 0) {
+        throw cmd::invalid_arguments(m_workers_argument.name() + " must be positive.");
+    }
     lf::report_level rl = s_report_level_arg.value(args);
     std::string subject = m_subject_argument.value(args);
     std::string message = m_message_argument.value(args);
@@ -42,23 +70,117 @@ void send_command::execute(const cmd::arguments& args)
     if (!message.empty() && !message_file.empty()) {
         throw cmd::dublicate_argument(m_message_argument.name() + " and " + m_message_file_argument.name());
     }
+    std::string list = s_files_from_arg.value(args);
+    std::set<std::string> unnamed_args = m_files_argument.value(args);
+    if (list.empty() && unnamed_args.empty()) {
+        throw cmd::missing_argument(m_files_argument.type_string());
+    }
+    // Connection is opened while directories are listed or the list is
+    // written, otherwise the first file is ready at once and waiting for
+    // the pre-connect would only delay it. Separate messages are sent by
+    // own connections.
+    if (!each && (sending_file_type == file_type::directory || list == files_from::s_standard_input)) {
+        m_engine.preconnect(c.server(), rl, c.validate_flag());
+    }
     if (message.empty() && !message_file.empty()) {
         message = base::filesystem::read_file(message_file);
     }
-
-    std::set<std::string> unnamed_args = m_files_argument.value(args);
+    if (each) {
+        send_each(c, r, subject, message, list, unnamed_args, sending_file_type, rl, w);
+        return;
+    }
+    if (!list.empty()) {
+        send_list(c, r, subject, message, list, unnamed_args, sending_file_type, rl);
+        return;
+    }
 
     if (sending_file_type == file_type::attachment) {
-        m_engine.send_attachments(c.server(), c.api_key(), user, subject, message, unnamed_args,
+        m_engine.send_attachments(c.server(), c.api_key(), r, subject, message, unnamed_args,
                 rl, c.validate_flag());
     } else if (sending_file_type == file_type::names) {
-        m_engine.send(c.server(), c.api_key(), user, subject, message, unnamed_args,
+        m_engine.send(c.server(), c.api_key(), r, subject, message, unnamed_args,
                 rl, c.validate_flag());
     } else if (sending_file_type == file_type::directory) {
         unnamed_args = base::filesystem::get_all_files(unnamed_args);
-        m_engine.send(c.server(), c.api_key(), user, subject, message, unnamed_args,
+        m_engine.send(c.server(), c.api_key(), r, subject, message, unnamed_args,
                 rl, c.validate_flag());
     }
 }
 
+void send_command::send_list(const credentials& c, const lf::recipients& r,
+        const std::string& subject, const std::string& message,
+        const std::string& list, std::set<std::string>& unnamed_args,
+        file_type t, lf::report_level rl)
+{
+    files_from l(list);
+    if (t == file_type::attachment) {
+        // Attachment IDs are all sent in one message.
+        l.read_all(unnamed_args);
+        m_engine.send_attachments(c.server(), c.api_key(), r, subject, message, unnamed_args,
+                rl, c.validate_flag());
+        return;
+    }
+    lf::set_file_list u(unnamed_args);
+    joined_files fs(u, l);
+    if (t == file_type::directory) {
+        directory_files d(fs);
+        m_engine.send(c.server(), c.api_key(), r, subject, message, d, rl, c.validate_flag());
+    } else {
+        m_engine.send(c.server(), c.api_key(), r, subject, message, fs, rl, c.validate_flag());
+    }
+}
+
+void send_command::send_each(const credentials& c, const lf::recipients& r,
+        const std::string& subject, const std::string& message,
+        const std::string& list, std::set<std::string>& unnamed_args,
+        file_type t, lf::report_level rl, unsigned w)
+{
+    if (!list.empty()) {
+        files_from(list).read_all(unnamed_args);
+    }
+    if (t == file_type::directory) {
+        unnamed_args = base::filesystem::get_all_files(unnamed_args);
+    }
+    std::vector<std::string> fs(unnamed_args.begin(), unnamed_args.end());
+    std::vector<lf::manifest_entry> es;
+    for (const auto& u : r.to) {
+        lf::manifest_entry e;
+        e.record = es.size() + 1;
+        e.to = r;
+        e.to.to.assign(1, u);
+        e.subject = subject;
+        e.message = message;
+        if (t == file_type::attachment) {
+            e.attachments = fs;
+        } else {
+            e.files = fs;
+        }
+        es.push_back(std::move(e));
+    }
+    lf::manifest_options o;
+    o.server = c.server();
+    o.key = c.api_key();
+    o.validate = c.validate_flag();
+    o.workers = w;
+    o.metadata = m_engine.metadata();
+    std::vector<lf::manifest_result> rs = lf::manifest_sender(o).run(es);
+    std::size_t failed = 0;
+    for (const auto& i : rs) {
+        if (!i.error.empty()) {
+            ++failed;
+        }
+        if (rl == lf::report_level::silent) {
+            continue;
+        }
+        if (i.error.empty()) {
+            io::mout << "Message to user '" << i.recipient << "' sent successfully. ID: " << i.id << io::endl;
+        } else {
+            io::mout << "Message to user '" << i.recipient << "' is not sent. " << i.error << io::endl;
+        }
+    }
+    if (failed != 0) {
+        throw lf::messages_not_sent(failed, rs.size());
+    }
+}
+
 }
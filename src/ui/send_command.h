@@ -3,6 +3,11 @@
 #include "declarations.h"
 
 #include <cmd/command.h>
+#include <lf/declarations.h>
+#include <lf/recipients.h>
+
+#include <set>
+#include <string>
 
 namespace lf {
 class engine;
@@ -10,6 +15,8 @@ class engine;
 
 namespace ui {
 
+class credentials;
+
 /**
  * @class send_command.
  * @brief Class for 'send' command.
@@ -25,14 +32,32 @@ public:
     /// @brief Executes command by given arguments.
     void execute(const cmd::arguments& args) override;
 
+private:
+    /// @brief Sends the files of unnamed arguments and of the list file.
+    void send_list(const credentials& c, const lf::recipients& r,
+            const std::string& subject, const std::string& message,
+            const std::string& list, std::set<std::string>& unnamed_args,
+            file_type t, lf::report_level rl);
+
+    /// @brief Sends separate message to each main recipient, the files
+    ///        are uploaded once.
+    void send_each(const credentials& c, const lf::recipients& r,
+            const std::string& subject, const std::string& message,
+            const std::string& list, std::set<std::string>& unnamed_args,
+            file_type t, lf::report_level rl, unsigned w);
+
 private:
     lf::engine& m_engine;
     cmd::argument_definition<std::string, cmd::argument_name_type::named, true> m_to_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_cc_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_bcc_argument;
+    cmd::argument_definition<bool, cmd::argument_name_type::boolean, false> m_each_argument;
+    cmd::argument_definition<int, cmd::argument_name_type::named, false> m_workers_argument;
     cmd::argument_definition<file_type, cmd::argument_name_type::named, false> m_file_type_argument;
     cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_message_argument;
     cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_message_file_argument;
     cmd::argument_definition<std::string, cmd::argument_name_type::named, false> m_subject_argument;
-    cmd::argument_definition<std::string, cmd::argument_name_type::unnamed, true> m_files_argument;
+    cmd::argument_definition<std::string, cmd::argument_name_type::unnamed, false> m_files_argument;
 };
 
 }
@@ -0,0 +1,122 @@
+#include "send_manifest_command.h"
+#include "common_arguments.h"
+#include "credentials.h"
+#include "files_from.h"
+
+#include <base/exceptions.h>
+#include <base/lf_string.h>
+#include <cmd/exceptions.h>
+#include <cmd/utility.h>
+#include <io/csv_stream.h>
+#include <io/output.h>
+#include <lf/declarations.h>
+#include <lf/exceptions.h>
+#include <lf/manifest_sender.h>
+#include <lf/record_writer.h>
+
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace ui {
+
+namespace {
+
+/// @brief Count of fields before the files: recipient, subject, message.
+constexpr std::size_t s_file_field = 3;
+
+/**
+ * @brief Reads the messages of manifest.
+ * @param s Stream of manifest.
+ * @throw invalid_arguments if a record has no recipient or files.
+ */
+std::vector<lf::manifest_entry> read_manifest(std::istream& s)
+{
+    std::vector<lf::manifest_entry> es;
+    io::csv_istream c(&s);
+    std::vector<std::string> r;
+    for (unsigned n = 1; c.read_row(r); ++n) {
+        // Blank lines and the header are skipped.
+        if ((r.size() == 1 && r[0].empty()) || (n == 1 && r[0] == "recipient")) {
+            continue;
+        }
+        if (r.size() <= s_file_field) {
+            r.resize(s_file_field + 1);
+        }
+        lf::manifest_entry e;
+        e.record = n;
+        // Several recipients are separated by commas.
+        cmd::utility::split(e.to.to, r[0], ", ");
+        e.subject = std::move(r[1]);
+        e.message = std::move(r[2]);
+        for (std::size_t i = s_file_field; i < r.size(); ++i) {
+            if (!r[i].empty()) {
+                e.files.push_back(std::move(r[i]));
+            }
+        }
+        if (e.to.to.empty() || e.files.empty()) {
+            throw cmd::invalid_arguments("Record " + base::to_string(n)
+                    + " of manifest must have recipient, subject, message and at least one file.");
+        }
+        es.push_back(std::move(e));
+    }
+    return es;
+}
+
+}
+
+send_manifest_command::send_manifest_command(lf::metadata_cache* m)
+    : cmd::command{"send_manifest", "Sends the files of manifest, each message to its recipient."}
+    , m_metadata{m}
+    , m_manifest_argument{"manifest", "<file>", "CSV file of messages to send, '-' reads it from standard input."}
+    , m_workers_argument{"workers", "<count>", "Count of concurrent uploads and messages.", 4}
+{
+    arguments.push_back(credentials::get_arguments());
+    arguments.push_back(s_output_format_arg);
+    arguments.push_back(m_manifest_argument);
+    arguments.push_back(m_workers_argument);
+}
+
+void send_manifest_command::execute(const cmd::arguments& args)
+{
+    credentials c = credentials::manage(args);
+    lf::output_format of = s_output_format_arg.value(args);
+    std::string m = m_manifest_argument.value(args);
+    int w = m_workers_argument.value(args);
+    if (w <= 0) {
+        throw cmd::invalid_arguments(m_workers_argument.name() + " must be positive.");
+    }
+    std::vector<lf::manifest_entry> es;
+    if (m == files_from::s_standard_input) {
+        es = read_manifest(std::cin);
+    } else {
+        std::ifstream f(m, std::ios::binary);
+        if (!f) {
+            throw base::invalid_file_name(m);
+        }
+        es = read_manifest(f);
+    }
+    lf::manifest_options o;
+    o.server = c.server();
+    o.key = c.api_key();
+    o.validate = c.validate_flag();
+    o.workers = w;
+    o.metadata = m_metadata;
+    std::vector<lf::manifest_result> rs = lf::manifest_sender(o).run(es);
+    std::size_t failed = 0;
+    {
+        lf::record_writer rw(io::mout, of);
+        for (const auto& r : rs) {
+            rw.write(r);
+            if (!r.error.empty()) {
+                ++failed;
+            }
+        }
+        rw.finish();
+    }
+    if (failed != 0) {
+        throw lf::messages_not_sent(failed, rs.size());
+    }
+}
+
+}
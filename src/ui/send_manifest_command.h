@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cmd/command.h>
+
+namespace lf {
+class metadata_cache;
+}
+
+namespace ui {
+
+/**
+ * @class send_manifest_command.
+ * @brief Class for 'send_manifest' command.
+ */
+class send_manifest_command final : public cmd::command
+{
+public:
+    /// @brief Constructor.
+    /// @param m Cache of messages, marked out of date by sent messages, or
+    ///        null.
+    send_manifest_command(lf::metadata_cache* m);
+
+public:
+    /// @brief Executes command by given arguments.
+    void execute(const cmd::arguments& args) override;
+
+private:
+    lf::metadata_cache* m_metadata;
+    cmd::argument_definition<std::string, cmd::argument_name_type::named, true> m_manifest_argument;
+    cmd::argument_definition<int, cmd::argument_name_type::named, false> m_workers_argument;
+};
+
+}
@@ -13,7 +13,7 @@ test_status "Couldn't upload second chunk"
 ID=${ID##* }
 rm xaa xab
 
-MESSAGE=`$EXEC send --to=xustup@example.com --server=$SERVER -k -r --api_key=$KEY --message="Hello" --subject="Hello!" $ID`
+MESSAGE=`$EXEC send --to=xustup@example.com --server=$SERVER -k --file_type=attachment --api_key=$KEY --message="Hello" --subject="Hello!" $ID`
 test_status "Couldn't send message."
 MESSAGE=${MESSAGE##* }
 test_message $MESSAGE
@@ -34,7 +34,7 @@ do
     test_status "Couldn't upload chunk $ii"
 done
 ID=${ID##* }
-MESSAGE=`$EXEC send --to=xustup@example.com --server=$SERVER -k -r --api_key=$KEY --message="Hello" --subject="Hello!" $ID`
+MESSAGE=`$EXEC send --to=xustup@example.com --server=$SERVER -k --file_type=attachment --api_key=$KEY --message="Hello" --subject="Hello!" $ID`
 test_status "Couldn't send message."
 MESSAGE=${MESSAGE##* }
 test_message $MESSAGE
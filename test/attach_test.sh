@@ -11,7 +11,7 @@ ID2=`$EXEC attach --server=$SERVER -k --api_key=$KEY $DIR/attach_test.sh`
 test_status "Couldn't upload file"
 ID2=${ID2##* }
 
-MESSAGE=`$EXEC send --to=xustup@example.com --server=$SERVER -k -r --api_key=$KEY --message="Hello" --subject="Hello!" $ID1 $ID2`
+MESSAGE=`$EXEC send --to=xustup@example.com --server=$SERVER -k --file_type=attachment --api_key=$KEY --message="Hello" --subject="Hello!" $ID1 $ID2`
 test_status "Couldn't send message."
 MESSAGE=${MESSAGE##* }
 
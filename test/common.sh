@@ -2,16 +2,18 @@
 
 DIR=$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )
 
-SERVER=https://pink.liquidfiles.com
+# LF_TEST_SERVER and LF_TEST_EXEC override the server and the utility to test,
+# run.sh --mock sets them to run the tests against mock_server.py.
+SERVER=${LF_TEST_SERVER:-https://pink.liquidfiles.com}
 
-EXEC=$DIR/../build/liquidfiles
+EXEC=${LF_TEST_EXEC:-$DIR/../build/liquidfiles}
 
 KEY=`$EXEC get_api_key --server=$SERVER -k --username=xustup@gmail.com --password=TestPassword_1`
-KEY=${KEY##* }
+KEY=${KEY##*[[:space:]]}
 
 function fail {
     echo "Test FAILED"
-    exit $?
+    exit 1
 }
 
 function test_status {
@@ -26,6 +26,19 @@ test_status "Couldn't retrieve filelinks in csv format"
 $EXEC delete_filelink --server=$SERVER -k --api_key=$KEY --filelink_id=$ID1
 test_status "Couldn't delete filelink"
 
+# The cached list must not keep the deleted filelink.
+LINKS=`$EXEC filelinks --server=$SERVER -k --api_key=$KEY --output_format=csv`
+test_status "Couldn't retrieve filelinks in csv format"
+if echo "$LINKS" | grep -q "$ID1"; then
+    echo "Deleted filelink is listed."
+    fail
+fi
+echo "$LINKS" | grep -q "$ID2"
+test_status "Filelink is not listed."
+
+$EXEC filelinks --server=$SERVER -k --api_key=$KEY -refresh --limit=1
+test_status "Couldn't retrieve filelinks from server"
+
 $EXEC delete_filelink --server=$SERVER -k --api_key=$KEY --filelink_id=$ID2
 test_status "Couldn't delete filelink"
 
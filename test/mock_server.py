@@ -0,0 +1,559 @@
+#! /usr/bin/env python3
+"""Mock LiquidFiles server for offline testing of liquidfiles utility.
+
+Implements the parts of LiquidFiles API used by the utility: uploading
+attachments (also by chunks), sending and listing messages, filelinks,
+file requests, login and filedrop. All the data is kept in memory.
+
+Latency, bandwidth and failures of requests can be configured to test
+the behaviour of utility on slow or unreliable connection. With --discard
+the content of uploaded files is not kept, only their sizes, and zeros are
+downloaded instead, so arbitrarily large files can be transferred.
+
+Usage: mock_server.py [options], see --help.
+"""
+
+import argparse
+import base64
+import datetime
+import hashlib
+import http.server
+import json
+import os
+import random
+import re
+import socketserver
+import sys
+import threading
+import time
+import urllib.parse
+import zlib
+
+ID_ALPHABET = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789'
+ID_SIZE = 22
+CHUNK_SIZE = 16384
+# Bytes kept from the start and the end of discarded request bodies, enough
+# for the headers of the first and the fields after the last multipart part.
+DISCARD_KEEP = 65536
+
+
+class State:
+    """In-memory storage of the server."""
+
+    def __init__(self, args):
+        self.lock = threading.Lock()
+        self.random = random.Random(args.seed)
+        self.users = {args.user: args.password}
+        self.keys = {args.api_key: args.user}
+        self.filedrops = {}
+        self.attachments = {}
+        self.chunks = {}
+        self.messages = {}
+        self.links = {}
+        self.requests = 0
+
+    def new_id(self):
+        return ''.join(self.random.choice(ID_ALPHABET) for _ in range(ID_SIZE))
+
+    def filedrop_key(self, name):
+        if name not in self.filedrops:
+            key = self.new_id()
+            self.filedrops[name] = key
+            self.keys[key] = 'filedrop:' + name
+        return self.filedrops[name]
+
+
+def now():
+    return datetime.datetime.now(datetime.timezone.utc)
+
+
+def timestamp(t):
+    return t.strftime('%Y-%m-%dT%H:%M:%S.000Z')
+
+
+def parse_multipart(body, content_type):
+    """Returns dict of name -> (filename, bytes) of multipart/form-data."""
+    m = re.search(r'boundary="?([^";]+)"?', content_type)
+    if m is None:
+        return {}
+    boundary = b'--' + m.group(1).encode()
+    fields = {}
+    for part in body.split(boundary)[1:]:
+        if part.startswith(b'--'):
+            break
+        head, _, data = part.partition(b'\r\n\r\n')
+        if data.endswith(b'\r\n'):
+            data = data[:-2]
+        disposition = ''
+        for line in head.decode('utf-8', 'replace').split('\r\n'):
+            if line.lower().startswith('content-disposition:'):
+                disposition = line
+        name = re.search(r'\bname="([^"]*)"', disposition)
+        filename = re.search(r'\bfilename="([^"]*)"', disposition)
+        if name is not None:
+            fields[name.group(1)] = (
+                filename.group(1) if filename is not None else None, data)
+    return fields
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    """Handles requests of liquidfiles utility."""
+
+    protocol_version = 'HTTP/1.1'
+    server_version = 'LiquidFilesMock/1.0'
+    # Responces are written in several small pieces, with Nagle's algorithm
+    # each of them would wait for delayed ACK of the client.
+    disable_nagle_algorithm = True
+
+    # Routing.
+
+    def do_GET(self):
+        self.dispatch('GET')
+
+    def do_POST(self):
+        self.dispatch('POST')
+
+    def do_PUT(self):
+        self.dispatch('PUT')
+
+    def do_DELETE(self):
+        self.dispatch('DELETE')
+
+    def do_HEAD(self):
+        # Sent by the utility only to open the connection early, it is not
+        # counted, so injected failures hit the same requests.
+        if self.server.config.latency > 0:
+            time.sleep(self.server.config.latency / 1000.0)
+        self.send_response(200)
+        self.send_header('Content-Length', '0')
+        self.end_headers()
+
+    ROUTES = [
+        ('POST', r'/login', 'login', False),
+        ('POST', r'/attachments', 'attach', True),
+        ('DELETE', r'/attachment/(\w+)', 'delete_attachment', True),
+        ('GET', r'/attachment/(\w+)/download/([^/]+)', 'download', False),
+        ('GET', r'/message', 'list_messages', True),
+        ('POST', r'/message', 'send', True),
+        ('GET', r'/message/(\w+)', 'get_message', True),
+        ('GET', r'/message/(\w+)/delete_attachments',
+            'delete_message_attachments', True),
+        ('GET', r'/link', 'list_links', True),
+        ('POST', r'/link', 'create_link', True),
+        ('DELETE', r'/link/(\w+)', 'delete_link', True),
+        ('POST', r'/requests', 'file_request', True),
+        ('GET', r'/filedrop/([\w-]+)', 'filedrop_info', False),
+        ('POST', r'/filedrop/([\w-]+)', 'filedrop_send', False),
+    ]
+
+    def dispatch(self, method):
+        config = self.server.config
+        state = self.server.state
+        url = urllib.parse.urlsplit(self.path)
+        self.query = urllib.parse.parse_qs(url.query)
+        body = self.read_body()
+        if config.latency > 0:
+            time.sleep(config.latency / 1000.0)
+        with state.lock:
+            state.requests += 1
+            n = state.requests
+            inject = (config.fail_path is None or
+                      re.search(config.fail_path, url.path) is not None) and (
+                (config.fail_every > 0 and n % config.fail_every == 0) or
+                state.random.random() < config.error_rate)
+        if inject:
+            self.send_json({'errors': ['Injected error']}, config.error_status)
+            return
+        for m, pattern, name, auth in self.ROUTES:
+            match = re.fullmatch(pattern, url.path.rstrip('/') or '/')
+            if m != method or match is None:
+                continue
+            if auth and self.user() is None:
+                self.send_json({'errors': ['Unauthorized']}, 401)
+                return
+            # The lock is held only while the handler reads and changes the
+            # state, the result is sent after, so concurrent transfers and
+            # throttling don't wait for each other.
+            self.result = None
+            with state.lock:
+                getattr(self, name)(body, *match.groups())
+            self.send_result()
+            return
+        self.send_json({'errors': ['Not found: %s %s' % (method, url.path)]}, 404)
+
+    # Transport.
+
+    def read_body(self):
+        n = int(self.headers.get('Content-Length') or 0)
+        self.discarded = 0
+        upload = urllib.parse.urlsplit(self.path).path.endswith('/attachments')
+        if self.server.config.discard and upload and n > 2 * DISCARD_KEEP:
+            self.discarded = n - 2 * DISCARD_KEEP
+            head = self.read_bytes(DISCARD_KEEP)
+            self.skip_bytes(self.discarded)
+            return head + self.read_bytes(DISCARD_KEEP)
+        return self.read_bytes(n)
+
+    def read_bytes(self, n):
+        data = bytearray()
+        while len(data) < n:
+            chunk = self.rfile.read(min(CHUNK_SIZE, n - len(data)))
+            if not chunk:
+                break
+            data += chunk
+            self.throttle(len(chunk))
+        return bytes(data)
+
+    def skip_bytes(self, n):
+        while n > 0:
+            chunk = self.rfile.read(min(1 << 20, n))
+            if not chunk:
+                break
+            n -= len(chunk)
+            self.throttle(len(chunk))
+
+    def throttle(self, n):
+        if self.server.config.bandwidth > 0:
+            time.sleep(n / float(self.server.config.bandwidth))
+
+    def send_body(self, data, status=200, content_type='text/plain'):
+        self.send_response(status)
+        self.send_header('Content-Type', content_type)
+        self.send_header('Content-Length', str(len(data)))
+        self.end_headers()
+        for i in range(0, len(data), CHUNK_SIZE):
+            self.wfile.write(data[i:i + CHUNK_SIZE])
+            self.throttle(min(CHUNK_SIZE, len(data) - i))
+
+    def send_zeros(self, n, content_type='application/octet-stream'):
+        self.send_response(200)
+        self.send_header('Content-Type', content_type)
+        self.send_header('Content-Length', str(n))
+        self.end_headers()
+        block = memoryview(bytes(1 << 20))
+        while n > 0:
+            k = min(len(block), n)
+            self.wfile.write(block[:k])
+            self.throttle(k)
+            n -= k
+
+    def send_json(self, value, status=200):
+        self.send_body(json.dumps(value).encode(), status, 'application/json')
+
+    def reply(self, data, status=200, content_type='text/plain'):
+        self.result = (self.send_body, (data, status, content_type))
+
+    def reply_zeros(self, n):
+        self.result = (self.send_zeros, (n,))
+
+    def reply_json(self, value, status=200):
+        self.reply(json.dumps(value).encode(), status, 'application/json')
+
+    def send_result(self):
+        send, args = self.result
+        send(*args)
+
+    def log_message(self, fmt, *args):
+        if self.server.config.verbose:
+            sys.stderr.write('%s - %s\n' % (self.address_string(), fmt % args))
+
+    # Helpers.
+
+    def user(self):
+        h = self.headers.get('Authorization', '')
+        if not h.startswith('Basic '):
+            return None
+        try:
+            key = base64.b64decode(h[6:]).decode().split(':', 1)[0]
+        except ValueError:
+            return None
+        return self.server.state.keys.get(key)
+
+    def base_url(self):
+        return 'http://%s' % self.headers.get(
+            'Host', '%s:%d' % self.server.server_address[:2])
+
+    def json_body(self, body):
+        try:
+            return json.loads(body.decode('utf-8'))
+        except ValueError:
+            return None
+
+    def attachment_json(self, a):
+        return {
+            'id': a['id'],
+            'filename': a['filename'],
+            'content_type': 'application/octet-stream',
+            'size': a['size'],
+            'checksum': hashlib.sha256(a['data']).hexdigest(),
+            'crc32': '%08x' % (zlib.crc32(a['data']) & 0xffffffff),
+            'url': '%s/attachment/%s/download/%s' % (
+                self.base_url(), a['id'], urllib.parse.quote(a['filename'])),
+        }
+
+    def message_json(self, m):
+        state = self.server.state
+        return {
+            'id': m['id'],
+            'sender': m['sender'],
+            'recipients': m['recipients'],
+            'ccs': m['ccs'],
+            'bccs': m['bccs'],
+            'created_at': timestamp(m['created_at']),
+            'expires_at': m['expires_at'],
+            'expires_after': 30,
+            'authorization': m['authorization'],
+            'authorization_description': 'Only Specified Recipients',
+            'subject': m['subject'],
+            'message': m['message'],
+            'attachments': [self.attachment_json(state.attachments[i])
+                            for i in m['attachments'] if i in state.attachments],
+        }
+
+    def link_json(self, l):
+        a = l['attachment']
+        return {
+            'id': l['id'],
+            'filename': a['filename'],
+            'size': a['size'],
+            'url': '%s/link/%s' % (self.base_url(), l['id']),
+            'expires_at': l['expires_at'],
+            'download_count': 0,
+        }
+
+    def add_attachment(self, filename, data, size):
+        state = self.server.state
+        if self.server.config.discard:
+            data = b''
+        a = {'id': state.new_id(), 'filename': filename, 'data': data,
+             'size': size}
+        state.attachments[a['id']] = a
+        return a
+
+    # Endpoints.
+
+    def login(self, body):
+        state = self.server.state
+        j = self.json_body(body) or {}
+        u = j.get('user', {})
+        email = u.get('email')
+        if email not in state.users or state.users[email] != u.get('password'):
+            self.reply_json({'errors': ['Invalid email or password.']}, 401)
+            return
+        key = next(k for k, v in state.keys.items() if v == email)
+        self.reply_json({'user': {'email': email, 'api_key': key}})
+
+    def attach(self, body):
+        state = self.server.state
+        fields = parse_multipart(body, self.headers.get('Content-Type', ''))
+        if 'Filedata' not in fields:
+            self.reply(b'Missing Filedata', 422)
+            return
+        filename, data = fields['Filedata']
+        size = len(data) + self.discarded
+        if 'chunks' not in fields:
+            self.reply(
+                self.add_attachment(filename, data, size)['id'].encode())
+            return
+        name = fields.get('name', (None, filename.encode()))[1].decode()
+        try:
+            chunk = int(fields['chunk'][1])
+            chunks = int(fields['chunks'][1])
+        except (KeyError, ValueError):
+            self.reply(b'Invalid chunk', 422)
+            return
+        key = (self.user(), name)
+        parts = state.chunks.setdefault(key, {})
+        parts[chunk] = (data, size)
+        if len(parts) < chunks:
+            self.reply(b' ')
+            return
+        del state.chunks[key]
+        data = b''.join(parts[i][0] for i in sorted(parts))
+        size = sum(p[1] for p in parts.values())
+        self.reply(self.add_attachment(name, data, size)['id'].encode())
+
+    def delete_attachment(self, body, id):
+        if self.server.state.attachments.pop(id, None) is None:
+            self.reply_json({'errors': ['Attachment not found']}, 404)
+            return
+        self.reply(b' ')
+
+    def download(self, body, id, filename):
+        a = self.server.state.attachments.get(id)
+        if a is None:
+            self.reply_json({'errors': ['Attachment not found']}, 404)
+            return
+        if len(a['data']) < a['size']:
+            self.reply_zeros(a['size'])
+            return
+        self.reply(a['data'], 200, 'application/octet-stream')
+
+    def list_messages(self, body):
+        ms = list(self.server.state.messages.values())
+        last = self.query.get('sent_in_the_last')
+        after = self.query.get('sent_after')
+        if last:
+            t = now() - datetime.timedelta(hours=int(last[0]))
+            ms = [m for m in ms if m['created_at'] >= t]
+        elif after:
+            t = datetime.datetime.strptime(after[0], '%Y%m%d').replace(
+                tzinfo=datetime.timezone.utc)
+            ms = [m for m in ms if m['created_at'] >= t]
+        self.reply_json({'messages': [self.message_json(m) for m in ms]})
+
+    def send(self, body):
+        state = self.server.state
+        j = self.json_body(body)
+        if j is None or 'message' not in j:
+            self.reply_json({'errors': ['Invalid message']}, 422)
+            return
+        r = j['message']
+        missing = [i for i in r.get('attachments', []) if i not in state.attachments]
+        if missing:
+            self.reply_json({'errors': ['Attachment %s not found' % missing[0]]}, 422)
+            return
+        t = now()
+        m = {
+            'id': state.new_id(),
+            'sender': self.user(),
+            'recipients': r.get('recipients', []),
+            'ccs': r.get('cc', []),
+            'bccs': r.get('bcc', []),
+            'created_at': t,
+            'expires_at': (t + datetime.timedelta(days=30)).strftime('%Y-%m-%d'),
+            'authorization': r.get('authorization', 3),
+            'subject': r.get('subject', ''),
+            'message': r.get('message', ''),
+            'attachments': list(r.get('attachments', [])),
+        }
+        state.messages[m['id']] = m
+        self.reply_json({'message': self.message_json(m)})
+
+    def get_message(self, body, id):
+        m = self.server.state.messages.get(id)
+        if m is None:
+            self.reply_json({'errors': ['Message not found']}, 404)
+            return
+        self.reply_json({'message': self.message_json(m)})
+
+    def delete_message_attachments(self, body, id):
+        state = self.server.state
+        m = state.messages.get(id)
+        if m is None:
+            self.reply_json({'errors': ['Message not found']}, 404)
+            return
+        for i in m['attachments']:
+            state.attachments.pop(i, None)
+        self.reply(b' ')
+
+    def list_links(self, body):
+        ls = list(self.server.state.links.values())
+        limit = self.query.get('limit')
+        if limit:
+            ls = ls[:int(limit[0])]
+        self.reply_json({'links': [self.link_json(l) for l in ls]})
+
+    def create_link(self, body):
+        state = self.server.state
+        r = (self.json_body(body) or {}).get('link', {})
+        a = state.attachments.get(r.get('attachment'))
+        if a is None:
+            self.reply_json({'errors': ['Attachment not found']}, 422)
+            return
+        expires = r.get('expires_at') or (
+            now() + datetime.timedelta(days=30)).strftime('%Y-%m-%d')
+        l = {'id': state.new_id(), 'attachment': a, 'expires_at': expires}
+        state.links[l['id']] = l
+        self.reply_json({'link': self.link_json(l)})
+
+    def delete_link(self, body, id):
+        if self.server.state.links.pop(id, None) is None:
+            self.reply_json({'errors': ['Filelink not found']}, 404)
+            return
+        self.reply(b' ')
+
+    def file_request(self, body):
+        state = self.server.state
+        r = (self.json_body(body) or {}).get('request', {})
+        if not r.get('recipient'):
+            self.reply_json({'errors': ['Recipient is missing']}, 422)
+            return
+        self.reply_json({'request': {
+            'id': state.new_id(),
+            'recipient': r['recipient'],
+            'subject': r.get('subject', ''),
+            'url': '%s/requests/%s' % (self.base_url(), state.new_id()),
+        }})
+
+    def filedrop_info(self, body, name):
+        key = self.server.state.filedrop_key(name)
+        self.reply_json({'filedrop': {'name': name, 'api_key': key}})
+
+    def filedrop_send(self, body, name):
+        r = (self.json_body(body) or {}).get('message', {})
+        if not r.get('from'):
+            self.reply_json({'errors': ['Sender is missing']}, 422)
+            return
+        self.reply_json({'message': {
+            'id': self.server.state.new_id(),
+            'status': 'Message sent successfully',
+        }})
+
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+
+def main():
+    p = argparse.ArgumentParser(description='Mock LiquidFiles server.')
+    p.add_argument('--host', default='127.0.0.1')
+    p.add_argument('--port', type=int, default=0,
+                   help='port to listen, 0 to choose free one')
+    p.add_argument('--port_file',
+                   help='file to write the port to, once server is ready')
+    p.add_argument('--user', default='xustup@gmail.com',
+                   help='email of the account')
+    p.add_argument('--password', default='TestPassword_1',
+                   help='password of the account')
+    p.add_argument('--api_key', default='MockApiKey000000000000',
+                   help='api key of the account')
+    p.add_argument('--latency', type=float, default=0,
+                   help='delay before every responce, in milliseconds')
+    p.add_argument('--bandwidth', type=int, default=0,
+                   help='bytes per second of request and responce bodies, '
+                        '0 for unlimited')
+    p.add_argument('--error_rate', type=float, default=0,
+                   help='probability of failing a request')
+    p.add_argument('--fail_every', type=int, default=0,
+                   help='fail every n-th request')
+    p.add_argument('--fail_path',
+                   help='inject failures only to paths matching this regex')
+    p.add_argument('--error_status', type=int, default=500,
+                   help='HTTP status of injected failures')
+    p.add_argument('--seed', type=int, default=1,
+                   help='seed of ids and error injection')
+    p.add_argument('--discard', action='store_true',
+                   help='keep only sizes of uploaded files, download zeros')
+    p.add_argument('-v', '--verbose', action='store_true',
+                   help='log requests to stderr')
+    config = p.parse_args()
+
+    server = Server((config.host, config.port), Handler)
+    server.config = config
+    server.state = State(config)
+    port = server.server_address[1]
+    if config.port_file:
+        with open(config.port_file + '.tmp', 'w') as f:
+            f.write('%d\n' % port)
+        os.replace(config.port_file + '.tmp', config.port_file)
+    print('Listening on http://%s:%d' % (config.host, port), flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == '__main__':
+    main()
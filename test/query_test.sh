@@ -0,0 +1,76 @@
+#! /bin/bash
+
+DIR=$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )
+source $DIR/common.sh
+
+# Recipient of this run only, so the counts don't include other messages.
+TO=query_$$_$RANDOM@example.com
+SMALL=$DIR/aaa.jpg
+LARGE=$DIR/attach_test.sh
+SMALL_SIZE=`wc -c < $SMALL`
+LARGE_SIZE=`wc -c < $LARGE`
+
+ID1=`$EXEC send --to=$TO --server=$SERVER -k --api_key=$KEY --subject="Query small" $SMALL`
+test_status "Couldn't send message.\n$ID1"
+ID1=${ID1##* }
+
+ID2=`$EXEC send --to=$TO --server=$SERVER -k --api_key=$KEY --subject="Query large" $LARGE`
+test_status "Couldn't send message.\n$ID2"
+ID2=${ID2##* }
+
+# Both messages are seen, sending marks the cached ones out of date.
+MESSAGES=`$EXEC query --server=$SERVER -k --api_key=$KEY --to=$TO --subject="query" --output_format=csv`
+test_status "Couldn't query messages.\n$MESSAGES"
+if ! echo "$MESSAGES" | grep -q "^$ID1," || ! echo "$MESSAGES" | grep -q "^$ID2,"; then
+    echo -e "Sent messages expected in query.\n$MESSAGES"
+    fail
+fi
+
+COUNT=`$EXEC query --server=$SERVER -k --api_key=$KEY --to=$TO --group_by=sender --output_format=csv | tr -d '\r'`
+test_status "Couldn't count messages.\n$COUNT"
+if ! echo "$COUNT" | grep -q ",2,$((SMALL_SIZE + LARGE_SIZE))$"; then
+    echo -e "2 messages of $((SMALL_SIZE + LARGE_SIZE)) bytes expected.\n$COUNT"
+    fail
+fi
+
+MESSAGES=`$EXEC query --server=$SERVER -k --api_key=$KEY --to=$TO --larger_than=$SMALL_SIZE --output_format=csv`
+test_status "Couldn't query messages larger than $SMALL_SIZE.\n$MESSAGES"
+if [ "`echo "$MESSAGES" | grep -c .`" -ne 1 ] || ! echo "$MESSAGES" | grep -q "^$ID2,"; then
+    echo -e "Only the large message expected.\n$MESSAGES"
+    fail
+fi
+
+TODAY=`date -u +%Y%m%d`
+TOMORROW=`date -u -d tomorrow +%Y%m%d`
+COUNT=`$EXEC query --server=$SERVER -k --api_key=$KEY --to=$TO --sent_after=$TODAY --group_by=day --output_format=csv | tr -d '\r'`
+test_status "Couldn't count messages by day.\n$COUNT"
+if ! echo "$COUNT" | grep -q ",2,$((SMALL_SIZE + LARGE_SIZE))$"; then
+    echo -e "2 messages sent today expected.\n$COUNT"
+    fail
+fi
+MESSAGES=`$EXEC query --server=$SERVER -k --api_key=$KEY --to=$TO --sent_after=$TOMORROW --output_format=csv`
+test_status "Couldn't query messages sent after $TOMORROW.\n$MESSAGES"
+if [ -n "$MESSAGES" ]; then
+    echo -e "No messages sent after $TOMORROW expected.\n$MESSAGES"
+    fail
+fi
+
+# Messages sent by workers of '-e' mark the cached ones out of date too.
+TO2=query_$$_$RANDOM@example.com
+SENT=`$EXEC send --to=$TO,$TO2 -e --server=$SERVER -k --api_key=$KEY --subject="Query each" $SMALL`
+test_status "Couldn't send messages to each user.\n$SENT"
+IDS=`echo "$SENT" | sed -n 's/.*sent successfully\. ID: //p' | tr -d '\r'`
+if [ "`echo "$IDS" | grep -c .`" -ne 2 ]; then
+    echo -e "2 sent messages expected.\n$SENT"
+    fail
+fi
+MESSAGES=`$EXEC messages --server=$SERVER -k --api_key=$KEY --output_format=csv`
+test_status "Couldn't list messages.\n$MESSAGES"
+for ID in $IDS; do
+    if ! echo "$MESSAGES" | grep -q "^$ID,"; then
+        echo -e "Message $ID sent to each user expected in messages.\n$MESSAGES"
+        fail
+    fi
+done
+
+echo "Test PASSED."
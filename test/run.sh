@@ -1,7 +1,33 @@
 #! /bin/bash
 
+# Usage: run.sh [--mock [mock_server.py options]]
+#
+# With --mock the tests run against local mock_server.py instead of the real
+# server, with temporary HOME, so saved credentials are not touched. Options
+# after --mock are passed to the mock server, e.g. --latency=50.
+
 DIR=$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )
 
+if [ "$1" == "--mock" ]; then
+    shift
+    MOCK_DIR=`mktemp -d`
+    python3 $DIR/mock_server.py --port_file=$MOCK_DIR/port "$@" > /dev/null &
+    MOCK_PID=$!
+    trap 'kill $MOCK_PID 2> /dev/null; rm -rf $MOCK_DIR' EXIT
+    for i in `seq 100`; do
+        if [ -s $MOCK_DIR/port ]; then
+            break
+        fi
+        sleep 0.1
+    done
+    if [ ! -s $MOCK_DIR/port ]; then
+        echo "Couldn't start mock server"
+        exit 1
+    fi
+    export LF_TEST_SERVER=http://127.0.0.1:`cat $MOCK_DIR/port`
+    export HOME=$MOCK_DIR
+fi
+
 tests="
     attach_chunk_test
     attach_test
@@ -9,7 +35,9 @@ tests="
     file_request_test
     filedrop_test
     filelinks_test
+    query_test
     send_test
+    send_manifest_test
     sending_many_files
     "
 
@@ -19,8 +47,8 @@ for t in $tests;
 do
     echo "Running $t"
     $DIR/$t.sh > /dev/null
-    count=$((count + 1))
     status=$?
+    count=$((count + 1))
     if [ $status -ne 0 ]; then
         failed=$((failed + 1))
         echo "FAILED"
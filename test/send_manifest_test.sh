@@ -0,0 +1,37 @@
+#! /bin/bash
+
+DIR=$( cd "$( dirname "${BASH_SOURCE[0]}" )" && pwd )
+source $DIR/common.sh
+
+MANIFEST=`mktemp`
+printf 'recipient,subject,message,files\r\n' > $MANIFEST
+printf 'xustup@example.com,"Hello, first!","Hello\nagain",%s,%s\r\n' $DIR/send_test.sh $DIR/attach_test.sh >> $MANIFEST
+printf 'xustup@example.com,Hello!,"""Hello""",%s\r\n' $DIR/send_test.sh >> $MANIFEST
+
+RESULT=`$EXEC send_manifest --server=$SERVER -k --api_key=$KEY --manifest=$MANIFEST --output_format=csv`
+test_status "Couldn't send manifest.\n$RESULT"
+rm -f $MANIFEST
+
+if [ `echo "$RESULT" | wc -l` -ne 2 ]; then
+    echo "Results of all messages expected."
+    fail
+fi
+
+MESSAGE=`echo "$RESULT" | sed -n 1p | cut -d , -f 3`
+test_message $MESSAGE
+
+if [ ! -f .tmp_test/send_test.sh ] || [ ! -f .tmp_test/attach_test.sh ]; then
+    echo "Couldn't download file."
+    fail
+fi
+rm -rf .tmp_test
+
+MESSAGE=`echo "$RESULT" | sed -n 2p | cut -d , -f 3`
+test_message $MESSAGE
+
+if [ ! -f .tmp_test/send_test.sh ]; then
+    echo "Couldn't download file."
+    fail
+fi
+rm -rf .tmp_test
+echo "Test PASSED."
@@ -28,3 +28,21 @@ if [ ! -f .tmp_test/send_test.sh ]; then
 fi
 rm -rf .tmp_test
 echo "Test PASSED."
+
+MESSAGES=`$EXEC send --to=xustup@example.com,xustup2@example.com --cc=xustup3@example.com -e --server=$SERVER -k --api_key=$KEY --message="hello" --subject="Hello!" $DIR/send_test.sh`
+test_status "Couldn't send messages to each user.\n$MESSAGES"
+if [ `echo "$MESSAGES" | grep -c "sent successfully"` -ne 2 ]; then
+    echo "Message to each user expected."
+    fail
+fi
+MESSAGE=`echo "$MESSAGES" | tail -1`
+MESSAGE=${MESSAGE##* }
+
+test_message $MESSAGE
+
+if [ ! -f .tmp_test/send_test.sh ]; then
+    echo "Couldn't download file."
+    fail
+fi
+rm -rf .tmp_test
+echo "Test PASSED."